@@ -0,0 +1,301 @@
+﻿#define NOMINMAX
+
+#include "BoosterApi.h"
+#include "Engine.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <memory>
+
+static_assert(sizeof(booster_event::subject) == sizeof(Events::Event::subject));
+static_assert(sizeof(booster_status::game) == sizeof(Events::Snapshot::game));
+static_assert(sizeof(booster_status::text) == sizeof(Events::Snapshot::text));
+
+namespace {
+
+    using Booster::ProcessInfo;
+
+    void ToC(const ProcessInfo& p, booster_process& out) {
+        out.pid = p.pid;
+        out.start_time = p.startTime;
+        strncpy_s(out.exe, p.exe.c_str(), _TRUNCATE);
+    }
+
+    void ToC(const Events::Event& e, booster_event& out) {
+        out.seq = e.seq;
+        out.time_us = e.timeUs;
+        out.kind = static_cast<uint8_t>(e.kind);
+        out.code = e.code;
+        out.outcome = e.outcome;
+        out.error = e.error;
+        memcpy(out.subject, e.subject, sizeof(out.subject));
+    }
+
+    // Adapts a booster_platform table to the engine's Platform.
+    class CPlatform final : public Booster::Platform {
+    public:
+        explicit CPlatform(const booster_platform& t) : t_(t), pressure_(t_) {}
+
+        DWORD_PTR SystemMask() override {
+            return t_.system_mask ? static_cast<DWORD_PTR>(t_.system_mask(t_.ctx)) : 0;
+        }
+
+        void Enumerate(std::vector<ProcessInfo>& out) override {
+            out.clear();
+            if (!t_.enumerate) return;
+            size_t total = t_.enumerate(t_.ctx, buffer_.data(), buffer_.size());
+            if (total > buffer_.size()) {
+                buffer_.resize(total + total / 4);
+                total = t_.enumerate(t_.ctx, buffer_.data(), buffer_.size());
+            }
+            total = std::min(total, buffer_.size());
+            for (size_t i = 0; i < total; ++i)
+                out.push_back({ buffer_[i].pid, buffer_[i].start_time, buffer_[i].exe });
+        }
+
+        bool GetAffinity(const ProcessInfo& p, DWORD_PTR& mask) override {
+            if (!t_.get_affinity) return false;
+            booster_process cp;
+            ToC(p, cp);
+            uint64_t m = 0;
+            if (!t_.get_affinity(t_.ctx, &cp, &m)) return false;
+            mask = static_cast<DWORD_PTR>(m);
+            return true;
+        }
+
+        bool SetAffinity(const ProcessInfo& p, DWORD_PTR mask) override {
+            if (!t_.set_affinity) return false;
+            booster_process cp;
+            ToC(p, cp);
+            return t_.set_affinity(t_.ctx, &cp, mask) != 0;
+        }
+
+        std::string ForegroundProcess() override {
+            char exe[MAX_PATH]{};
+            if (!t_.foreground || !t_.foreground(t_.ctx, exe, sizeof(exe))) return {};
+            exe[MAX_PATH - 1] = 0;
+            return exe;
+        }
+
+        bool Terminate(const ProcessInfo& p, std::string& imagePath, uint32_t& error) override {
+            if (!t_.terminate) return false;
+            booster_process cp;
+            ToC(p, cp);
+            char path[MAX_PATH]{};
+            const bool ok = t_.terminate(t_.ctx, &cp, path, sizeof(path), &error) != 0;
+            path[MAX_PATH - 1] = 0;
+            imagePath = path;
+            return ok;
+        }
+
+        bool GetPriority(const ProcessInfo& p, DWORD& priorityClass) override {
+            if (!t_.get_priority) return false;
+            booster_process cp;
+            ToC(p, cp);
+            uint32_t c = 0;
+            if (!t_.get_priority(t_.ctx, &cp, &c)) return false;
+            priorityClass = c;
+            return true;
+        }
+
+        bool SetPriority(const ProcessInfo& p, DWORD priorityClass) override {
+            if (t_.set_process_priority) {
+                booster_process cp;
+                ToC(p, cp);
+                return t_.set_process_priority(t_.ctx, &cp, priorityClass) != 0;
+            }
+            return t_.set_priority && t_.set_priority(t_.ctx, p.exe.c_str(), priorityClass) > 0;
+        }
+
+        bool Launch(const std::string& command, uint32_t& error) override {
+            return t_.launch && t_.launch(t_.ctx, command.c_str(), &error) != 0;
+        }
+
+        ULONGLONG CpuTime(const ProcessInfo& p) override {
+            if (!t_.cpu_time) return 0;
+            booster_process cp;
+            ToC(p, cp);
+            return t_.cpu_time(t_.ctx, &cp);
+        }
+
+        void Sleep(DWORD ms) override {
+            if (t_.sleep) t_.sleep(t_.ctx, ms);
+        }
+
+        Booster::SystemState QuerySystem() override {
+            Booster::SystemState s;
+            booster_system_state cs{ 1, 100, 0 };
+            if (t_.system_state && t_.system_state(t_.ctx, &cs)) {
+                s.acPower = cs.ac_power != 0;
+                s.batteryPercent = cs.battery_percent;
+                s.availableMemoryMb = cs.available_memory_mb;
+            }
+            return s;
+        }
+
+        Pressure::Source* PressureSource() override {
+            return t_.pressure ? &pressure_ : nullptr;
+        }
+
+    private:
+        class CPressure final : public Pressure::Source {
+        public:
+            explicit CPressure(const booster_platform& t) : t_(t) {}
+
+            bool Read(Pressure::Reading& out) override {
+                booster_pressure cp{};
+                if (!t_.pressure(t_.ctx, &cp)) return false;
+                out.cpu = cp.cpu;
+                out.memory = cp.memory;
+                out.io = cp.io;
+                return true;
+            }
+
+        private:
+            const booster_platform& t_;
+        };
+
+        booster_platform t_;
+        CPressure pressure_;
+        std::vector<booster_process> buffer_ = std::vector<booster_process>(256);
+    };
+
+} // namespace
+
+struct booster_engine {
+    std::unique_ptr<CPlatform>       platform;  // null on the real OS
+    std::unique_ptr<Booster::Engine> engine;
+};
+
+extern "C" {
+
+    int booster_api_version(void) {
+        return BOOSTER_API_VERSION;
+    }
+
+    void booster_default_options(booster_options* out) {
+        const Booster::EngineOptions d;
+        *out = {};
+        out->reserved_cores = d.steering.reservedCores;
+        out->numa_placement = d.numaPlacement;
+        out->tick_ms = d.tickMs;
+        out->relaunch_gap_ms = d.relaunchGapMs;
+        out->settle_ms = d.settleMs;
+    }
+
+    booster_engine* booster_engine_create(const booster_options* opts,
+        const booster_platform* platform)
+    {
+        booster_options o;
+        booster_default_options(&o);
+        if (opts) o = *opts;
+
+        Booster::EngineOptions eo;
+        if (o.config_file) eo.configFile = o.config_file;
+        if (o.rules_file) eo.rulesFile = o.rules_file;
+        if (o.kill_list) eo.killList.assign(o.kill_list, o.kill_list + o.kill_count);
+        eo.steering.reservedCores = o.reserved_cores;
+        eo.numaPlacement = o.numa_placement != 0 && !platform;
+        eo.tickMs = o.tick_ms;
+        eo.relaunchGapMs = o.relaunch_gap_ms;
+        eo.settleMs = o.settle_ms;
+
+        auto* e = new (std::nothrow) booster_engine;
+        if (!e) return nullptr;
+        try {
+            if (platform) {
+                e->platform = std::make_unique<CPlatform>(*platform);
+                e->engine = std::make_unique<Booster::Engine>(std::move(eo), *e->platform);
+            }
+            else {
+                e->engine = std::make_unique<Booster::Engine>(std::move(eo));
+            }
+        }
+        catch (...) {
+            delete e;
+            return nullptr;
+        }
+        return e;
+    }
+
+    void booster_engine_destroy(booster_engine* e) {
+        delete e;
+    }
+
+    void booster_engine_set_event_callback(booster_engine* e, booster_event_fn fn, void* user) {
+        if (!fn) {
+            e->engine->SetOnEvent({});
+            return;
+        }
+        e->engine->SetOnEvent([fn, user](const Events::Event& ev) {
+            booster_event out;
+            ToC(ev, out);
+            fn(user, &out);
+            });
+    }
+
+    void booster_engine_load_games(booster_engine* e) {
+        e->engine->LoadGames();
+    }
+
+    size_t booster_engine_load_rules(booster_engine* e) {
+        return e->engine->LoadRules().size();
+    }
+
+    int booster_engine_add_game(booster_engine* e, const char* exe) {
+        return exe && e->engine->AddGame(exe);
+    }
+
+    int booster_engine_remove_game(booster_engine* e, const char* exe) {
+        return exe && e->engine->RemoveGame(exe);
+    }
+
+    int booster_engine_force_enter(booster_engine* e, const char* exe) {
+        return exe && e->engine->ForceEnter(exe);
+    }
+
+    int booster_engine_force_exit(booster_engine* e) {
+        return e->engine->ForceExit();
+    }
+
+    void booster_engine_tick(booster_engine* e) {
+        e->engine->Tick();
+    }
+
+    void booster_engine_start(booster_engine* e) {
+        e->engine->Start();
+    }
+
+    void booster_engine_stop(booster_engine* e) {
+        e->engine->Stop();
+    }
+
+    int booster_engine_status(booster_engine* e, booster_status* out) {
+        Events::Snapshot s;
+        e->engine->Channel().Read(s);
+        out->active = s.active;
+        out->forced = s.forced;
+        out->revision = s.revision;
+        out->last_event = s.lastEvent;
+        memcpy(out->game, s.game, sizeof(out->game));
+        memcpy(out->text, s.text, sizeof(out->text));
+        return 1;
+    }
+
+    size_t booster_engine_events(booster_engine* e, uint64_t after, booster_event* out,
+        size_t max)
+    {
+        Events::Event buf[32];
+        size_t n = 0;
+        while (n < max) {
+            const size_t got = e->engine->Channel().Since(after, buf,
+                std::min(max - n, std::size(buf)));
+            if (!got) break;
+            for (size_t i = 0; i < got; ++i) ToC(buf[i], out[n++]);
+            after = buf[got - 1].seq;
+        }
+        return n;
+    }
+
+} // extern "C"
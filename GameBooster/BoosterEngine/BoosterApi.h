@@ -0,0 +1,140 @@
+﻿#pragma once
+
+/* ============================================================
+ * BOOSTER ENGINE C API
+ * ============================================================
+ *
+ * A stable C ABI over Booster::Engine for launchers and test harnesses.
+ * Every call takes an explicit engine handle; engines share nothing but
+ * the process-wide trace buffers. Strings are NUL-terminated ANSI.
+ * Functions returning int return nonzero on success.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BOOSTER_API_VERSION 1
+
+typedef struct booster_engine booster_engine;
+
+typedef struct booster_process {
+    uint32_t pid;
+    uint64_t start_time;        /* FILETIME ticks; identifies the instance */
+    char     exe[260];
+} booster_process;
+
+typedef struct booster_system_state {
+    int      ac_power;
+    int      battery_percent;
+    uint64_t available_memory_mb;
+} booster_system_state;
+
+/* How hard the machine is pressed, each 0 (idle) to 1 (saturated). */
+typedef struct booster_pressure {
+    double cpu;
+    double memory;
+    double io;
+} booster_pressure;
+
+/* OS operations the engine performs. Pass NULL to booster_engine_create
+ * for the real OS. In a custom table any NULL entry is a no-op that
+ * reports failure (or nothing found). */
+typedef struct booster_platform {
+    void* ctx;
+    /* Fills up to `max` entries and returns the total, which may be larger. */
+    size_t   (*enumerate)(void* ctx, booster_process* out, size_t max);
+    int      (*foreground)(void* ctx, char* exe, size_t size);
+    int      (*terminate)(void* ctx, const booster_process* p, char* image_path,
+                 size_t size, uint32_t* error);
+    /* Every process named `exe`; used when set_process_priority is NULL. */
+    int      (*set_priority)(void* ctx, const char* exe, uint32_t priority_class);
+    int      (*launch)(void* ctx, const char* command, uint32_t* error);
+    uint64_t (*cpu_time)(void* ctx, const booster_process* p);
+    void     (*sleep)(void* ctx, uint32_t ms);
+    uint64_t (*system_mask)(void* ctx);
+    int      (*get_affinity)(void* ctx, const booster_process* p, uint64_t* mask);
+    int      (*set_affinity)(void* ctx, const booster_process* p, uint64_t mask);
+    /* Facts for boost rules; NULL reports AC power, full battery, 0 MB free. */
+    int      (*system_state)(void* ctx, booster_system_state* out);
+    /* Read each tick of a session; NULL (or 0) never escalates. */
+    int      (*pressure)(void* ctx, booster_pressure* out);
+    /* One instance. Without get_priority, changed processes are restored
+     * to NORMAL_PRIORITY_CLASS. */
+    int      (*get_priority)(void* ctx, const booster_process* p, uint32_t* priority_class);
+    int      (*set_process_priority)(void* ctx, const booster_process* p, uint32_t priority_class);
+} booster_platform;
+
+/* Start from booster_default_options and override what you need. */
+typedef struct booster_options {
+    const char*        config_file;     /* NULL keeps the game list in memory */
+    const char*        rules_file;      /* NULL: no boost rules */
+    const char* const* kill_list;       /* NULL uses the default list */
+    size_t             kill_count;
+    int                reserved_cores;  /* 0 = half of the processors */
+    int                numa_placement;  /* ignored with a custom platform */
+    uint32_t           tick_ms;
+    uint32_t           relaunch_gap_ms;
+    uint32_t           settle_ms;
+} booster_options;
+
+typedef struct booster_status {
+    int      active;
+    int      forced;
+    uint32_t revision;
+    uint64_t last_event;
+    char     game[64];
+    char     text[96];
+} booster_status;
+
+enum { BOOSTER_EVENT_TRANSITION = 1, BOOSTER_EVENT_ACTION, BOOSTER_EVENT_ERROR };
+
+typedef struct booster_event {
+    uint64_t seq;
+    uint64_t time_us;
+    uint8_t  kind;
+    uint8_t  code;
+    uint8_t  outcome;
+    uint32_t error;
+    char     subject[48];
+} booster_event;
+
+/* Called on the thread that caused the event, possibly mid-transition:
+ * it must not call back into the same engine. */
+typedef void (*booster_event_fn)(void* user, const booster_event* e);
+
+int  booster_api_version(void);
+void booster_default_options(booster_options* out);
+
+/* `opts` and `platform` may be NULL; both are copied. */
+booster_engine* booster_engine_create(const booster_options* opts,
+    const booster_platform* platform);
+void booster_engine_destroy(booster_engine* e);
+
+/* Set before booster_engine_start. */
+void booster_engine_set_event_callback(booster_engine* e, booster_event_fn fn, void* user);
+
+void booster_engine_load_games(booster_engine* e);
+/* Returns the number of rule lines that failed to compile. */
+size_t booster_engine_load_rules(booster_engine* e);
+int  booster_engine_add_game(booster_engine* e, const char* exe);
+int  booster_engine_remove_game(booster_engine* e, const char* exe);
+int  booster_engine_force_enter(booster_engine* e, const char* exe);
+int  booster_engine_force_exit(booster_engine* e);
+
+/* Either drive the monitor yourself... */
+void booster_engine_tick(booster_engine* e);
+/* ...or let the engine run it on its own thread. */
+void booster_engine_start(booster_engine* e);
+void booster_engine_stop(booster_engine* e);
+
+int    booster_engine_status(booster_engine* e, booster_status* out);
+/* Copies retained events with seq > `after`, oldest first. */
+size_t booster_engine_events(booster_engine* e, uint64_t after, booster_event* out, size_t max);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,66 @@
+﻿#pragma once
+
+#include "Events.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ============================================================
+// BOOSTER CONTROL SURFACE
+// ============================================================
+
+namespace Booster {
+
+    struct StatusInfo {
+        bool        active = false;
+        bool        forced = false;
+        uint32_t    revision = 0;   // bumped whenever the game list changes
+        std::string game;
+        std::string text;
+    };
+
+    // Timer wakeup lateness seen by the latency probe.
+    struct WakeLatency {
+        uint64_t samples = 0;
+        uint32_t p50Us = 0;
+        uint32_t p99Us = 0;
+        uint32_t p999Us = 0;
+        uint32_t maxUs = 0;
+    };
+
+    struct Stats {
+        uint64_t uptimeMs = 0;
+        uint64_t ticks = 0;
+        uint64_t transitions = 0;
+        uint64_t lastEnterUs = 0;
+        uint64_t lastExitUs = 0;
+        uint32_t gameCount = 0;
+        uint32_t steeredProcesses = 0;
+        WakeLatency wakeIdle;       // Game Mode inactive
+        WakeLatency wakeBoosted;    // Game Mode active
+        // The booster's own footprint.
+        uint64_t selfCpuUs = 0;
+        uint64_t selfResidentBytes = 0;
+        uint64_t selfPrivateBytes = 0;
+    };
+
+    // What a front end can ask of the booster, whether the engine runs
+    // in-process or behind the control pipe.
+    class Control {
+    public:
+        virtual ~Control() = default;
+        virtual bool GetStatus(StatusInfo& out) = 0;
+        virtual bool GetStats(Stats& out) = 0;
+        virtual bool ListGames(std::vector<std::string>& out) = 0;
+        virtual bool AddGame(const std::string& name) = 0;
+        virtual bool RemoveGame(const std::string& name) = 0;
+        virtual bool ForceEnter(const std::string& name) = 0;
+        virtual bool ForceExit() = 0;
+        // Writes the booster's recent trace spans as Chrome trace JSON.
+        virtual bool DumpTrace(const std::string& path) = 0;
+        // Retained events with seq > `after`, oldest first.
+        virtual bool RecentEvents(uint64_t after, std::vector<Events::Event>& out) = 0;
+    };
+
+} // namespace Booster
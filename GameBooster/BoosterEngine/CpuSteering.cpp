@@ -0,0 +1,177 @@
+﻿#define NOMINMAX
+
+#include "CpuSteering.h"
+#include "ProcessScan.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace CpuSteering {
+
+    namespace {
+
+        std::string Lower(std::string s) {
+            std::transform(s.begin(), s.end(), s.begin(),
+                [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return s;
+        }
+
+    } // namespace
+
+    // ------------------------------------------------------------
+    // Win32Backend
+    // ------------------------------------------------------------
+
+    DWORD_PTR Win32Backend::SystemMask() {
+        DWORD_PTR procMask = 0, sysMask = 0;
+        if (!GetProcessAffinityMask(GetCurrentProcess(), &procMask, &sysMask))
+            return 0;
+        return sysMask;
+    }
+
+    void Win32Backend::Enumerate(std::vector<ProcessInfo>& out) {
+        // Start times come with the table, so no process is opened here.
+        // Entries are overwritten in place to keep their name buffers.
+        size_t n = 0;
+        ProcessScan::Snapshot& scan = ProcessScan::ThisThread();
+        if (scan.Take()) {
+            for (const auto& p : scan.Processes()) {
+                if (!p.startTime) continue;     // the idle process
+                if (n == out.size()) out.emplace_back();
+                ProcessInfo& info = out[n++];
+                info.pid = p.pid;
+                info.startTime = p.startTime;
+                p.NameTo(info.exe);
+            }
+        }
+        out.resize(n);
+    }
+
+    bool Win32Backend::GetAffinity(const ProcessInfo& p, DWORD_PTR& mask) {
+        HANDLE h = ProcessUtil::OpenVerified(p, 0);
+        if (!h) return false;
+        DWORD_PTR sysMask = 0;
+        const bool ok = GetProcessAffinityMask(h, &mask, &sysMask) != FALSE;
+        CloseHandle(h);
+        return ok;
+    }
+
+    bool Win32Backend::SetAffinity(const ProcessInfo& p, DWORD_PTR mask) {
+        HANDLE h = ProcessUtil::OpenVerified(p, PROCESS_SET_INFORMATION);
+        if (!h) return false;
+        const bool ok = SetProcessAffinityMask(h, mask) != FALSE;
+        CloseHandle(h);
+        return ok;
+    }
+
+    // ------------------------------------------------------------
+    // Mask helpers
+    // ------------------------------------------------------------
+
+    int CountBits(DWORD_PTR mask) {
+        int n = 0;
+        for (; mask; mask &= mask - 1) ++n;
+        return n;
+    }
+
+    DWORD_PTR ReserveMask(DWORD_PTR available, int count) {
+        DWORD_PTR reserved = 0;
+        for (int bit = static_cast<int>(sizeof(DWORD_PTR) * 8) - 1;
+            bit >= 0 && count > 0; --bit) {
+            const DWORD_PTR b = static_cast<DWORD_PTR>(1) << bit;
+            if (available & b) { reserved |= b; --count; }
+        }
+        return reserved;
+    }
+
+    // ------------------------------------------------------------
+    // Steering
+    // ------------------------------------------------------------
+
+    Steering::Steering(Backend& backend, Options opts)
+        : backend_(backend), opts_(std::move(opts))
+    {
+        for (auto& name : opts_.exempt) name = Lower(name);
+    }
+
+    bool Steering::Apply(const std::string& gameExe) {
+        if (Active()) return true;
+
+        const DWORD_PTR available = backend_.SystemMask();
+        const int total = CountBits(available);
+        int reserve = opts_.reservedCores > 0 ? opts_.reservedCores : total / 2;
+        reserve = std::min(reserve, total - opts_.minBackgroundCores);
+        if (reserve <= 0) return false;
+
+        gameExe_ = Lower(gameExe);
+        gameMask_ = ReserveMask(available, reserve);
+        backgroundMask_ = available & ~gameMask_;
+        Steer();
+        return true;
+    }
+
+    void Steering::Refresh() {
+        if (Active()) Steer();
+    }
+
+    void Steering::Restore() {
+        for (const auto& [key, entry] : journal_)
+            backend_.SetAffinity(entry.proc, entry.original);
+        Release();
+    }
+
+    void Steering::Release() {
+        journal_.clear();
+        examined_.clear();
+        gameExe_.clear();
+        gameMask_ = backgroundMask_ = 0;
+    }
+
+    bool Steering::IsExempt(const std::string& lowerExe) const {
+        return std::find(opts_.exempt.begin(), opts_.exempt.end(), lowerExe)
+            != opts_.exempt.end();
+    }
+
+    void Steering::Steer() {
+        const DWORD self = GetCurrentProcessId();
+        backend_.Enumerate(scratch_);
+
+        for (const auto& proc : scratch_) {
+            if (proc.pid <= 4 || proc.pid == self) continue;
+            const Key key{ proc.pid, proc.startTime };
+            // Each instance is looked at once a session; a refresh only has
+            // to open processes that started since.
+            if (!examined_.insert(key).second) continue;
+
+            const std::string exe = Lower(proc.exe);
+            const bool isGame = exe == gameExe_;
+            if (isGame ? !opts_.pinGame : IsExempt(exe)) continue;
+
+            DWORD_PTR current = 0;
+            if (!backend_.GetAffinity(proc, current)) continue;
+
+            DWORD_PTR target;
+            if (isGame) {
+                target = gameMask_;
+            }
+            else {
+                if (!(current & gameMask_)) continue;
+                target = current & backgroundMask_;
+                if (!target) target = backgroundMask_;
+            }
+            if (target == current) continue;
+
+            const JournalEntry entry{ proc, current, target };
+            if (observer_ && !observer_(entry, false)) {
+                // Not recorded, so not made; worth another look next time.
+                examined_.erase(key);
+                continue;
+            }
+            // Protected processes refuse every time; they stay examined so
+            // the record is not churned on every refresh.
+            if (backend_.SetAffinity(proc, target)) journal_[key] = entry;
+            else if (observer_) observer_(entry, true);
+        }
+    }
+
+} // namespace CpuSteering
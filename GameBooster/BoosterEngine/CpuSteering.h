@@ -0,0 +1,108 @@
+﻿#pragma once
+
+#include "ProcessUtil.h"
+
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ============================================================
+// CPU STEERING
+// ============================================================
+//
+// Reserves a set of logical processors for the game and moves every other
+// process off them, so background threads (and the deferred work they
+// queue) stop competing with the game's cores. Each mask we touch is
+// journaled and put back verbatim on Restore().
+
+namespace CpuSteering {
+
+    struct Options {
+        int  reservedCores = 0;     // 0 = half of the available processors
+        int  minBackgroundCores = 2;
+        bool pinGame = true;
+        std::vector<std::string> exempt{
+            "system", "registry", "smss.exe", "csrss.exe", "wininit.exe",
+            "dwm.exe", "audiodg.exe", "fontdrvhost.exe", "memory compression"
+        };
+    };
+
+    using ProcessUtil::ProcessInfo;
+
+    // Everything Steering needs from the OS. Win32Backend is the real one;
+    // tests substitute a fake process table.
+    class Backend {
+    public:
+        virtual ~Backend() = default;
+        virtual DWORD_PTR SystemMask() = 0;
+        virtual void Enumerate(std::vector<ProcessInfo>& out) = 0;
+        virtual bool GetAffinity(const ProcessInfo& p, DWORD_PTR& mask) = 0;
+        virtual bool SetAffinity(const ProcessInfo& p, DWORD_PTR mask) = 0;
+    };
+
+    class Win32Backend final : public Backend {
+    public:
+        DWORD_PTR SystemMask() override;
+        void Enumerate(std::vector<ProcessInfo>& out) override;
+        bool GetAffinity(const ProcessInfo& p, DWORD_PTR& mask) override;
+        bool SetAffinity(const ProcessInfo& p, DWORD_PTR mask) override;
+    };
+
+    struct JournalEntry {
+        ProcessInfo proc;
+        DWORD_PTR   original = 0;
+        DWORD_PTR   applied = 0;
+    };
+
+    // Highest `count` processors of `available`; processor 0 is the last to
+    // be reserved since it services most interrupts by default.
+    DWORD_PTR ReserveMask(DWORD_PTR available, int count);
+    int CountBits(DWORD_PTR mask);
+
+    class Steering {
+    public:
+        explicit Steering(Backend& backend, Options opts = {});
+
+        Steering(const Steering&) = delete;
+        Steering& operator=(const Steering&) = delete;
+
+        // Told of each change before it is made and again, with `failed`
+        // set, if the OS refused it; for keeping a durable record. False
+        // from the first call skips the change for now, e.g. when the record
+        // could not be written. A refused change is not attempted again for
+        // that process instance.
+        using Observer = std::function<bool(const JournalEntry& entry, bool failed)>;
+        void SetObserver(Observer observer) { observer_ = std::move(observer); }
+
+        bool Apply(const std::string& gameExe);
+        void Refresh();
+        void Restore();
+        // Forgets every change without undoing it, for owners that restore
+        // from their own record.
+        void Release();
+
+        bool      Active() const { return gameMask_ != 0; }
+        DWORD_PTR GameMask() const { return gameMask_; }
+        DWORD_PTR BackgroundMask() const { return backgroundMask_; }
+        size_t    JournalSize() const { return journal_.size(); }
+
+    private:
+        using Key = std::pair<DWORD, ULONGLONG>;
+
+        void Steer();
+        bool IsExempt(const std::string& lowerExe) const;
+
+        Backend& backend_;
+        Options  opts_;
+        std::string gameExe_;
+        DWORD_PTR gameMask_ = 0, backgroundMask_ = 0;
+        std::map<Key, JournalEntry> journal_;
+        std::set<Key> examined_;    // instances already steered, skipped or refused
+        std::vector<ProcessInfo> scratch_;
+        Observer observer_;
+    };
+
+} // namespace CpuSteering
@@ -0,0 +1,198 @@
+﻿#define _CRT_SECURE_NO_WARNINGS
+#define NOMINMAX
+#include "Detect.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace Detect {
+
+    const char* const CsvHeader =
+        "exe,pid,threads,cpu_cores,hot_threads,graphics,audio,runtime,fullscreen,child_shell,label";
+
+    namespace {
+
+        bool StartsWith(const std::string& s, const char* prefix) {
+            return s.rfind(prefix, 0) == 0;
+        }
+
+        // Foreground regulars that map graphics DLLs and go fullscreen
+        // without being games.
+        bool NeverGame(const std::string& exe) {
+            static const char* const apps[] = {
+                "explorer.exe", "dwm.exe", "chrome.exe", "msedge.exe", "firefox.exe",
+                "opera.exe", "brave.exe", "vlc.exe", "mpc-hc64.exe", "obs64.exe", "discord.exe",
+                "steam.exe", "steamwebhelper.exe", "epicgameslauncher.exe", "code.exe",
+                "devenv.exe", "gamebooster.exe", "applicationframehost.exe",
+            };
+            return std::any_of(std::begin(apps), std::end(apps),
+                [&](const char* a) { return exe == a; });
+        }
+
+    } // namespace
+
+    void ClassifyModule(const std::string& m, Sample& s) {
+        if (m == "d3d9.dll" || StartsWith(m, "d3d10") || m == "d3d11.dll" || m == "d3d12.dll"
+            || m == "vulkan-1.dll" || m == "opengl32.dll")
+            s.graphics = true;
+        else if (StartsWith(m, "xaudio2") || m == "dsound.dll" || StartsWith(m, "fmod")
+            || m == "aksoundengine.dll" || StartsWith(m, "binkw") || StartsWith(m, "bink2"))
+            s.audio = true;
+        else if (m == "unityplayer.dll" || StartsWith(m, "steam_api") || StartsWith(m, "eossdk")
+            || StartsWith(m, "gameoverlayrenderer") || StartsWith(m, "galaxy")
+            || m == "discord_game_sdk.dll" || StartsWith(m, "physx") || StartsWith(m, "nvngx")
+            || StartsWith(m, "mono-2.0") || m == "easyanticheat_x64.dll")
+            s.runtime = true;
+    }
+
+    double Score(const Sample& s) {
+        // Hand-set logistic weights; re-fit with --eval-detector on
+        // recorded samples before changing them.
+        double z = -4.0;
+        if (s.graphics) z += 1.5;
+        if (s.audio) z += 0.7;
+        if (s.runtime) z += 2.0;
+        if (s.fullscreen) z += 1.5;
+        if (s.hotThreads >= 1 && s.hotThreads <= 2) z += 1.2;
+        if (s.cpuCores >= 0.3) z += 0.8;
+        if (s.threads >= 24) z += 0.4;
+        if (s.childShell) z -= 4.0;
+        return 1.0 / (1.0 + std::exp(-z));
+    }
+
+    // ------------------------------------------------------------
+    // Recorded samples
+    // ------------------------------------------------------------
+
+    std::string Format(const Sample& s, bool label) {
+        char line[256];
+        snprintf(line, sizeof(line), "%s,%u,%u,%.3f,%u,%d,%d,%d,%d,%d,%d", s.exe.c_str(),
+            s.pid, s.threads, s.cpuCores, s.hotThreads, s.graphics, s.audio, s.runtime,
+            s.fullscreen, s.childShell, label);
+        return line;
+    }
+
+    bool Parse(const std::string& line, Sample& s, bool& label) {
+        std::istringstream in(line);
+        std::string field;
+        std::vector<std::string> f;
+        while (std::getline(in, field, ',')) f.push_back(field);
+        if (f.size() != 11 || f[0] == "exe") return false;
+        s = Sample();
+        s.exe = f[0];
+        s.pid = static_cast<uint32_t>(std::strtoul(f[1].c_str(), nullptr, 10));
+        s.threads = static_cast<uint32_t>(std::strtoul(f[2].c_str(), nullptr, 10));
+        s.cpuCores = std::atof(f[3].c_str());
+        s.hotThreads = static_cast<uint32_t>(std::strtoul(f[4].c_str(), nullptr, 10));
+        s.graphics = f[5] == "1";
+        s.audio = f[6] == "1";
+        s.runtime = f[7] == "1";
+        s.fullscreen = f[8] == "1";
+        s.childShell = f[9] == "1";
+        label = f[10] == "1";
+        return true;
+    }
+
+    // ------------------------------------------------------------
+    // Memory
+    // ------------------------------------------------------------
+
+    void Memory::LoadLocked() const {
+        if (loaded_) return;
+        loaded_ = true;
+        if (path_.empty()) return;
+        std::ifstream file(path_);
+        for (std::string verb, exe; file >> verb >> exe;) {
+            if (verb == "allow") verdicts_[exe] = Verdict::Allow;
+            else if (verb == "deny") verdicts_[exe] = Verdict::Deny;
+        }
+    }
+
+    Verdict Memory::Get(const std::string& exe) const {
+        std::lock_guard lock(mutex_);
+        LoadLocked();
+        const auto it = verdicts_.find(exe);
+        return it == verdicts_.end() ? Verdict::Unknown : it->second;
+    }
+
+    void Memory::Learn(const std::string& exe, Verdict v) {
+        std::lock_guard lock(mutex_);
+        LoadLocked();
+        if (v == Verdict::Unknown) verdicts_.erase(exe);
+        else verdicts_[exe] = v;
+        if (path_.empty()) return;
+        std::ofstream file(path_, std::ios::trunc);
+        for (const auto& [name, verdict] : verdicts_)
+            file << (verdict == Verdict::Allow ? "allow " : "deny ") << name << '\n';
+    }
+
+    // ------------------------------------------------------------
+    // Detector
+    // ------------------------------------------------------------
+
+    Decision Detector::Observe(const Sample& s) {
+        switch (memory_.Get(s.exe)) {
+        case Verdict::Allow: return { true, 1.0 };
+        case Verdict::Deny:  return { false, 0.0 };
+        default: break;
+        }
+        if (NeverGame(s.exe)) return {};
+
+        const double confidence = Score(s);
+        if (s.pid != pid_ || s.startTime != startTime_) {
+            pid_ = s.pid;
+            startTime_ = s.startTime;
+            average_ = confidence;
+            streak_ = 0;
+        }
+        // Alt-tabbing back to a declared game does not restart the streak.
+        const auto instance = std::make_pair(s.pid, s.startTime);
+        if (declared_.count(instance)) return { true, confidence };
+
+        average_ = 0.5 * average_ + 0.5 * confidence;
+        streak_ = average_ >= opts_.threshold ? streak_ + 1 : 0;
+        if (streak_ < opts_.sustainTicks) return { false, average_ };
+        declared_.insert(instance);
+        return { true, average_ };
+    }
+
+    // ------------------------------------------------------------
+    // Evaluation
+    // ------------------------------------------------------------
+
+    double Evaluation::Precision() const {
+        const size_t p = truePositive + falsePositive;
+        return p ? static_cast<double>(truePositive) / p : 0;
+    }
+
+    double Evaluation::Recall() const {
+        const size_t p = truePositive + falseNegative;
+        return p ? static_cast<double>(truePositive) / p : 0;
+    }
+
+    Evaluation Evaluate(const std::vector<std::pair<Sample, bool>>& samples, const Options& opts) {
+        Options fresh = opts;
+        fresh.memoryFile.clear();
+        fresh.recordFile.clear();
+        Detector detector(fresh);
+
+        Evaluation e;
+        const auto t0 = std::chrono::steady_clock::now();
+        for (const auto& [sample, label] : samples) {
+            const bool game = detector.Observe(sample).game;
+            if (game && label) ++e.truePositive;
+            else if (game) ++e.falsePositive;
+            else if (label) ++e.falseNegative;
+            else ++e.trueNegative;
+        }
+        if (!samples.empty())
+            e.nsPerSample = std::chrono::duration<double, std::nano>(
+                std::chrono::steady_clock::now() - t0).count() / samples.size();
+        return e;
+    }
+
+} // namespace Detect
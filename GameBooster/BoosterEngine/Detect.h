@@ -0,0 +1,124 @@
+﻿#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+// ============================================================
+// GAME DETECTION
+// ============================================================
+//
+// Recognises a game in front without it being on the list, from cheap
+// runtime signals: graphics/audio/game-runtime DLLs mapped, a fullscreen
+// window, one or two hot threads, thread count, and no shell children.
+// A process must score above the threshold for a few ticks in a row;
+// once declared, it stays a game for the life of that instance. What the
+// user teaches (force-exit = "not a game", long sessions = "game") is kept
+// in a small allow/deny file that overrides the score.
+
+namespace Detect {
+
+    struct Sample {
+        std::string exe;            // lower-case
+        uint32_t    pid = 0;
+        uint64_t    startTime = 0;
+        uint32_t    threads = 0;
+        double      cpuCores = 0;   // CPU use in logical processors
+        uint32_t    hotThreads = 0; // threads above half a core
+        bool        graphics = false;
+        bool        audio = false;
+        bool        runtime = false;    // game engine / store SDK
+        bool        fullscreen = false;
+        bool        childShell = false;
+    };
+
+    // Sampler state for the current foreground instance; the platform
+    // refreshes the expensive parts (threads, modules) only every few seconds.
+    struct SampleCache {
+        uint32_t pid = 0;
+        uint64_t startTime = 0;
+        uint64_t cpu = 0;
+        std::chrono::steady_clock::time_point cpuAt, deepAt, modulesAt;
+        std::map<uint32_t, uint64_t> threadCpu;
+        Sample   last;
+    };
+
+    // Sets the DLL signals in `s` for one mapped module (lower-case name).
+    void ClassifyModule(const std::string& module, Sample& s);
+
+    // Confidence in [0, 1] that `s` is a game, from this one sample.
+    double Score(const Sample& s);
+
+    // One CSV line per sample; `label` is the ground truth (1 = game).
+    std::string Format(const Sample& s, bool label);
+    bool Parse(const std::string& line, Sample& s, bool& label);
+    extern const char* const CsvHeader;
+
+    enum class Verdict : uint8_t { Unknown, Allow, Deny };
+
+    // Read on first use; every Learn rewrites the file. Thread-safe.
+    class Memory {
+    public:
+        explicit Memory(std::string path = {}) : path_(std::move(path)) {}
+
+        Verdict Get(const std::string& exe) const;
+        void Learn(const std::string& exe, Verdict v);
+
+    private:
+        void LoadLocked() const;
+
+        mutable std::mutex mutex_;
+        const std::string  path_;
+        mutable bool       loaded_ = false;
+        mutable std::map<std::string, Verdict> verdicts_;
+    };
+
+    struct Options {
+        bool        enabled = false;
+        double      threshold = 0.8;
+        uint32_t    sustainTicks = 3;
+        std::string memoryFile;     // allow/deny verdicts; empty keeps them in memory
+        std::string recordFile;     // CSV of every foreground sample, for Evaluate
+    };
+
+    struct Decision {
+        bool   game = false;
+        double confidence = 0;
+    };
+
+    class Detector {
+    public:
+        explicit Detector(Options opts) : opts_(std::move(opts)), memory_(opts_.memoryFile) {}
+
+        // One call per foreground sample, from a single thread.
+        Decision Observe(const Sample& s);
+        // Safe from any thread.
+        void Learn(const std::string& exe, Verdict v) { memory_.Learn(exe, v); }
+
+    private:
+        const Options opts_;
+        Memory   memory_;
+        uint32_t pid_ = 0;
+        uint64_t startTime_ = 0;
+        double   average_ = 0;
+        uint32_t streak_ = 0;
+        std::set<std::pair<uint32_t, uint64_t>> declared_;   // (pid, start time)
+    };
+
+    // Offline evaluation: replays recorded samples through a fresh detector.
+    struct Evaluation {
+        size_t truePositive = 0, falsePositive = 0;
+        size_t trueNegative = 0, falseNegative = 0;
+        double nsPerSample = 0;
+
+        double Precision() const;
+        double Recall() const;
+    };
+
+    Evaluation Evaluate(const std::vector<std::pair<Sample, bool>>& samples, const Options& opts);
+
+} // namespace Detect
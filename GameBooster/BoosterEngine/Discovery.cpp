@@ -0,0 +1,564 @@
+﻿#define NOMINMAX
+#define _CRT_SECURE_NO_WARNINGS
+#include "Discovery.h"
+
+#include <windows.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace Discovery {
+
+    const char* SourceName(Source s) {
+        switch (s) {
+        case Source::Steam:  return "steam";
+        case Source::Epic:   return "epic";
+        case Source::Heroic: return "heroic";
+        default:             return "folder";
+        }
+    }
+
+    namespace {
+
+        std::string ToLower(std::string s) {
+            std::transform(s.begin(), s.end(), s.begin(),
+                [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return s;
+        }
+
+        // Lower-case letters and digits only, for fuzzy name matching.
+        std::string Squash(const std::string& s) {
+            std::string out;
+            for (unsigned char c : s)
+                if (std::isalnum(c)) out += static_cast<char>(std::tolower(c));
+            return out;
+        }
+
+        bool Contains(const std::string& s, const char* part) {
+            return s.find(part) != std::string::npos;
+        }
+
+        std::wstring Widen(const std::string& s, UINT codePage) {
+            if (s.empty()) return {};
+            const int n = MultiByteToWideChar(codePage, 0, s.data(), static_cast<int>(s.size()), nullptr, 0);
+            std::wstring out(n, L'\0');
+            MultiByteToWideChar(codePage, 0, s.data(), static_cast<int>(s.size()), &out[0], n);
+            return out;
+        }
+
+        std::string Narrow(const std::wstring& s, UINT codePage) {
+            if (s.empty()) return {};
+            const int n = WideCharToMultiByte(codePage, 0, s.data(), static_cast<int>(s.size()),
+                nullptr, 0, nullptr, nullptr);
+            std::string out(n, '\0');
+            WideCharToMultiByte(codePage, 0, s.data(), static_cast<int>(s.size()), &out[0], n,
+                nullptr, nullptr);
+            return out;
+        }
+
+        std::string ReadText(const std::wstring& path) {
+            std::ifstream file(std::filesystem::path(path), std::ios::binary);
+            std::ostringstream text;
+            text << file.rdbuf();
+            return text.str();
+        }
+
+        std::wstring Join(const std::wstring& dir, const std::wstring& name) {
+            if (dir.empty() || dir.back() == L'\\' || dir.back() == L'/') return dir + name;
+            return dir + L'\\' + name;
+        }
+
+        std::wstring Parent(const std::wstring& path) {
+            const size_t slash = path.find_last_of(L"\\/");
+            return slash == std::wstring::npos ? std::wstring() : path.substr(0, slash);
+        }
+
+        std::wstring Leaf(const std::wstring& path) {
+            const size_t slash = path.find_last_of(L"\\/");
+            return slash == std::wstring::npos ? path : path.substr(slash + 1);
+        }
+
+        uint64_t WriteTime(const std::wstring& path) {
+            WIN32_FILE_ATTRIBUTE_DATA data;
+            if (!GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &data)) return 0;
+            return (static_cast<uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32)
+                | data.ftLastWriteTime.dwLowDateTime;
+        }
+
+        std::wstring EnvPath(const wchar_t* var, const wchar_t* rest) {
+            wchar_t buf[MAX_PATH];
+            const DWORD n = GetEnvironmentVariableW(var, buf, MAX_PATH);
+            if (n == 0 || n >= MAX_PATH) return {};
+            return Join(buf, rest);
+        }
+
+        // Calls f(name, isDirectory, size) for each entry of `dir`.
+        template <typename F>
+        void List(const std::wstring& dir, const wchar_t* pattern, F&& f) {
+            WIN32_FIND_DATAW fd;
+            HANDLE h = FindFirstFileExW(Join(dir, pattern).c_str(), FindExInfoBasic, &fd,
+                FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+            if (h == INVALID_HANDLE_VALUE) return;
+            do {
+                const std::wstring name = fd.cFileName;
+                if (name == L"." || name == L"..") continue;
+                // Junctions can loop or lead off the library drive.
+                if (fd.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) continue;
+                const uint64_t size = (static_cast<uint64_t>(fd.nFileSizeHigh) << 32) | fd.nFileSizeLow;
+                f(name, (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0, size);
+            } while (FindNextFileW(h, &fd));
+            FindClose(h);
+        }
+
+        // ------------------------------------------------------------
+        // Install directories
+        // ------------------------------------------------------------
+
+        struct Install {
+            std::wstring dir;
+            std::string  title;
+            std::string  hint;      // launcher-declared exe, relative; may be empty
+            Source       source = Source::Folder;
+        };
+
+        Install FromLauncher(LauncherInstall li, Source source) {
+            Install in;
+            in.dir = Widen(li.dir, CP_UTF8);
+            in.title = std::move(li.title);
+            in.hint = std::move(li.executable);
+            in.source = source;
+            return in;
+        }
+
+        void AddSteam(std::vector<Install>& out) {
+            wchar_t buf[MAX_PATH];
+            DWORD size = sizeof(buf);
+            std::wstring steam = L"C:\\Program Files (x86)\\Steam";
+            if (RegGetValueW(HKEY_CURRENT_USER, L"Software\\Valve\\Steam", L"SteamPath",
+                RRF_RT_REG_SZ, nullptr, buf, &size) == ERROR_SUCCESS)
+                steam = buf;
+
+            std::vector<std::wstring> libraries{ steam };
+            const std::string vdf = ReadText(Join(steam, L"steamapps\\libraryfolders.vdf"));
+            for (const auto& path : ParseLibraryFolders(vdf)) {
+                const std::wstring lib = Widen(path, CP_UTF8);
+                const bool known = std::any_of(libraries.begin(), libraries.end(),
+                    [&](const std::wstring& l) { return _wcsicmp(l.c_str(), lib.c_str()) == 0; });
+                if (!known) libraries.push_back(lib);
+            }
+
+            for (const auto& lib : libraries) {
+                const std::wstring apps = Join(lib, L"steamapps");
+                List(apps, L"appmanifest_*.acf", [&](const std::wstring& name, bool isDir, uint64_t) {
+                    if (isDir) return;
+                    std::string title, installDir;
+                    if (!ParseAppManifest(ReadText(Join(apps, name)), title, installDir)) return;
+                    Install in;
+                    in.dir = Join(Join(apps, L"common"), Widen(installDir, CP_UTF8));
+                    in.title = title;
+                    in.source = Source::Steam;
+                    out.push_back(std::move(in));
+                    });
+            }
+        }
+
+        void AddEpic(std::vector<Install>& out) {
+            const std::wstring manifests = EnvPath(L"ProgramData",
+                L"Epic\\EpicGamesLauncher\\Data\\Manifests");
+            if (manifests.empty()) return;
+            List(manifests, L"*.item", [&](const std::wstring& name, bool isDir, uint64_t) {
+                if (isDir) return;
+                for (auto& li : ParseEpicManifest(ReadText(Join(manifests, name))))
+                    out.push_back(FromLauncher(std::move(li), Source::Epic));
+                });
+        }
+
+        void AddHeroic(std::vector<Install>& out) {
+            const wchar_t* files[] = {
+                L"heroic\\legendaryConfig\\legendary\\installed.json",
+                L"heroic\\gog_store\\installed.json",
+            };
+            for (const wchar_t* file : files) {
+                const std::wstring path = EnvPath(L"APPDATA", file);
+                if (path.empty()) continue;
+                for (auto& li : ParseHeroicInstalled(ReadText(path)))
+                    out.push_back(FromLauncher(std::move(li), Source::Heroic));
+            }
+        }
+
+        void AddFolder(const std::string& folder, std::vector<Install>& out) {
+            const std::wstring root = Widen(folder, CP_ACP);
+            List(root, L"*", [&](const std::wstring& name, bool isDir, uint64_t) {
+                if (!isDir) return;
+                Install in;
+                in.dir = Join(root, name);
+                in.title = Narrow(name, CP_UTF8);
+                out.push_back(std::move(in));
+                });
+        }
+
+        // ------------------------------------------------------------
+        // Executable resolution
+        // ------------------------------------------------------------
+
+        constexpr int    MaxDepth = 4;
+        constexpr size_t MaxEntries = 20000;   // per install
+
+        bool SkippedDirectory(const std::string& lowerName) {
+            static const char* const skipped[] = {
+                "redist", "_commonredist", "commonredist", "directx", "dotnetfx", "vcredist",
+                "__installer", "installer", "prereqs", "support", "engine", "tools", "sdk",
+            };
+            return std::any_of(std::begin(skipped), std::end(skipped),
+                [&](const char* s) { return lowerName == s; });
+        }
+
+        struct Found {
+            std::wstring path;
+            std::string  relative;  // UTF-8, backslashes
+            uint64_t     size = 0;
+        };
+
+        void Walk(const std::wstring& dir, const std::string& relative, int depth,
+            size_t& entries, std::vector<Found>& out)
+        {
+            List(dir, L"*", [&](const std::wstring& name, bool isDir, uint64_t size) {
+                if (++entries > MaxEntries) return;
+                const std::string utf8 = Narrow(name, CP_UTF8);
+                const std::string rel = relative.empty() ? utf8 : relative + "\\" + utf8;
+                const std::string lower = ToLower(utf8);
+                if (isDir) {
+                    if (depth + 1 < MaxDepth && !SkippedDirectory(lower))
+                        Walk(Join(dir, name), rel, depth + 1, entries, out);
+                }
+                else if (lower.size() > 4 && lower.compare(lower.size() - 4, 4, ".exe") == 0) {
+                    out.push_back({ Join(dir, name), rel, size });
+                }
+                });
+        }
+
+        // Best executable under `in.dir`, or empty.
+        std::wstring Resolve(const Install& in) {
+            std::vector<Found> exes;
+            size_t entries = 0;
+            Walk(in.dir, {}, 0, entries, exes);
+            const std::string dirName = Narrow(Leaf(in.dir), CP_UTF8);
+            std::string hint = in.hint;
+            std::replace(hint.begin(), hint.end(), '/', '\\');
+            hint = ToLower(hint);
+
+            const Found* best = nullptr;
+            int bestScore = -1;
+            for (const auto& f : exes) {
+                int score = ScoreExecutable(f.relative, f.size, dirName);
+                if (score < 0) continue;
+                if (!hint.empty() && ToLower(f.relative) == hint) score += 40;
+                if (score > bestScore) {
+                    bestScore = score;
+                    best = &f;
+                }
+            }
+            return best ? best->path : std::wstring();
+        }
+
+        // ------------------------------------------------------------
+        // Scan index
+        // ------------------------------------------------------------
+
+        struct IndexEntry {
+            uint64_t    dirTime = 0;
+            uint64_t    exeDirTime = 0;
+            std::string exe;        // UTF-8 path; empty when nothing qualified
+        };
+        using Index = std::map<std::string, IndexEntry>;
+
+        Index LoadIndex(const std::string& path) {
+            Index index;
+            std::ifstream file(path);
+            for (std::string line; std::getline(file, line);) {
+                std::istringstream in(line);
+                IndexEntry e;
+                std::string dir;
+                if (!(in >> e.dirTime >> e.exeDirTime)) continue;
+                in.ignore(1);
+                if (!std::getline(in, dir, '\t')) continue;
+                std::getline(in, e.exe);
+                index[dir] = e;
+            }
+            return index;
+        }
+
+        void SaveIndex(const std::string& path, const Index& index) {
+            const std::string tmp = path + ".tmp";
+            {
+                std::ofstream file(tmp, std::ios::trunc);
+                for (const auto& [dir, e] : index)
+                    file << e.dirTime << ' ' << e.exeDirTime << '\t' << dir << '\t' << e.exe << '\n';
+                if (!file) return;
+            }
+            MoveFileExA(tmp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING);
+        }
+
+    } // namespace
+
+    // ------------------------------------------------------------
+    // Parsers
+    // ------------------------------------------------------------
+
+    void ForEachObject(const std::string& text, const std::function<void(const Fields&)>& f) {
+        struct Frame {
+            bool        object = true;
+            bool        hasKey = false;
+            std::string key;
+            Fields      fields;
+        };
+        // The implicit root frame takes VDF's bare top-level key.
+        std::vector<Frame> stack(1);
+        auto token = [&stack](std::string tok) {
+            Frame& fr = stack.back();
+            if (!fr.object) return;     // array element
+            if (!fr.hasKey) {
+                fr.key = ToLower(std::move(tok));
+                fr.hasKey = true;
+            }
+            else {
+                fr.fields[fr.key] = std::move(tok);
+                fr.hasKey = false;
+            }
+        };
+
+        const size_t n = text.size();
+        for (size_t i = 0; i < n;) {
+            const char c = text[i];
+            if (std::isspace(static_cast<unsigned char>(c)) || c == ':' || c == ',') {
+                ++i;
+            }
+            else if (c == '/' && i + 1 < n && text[i + 1] == '/') {
+                while (i < n && text[i] != '\n') ++i;
+            }
+            else if (c == '"') {
+                std::string s;
+                for (++i; i < n && text[i] != '"'; ++i) {
+                    if (text[i] != '\\' || i + 1 == n) {
+                        s += text[i];
+                        continue;
+                    }
+                    const char e = text[++i];
+                    if (e == 'n') s += '\n';
+                    else if (e == 't') s += '\t';
+                    else if (e == 'u' && i + 4 < n) {
+                        const unsigned cp = std::strtoul(text.substr(i + 1, 4).c_str(), nullptr, 16);
+                        i += 4;
+                        if (cp < 0x80) s += static_cast<char>(cp);
+                        else if (cp < 0x800) {
+                            s += static_cast<char>(0xC0 | (cp >> 6));
+                            s += static_cast<char>(0x80 | (cp & 0x3F));
+                        }
+                        else {
+                            s += static_cast<char>(0xE0 | (cp >> 12));
+                            s += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                            s += static_cast<char>(0x80 | (cp & 0x3F));
+                        }
+                    }
+                    else s += e;    // \\ \" \/
+                }
+                ++i;
+                token(std::move(s));
+            }
+            else if (c == '{' || c == '[') {
+                stack.back().hasKey = false;
+                Frame fr;
+                fr.object = c == '{';
+                stack.push_back(std::move(fr));
+                ++i;
+            }
+            else if (c == '}' || c == ']') {
+                if (stack.size() > 1) {
+                    const Frame fr = std::move(stack.back());
+                    stack.pop_back();
+                    if (fr.object) f(fr.fields);
+                }
+                ++i;
+            }
+            else {
+                const size_t begin = i;
+                while (i < n && !std::isspace(static_cast<unsigned char>(text[i]))
+                    && !std::strchr("{}[]:,\"", text[i]))
+                    ++i;
+                token(text.substr(begin, i - begin));
+            }
+        }
+    }
+
+    std::vector<std::string> ParseLibraryFolders(const std::string& vdf) {
+        std::vector<std::string> paths;
+        ForEachObject(vdf, [&](const Fields& f) {
+            // Current format: "0" { "path" "D:\\SteamLibrary" ... }
+            if (auto p = f.find("path"); p != f.end()) {
+                paths.push_back(p->second);
+                return;
+            }
+            // Pre-2021 format: "1" "D:\\SteamLibrary" directly in LibraryFolders.
+            // Per-library "apps" objects also have numeric keys, but no paths.
+            for (const auto& [key, value] : f)
+                if (!key.empty() && std::all_of(key.begin(), key.end(),
+                    [](unsigned char ch) { return std::isdigit(ch); })
+                    && value.find_first_of("\\/") != std::string::npos)
+                    paths.push_back(value);
+            });
+        return paths;
+    }
+
+    bool ParseAppManifest(const std::string& acf, std::string& title, std::string& installDir) {
+        bool found = false;
+        ForEachObject(acf, [&](const Fields& f) {
+            const auto dir = f.find("installdir");
+            if (found || dir == f.end() || dir->second.empty()) return;
+            installDir = dir->second;
+            const auto name = f.find("name");
+            title = name != f.end() ? name->second : installDir;
+            found = true;
+            });
+        return found;
+    }
+
+    namespace {
+
+        // Every object with a non-empty `dirKey`.
+        std::vector<LauncherInstall> ParseInstalls(const std::string& text,
+            const char* dirKey, const char* titleKey, const char* exeKey)
+        {
+            std::vector<LauncherInstall> out;
+            ForEachObject(text, [&](const Fields& f) {
+                const auto dir = f.find(dirKey);
+                if (dir == f.end() || dir->second.empty()) return;
+                LauncherInstall li;
+                li.dir = dir->second;
+                if (auto t = f.find(titleKey); t != f.end()) li.title = t->second;
+                if (auto e = f.find(exeKey); e != f.end()) li.executable = e->second;
+                out.push_back(std::move(li));
+                });
+            return out;
+        }
+
+    } // namespace
+
+    std::vector<LauncherInstall> ParseEpicManifest(const std::string& item) {
+        return ParseInstalls(item, "installlocation", "displayname", "launchexecutable");
+    }
+
+    std::vector<LauncherInstall> ParseHeroicInstalled(const std::string& json) {
+        return ParseInstalls(json, "install_path", "title", "executable");
+    }
+
+    int ScoreExecutable(const std::string& relativePath, uint64_t size,
+        const std::string& installDir)
+    {
+        const size_t slash = relativePath.find_last_of("\\/");
+        std::string name = ToLower(slash == std::string::npos
+            ? relativePath : relativePath.substr(slash + 1));
+        if (name.size() > 4) name.resize(name.size() - 4);
+
+        static const char* const denied[] = {
+            "unins", "setup", "install", "crash", "report", "redist", "dxsetup", "dotnet",
+            "helper", "update", "patch", "prereq", "easyanticheat", "battleye", "be_service",
+            "cefprocess", "webhelper", "activation", "register", "cleanup", "touchup",
+        };
+        for (const char* d : denied)
+            if (Contains(name, d)) return -1;
+
+        const int depth = static_cast<int>(std::count_if(relativePath.begin(), relativePath.end(),
+            [](char c) { return c == '\\' || c == '/'; }));
+        int score = 200 - depth * 10;
+
+        // Unreal ships a thin stub at the root; the process that runs is
+        // <Game>/Binaries/Win64/<Game>-Win64-Shipping.exe.
+        if (Contains(name, "-shipping")) score += 100;
+        const std::string a = Squash(name), b = Squash(installDir);
+        if (!a.empty() && !b.empty() && (Contains(a, b.c_str()) || Contains(b, a.c_str()))) score += 50;
+        if (Contains(name, "launcher")) score -= 30;
+        if (size > (1u << 20)) score += std::min(30, static_cast<int>(5 * std::log2(size / double(1u << 20))));
+        return std::max(score, 0);
+    }
+
+    // ------------------------------------------------------------
+    // Scan
+    // ------------------------------------------------------------
+
+    Result Scan(const Options& opts) {
+        const auto t0 = std::chrono::steady_clock::now();
+        std::vector<Install> installs;
+        if (opts.steam) AddSteam(installs);
+        if (opts.epic) AddEpic(installs);
+        if (opts.heroic) AddHeroic(installs);
+        for (const auto& folder : opts.folders) AddFolder(folder, installs);
+
+        const Index previous = opts.indexFile.empty() ? Index() : LoadIndex(opts.indexFile);
+        std::vector<IndexEntry> resolved(installs.size());
+        std::vector<char> walked(installs.size(), 0);
+
+        std::atomic<size_t> next{ 0 };
+        auto worker = [&] {
+            for (size_t i; (i = next.fetch_add(1)) < installs.size();) {
+                const Install& in = installs[i];
+                IndexEntry& e = resolved[i];
+                e.dirTime = WriteTime(in.dir);
+                if (!e.dirTime) continue;   // not installed any more
+
+                const auto it = previous.find(Narrow(in.dir, CP_UTF8));
+                if (it != previous.end() && it->second.dirTime == e.dirTime) {
+                    const std::wstring exe = Widen(it->second.exe, CP_UTF8);
+                    if (exe.empty() || WriteTime(Parent(exe)) == it->second.exeDirTime) {
+                        e = it->second;
+                        continue;
+                    }
+                }
+                const std::wstring exe = Resolve(in);
+                e.exe = Narrow(exe, CP_UTF8);
+                e.exeDirTime = exe.empty() ? 0 : WriteTime(Parent(exe));
+                walked[i] = 1;
+            }
+            };
+        uint32_t threads = opts.threads ? opts.threads : std::max(1u, std::thread::hardware_concurrency());
+        threads = static_cast<uint32_t>(std::min<size_t>(threads, std::max<size_t>(installs.size(), 1)));
+        std::vector<std::thread> pool;
+        for (uint32_t t = 1; t < threads; ++t) pool.emplace_back(worker);
+        worker();
+        for (auto& t : pool) t.join();
+
+        Result result;
+        result.installs = installs.size();
+        Index index;
+        std::map<std::string, size_t> byExe;
+        for (size_t i = 0; i < installs.size(); ++i) {
+            const IndexEntry& e = resolved[i];
+            if (!e.dirTime) continue;
+            index[Narrow(installs[i].dir, CP_UTF8)] = e;
+            result.walked += walked[i];
+            if (e.exe.empty()) continue;
+
+            const std::wstring exe = Widen(e.exe, CP_UTF8);
+            Candidate c;
+            c.exe = ToLower(Narrow(Leaf(exe), CP_ACP));
+            c.path = Narrow(exe, CP_ACP);
+            c.title = installs[i].title.empty() ? Narrow(Leaf(installs[i].dir), CP_ACP)
+                : Narrow(Widen(installs[i].title, CP_UTF8), CP_ACP);
+            c.source = installs[i].source;
+            if (byExe.emplace(c.exe, result.games.size()).second) result.games.push_back(std::move(c));
+        }
+        if (!opts.indexFile.empty()) SaveIndex(opts.indexFile, index);
+        result.elapsedMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - t0).count();
+        return result;
+    }
+
+} // namespace Discovery
@@ -0,0 +1,81 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// ============================================================
+// GAME DISCOVERY
+// ============================================================
+//
+// Finds installed games so the list does not have to be typed in:
+// Steam libraries (libraryfolders.vdf + appmanifest_*.acf), Epic manifests,
+// Heroic's installed.json files, and user folders whose subdirectories are
+// games. Install directories are resolved to an executable in parallel.
+// The scan index remembers each directory's timestamps and answer, so
+// unchanged installs cost two stat calls on a re-scan.
+
+namespace Discovery {
+
+    enum class Source : uint8_t { Steam, Epic, Heroic, Folder };
+
+    const char* SourceName(Source s);
+
+    struct Candidate {
+        std::string exe;        // lower-case file name, as the game list wants it
+        std::string path;
+        std::string title;
+        Source      source = Source::Folder;
+    };
+
+    struct Options {
+        bool steam = true;
+        bool epic = true;
+        bool heroic = true;
+        std::vector<std::string> folders;   // each subdirectory is one game
+        std::string indexFile;              // empty: always walk
+        uint32_t threads = 0;               // 0: one per logical processor
+    };
+
+    struct Result {
+        std::vector<Candidate> games;   // one per exe name
+        size_t installs = 0;            // install directories considered
+        size_t walked = 0;              // of which resolved from disk
+        double elapsedMs = 0;
+    };
+
+    Result Scan(const Options& opts);
+
+    // Parsers, exposed for fixture trees
+    // ------------------------------------------------------------
+
+    // Direct string members of one object; keys lower-cased.
+    using Fields = std::map<std::string, std::string>;
+
+    // Walks Valve KeyValues or JSON text and reports every object, innermost
+    // first. Numbers and literals are reported as strings.
+    void ForEachObject(const std::string& text, const std::function<void(const Fields&)>& f);
+
+    std::vector<std::string> ParseLibraryFolders(const std::string& vdf);
+    bool ParseAppManifest(const std::string& acf, std::string& title, std::string& installDir);
+
+    // An install as a launcher records it.
+    struct LauncherInstall {
+        std::string dir;
+        std::string title;          // may be empty
+        std::string executable;     // relative to dir; may be empty
+    };
+
+    // Epic's Manifests\*.item.
+    std::vector<LauncherInstall> ParseEpicManifest(const std::string& item);
+    // Heroic's installed.json, legendary (Epic) or GOG layout.
+    std::vector<LauncherInstall> ParseHeroicInstalled(const std::string& json);
+
+    // Ranks an executable as the game's main binary for `installDir`; < 0
+    // rules it out (installers, crash reporters, redistributables).
+    int ScoreExecutable(const std::string& relativePath, uint64_t size,
+        const std::string& installDir);
+
+} // namespace Discovery
@@ -0,0 +1,1009 @@
+﻿#define _CRT_SECURE_NO_WARNINGS
+#define NOMINMAX
+
+#include "Engine.h"
+
+#include <algorithm>
+#include <cctype>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+
+namespace Booster {
+
+    using Telemetry::Action;
+    using Telemetry::Outcome;
+
+    namespace {
+
+        std::string ToLower(std::string s) {
+            std::transform(s.begin(), s.end(), s.begin(),
+                [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return s;
+        }
+
+        uint64_t MicrosSince(std::chrono::steady_clock::time_point t0) {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - t0).count());
+        }
+
+    } // namespace
+
+    Engine::Engine(EngineOptions opts, Platform& platform)
+        : opts_(std::move(opts))
+        , platform_(platform)
+        , steering_(platform, opts_.steering)
+        , probe_(opts_.latencyProbe)
+        , escalator_(opts_.pressure)
+        , detector_(opts_.detect)
+    {
+        events_.Update([](Events::Snapshot& s) {
+            Events::Copy(s.text, "Ready - Monitoring for games");
+            });
+        steering_.SetObserver([this](const CpuSteering::JournalEntry& e, bool failed) {
+            const auto entry = Journal::Entry::Make(Journal::Kind::Affinity, e.proc, e.original);
+            if (!failed) return journal_.Record(entry);
+            journal_.Drop(entry);
+            return true;
+            });
+    }
+
+    Engine::~Engine() {
+        Stop();
+        // Embedders driving Tick() themselves never ran Loop()'s exit path.
+        std::lock_guard lock(modeMutex_);
+        Exit();
+    }
+
+    // ------------------------------------------------------------
+    // Game list
+    // ------------------------------------------------------------
+
+    // The file is a log: adds append "name", removes append "-name", and a
+    // load that replays any removal writes the list back compacted.
+    void Engine::LoadGames() {
+        bool compact = false;
+        {
+            std::lock_guard lock(gamesMutex_);
+            games_.Clear();
+            std::ifstream file(opts_.configFile);
+            for (std::string line; std::getline(file, line);) {
+                if (line.empty()) continue;
+                if (line[0] == '-') {
+                    games_.Erase(line.substr(1));
+                    compact = true;
+                }
+                else {
+                    compact |= !games_.Insert(line);
+                }
+            }
+            metrics_.gamesMonitored.Set(static_cast<double>(games_.Size()));
+        }
+        if (compact) SaveGames();
+        BumpRevision();
+    }
+
+    void Engine::AppendGameLog(const std::string& line) const {
+        if (opts_.configFile.empty()) return;
+        std::ofstream file(opts_.configFile, std::ios::app);
+        file << line << '\n';
+    }
+
+    std::vector<std::string> Engine::LoadRules() {
+        std::vector<std::string> errors;
+        std::string source;
+        if (!opts_.rulesFile.empty()) {
+            std::ifstream file(opts_.rulesFile);
+            std::ostringstream text;
+            text << file.rdbuf();
+            source = text.str();
+        }
+        Rules::RuleSet rules = Rules::RuleSet::Compile(source, errors);
+        std::lock_guard lock(modeMutex_);
+        rules_ = std::move(rules);
+        heldBy_ = 0;
+        if (!errors.empty()) {
+            std::string text = opts_.rulesFile + " " + errors.front();
+            if (errors.size() > 1) text += " (+" + std::to_string(errors.size() - 1) + " more)";
+            SetStatus(text);
+        }
+        return errors;
+    }
+
+    void Engine::SaveGames() const {
+        if (opts_.configFile.empty()) return;
+        std::vector<std::string> snapshot;
+        { std::lock_guard lock(gamesMutex_); snapshot = games_.Items(); }
+        std::ofstream file(opts_.configFile);
+        for (const auto& game : snapshot) file << game << '\n';
+    }
+
+    bool Engine::IsGameInList(const std::string& name) const {
+        std::lock_guard lock(gamesMutex_);
+        return games_.Contains(name);
+    }
+
+    bool Engine::ListGames(std::vector<std::string>& out) {
+        std::lock_guard lock(gamesMutex_);
+        out = games_.Items();
+        return true;
+    }
+
+    bool Engine::AddGame(const std::string& input) {
+        const std::string name = ToLower(input);
+        if (name.empty()) return false;
+        {
+            std::lock_guard lock(gamesMutex_);
+            if (!games_.Insert(name)) return false;
+            metrics_.gamesMonitored.Set(static_cast<double>(games_.Size()));
+            AppendGameLog(name);
+        }
+        BumpRevision();
+        return true;
+    }
+
+    bool Engine::RemoveGame(const std::string& input) {
+        const std::string name = ToLower(input);
+        {
+            std::lock_guard lock(gamesMutex_);
+            if (!games_.Erase(name)) return false;
+            metrics_.gamesMonitored.Set(static_cast<double>(games_.Size()));
+            AppendGameLog("-" + name);
+        }
+        BumpRevision();
+        return true;
+    }
+
+    // ------------------------------------------------------------
+    // Status
+    // ------------------------------------------------------------
+
+    void Engine::SetStatus(const std::string& text) {
+        events_.Update([&](Events::Snapshot& s) {
+            Events::Copy(s.text, text);
+            s.active = active_;
+            s.forced = forced_;
+            Events::Copy(s.game, activeGameName_);
+            });
+        Notify();
+    }
+
+    void Engine::BumpRevision() {
+        events_.Update([](Events::Snapshot& s) { ++s.revision; });
+        Notify();
+    }
+
+    void Engine::Report(Action action, Outcome outcome, const std::string& subject,
+        uint32_t error)
+    {
+        metrics_.Record(action, outcome);
+        if (outcome == Outcome::Failed && session_.failed < UINT16_MAX) ++session_.failed;
+        Emit(outcome == Outcome::Failed ? Events::Kind::Error : Events::Kind::Action,
+            static_cast<uint8_t>(action), outcome, subject, error);
+    }
+
+    void Engine::Emit(Events::Kind kind, uint8_t code, Outcome outcome,
+        const std::string& subject, uint32_t error)
+    {
+        const uint64_t seq = events_.Push(kind, code, static_cast<uint8_t>(outcome),
+            subject, error);
+        if (!onEvent_) return;
+        Events::Event e;
+        if (events_.Since(seq - 1, &e, 1)) onEvent_(e);
+    }
+
+    bool Engine::GetStatus(StatusInfo& out) {
+        Events::Snapshot s;
+        events_.Read(s);
+        out.active = s.active;
+        out.forced = s.forced;
+        out.revision = s.revision;
+        out.game = s.game;
+        out.text = s.text;
+        return true;
+    }
+
+    bool Engine::RecentEvents(uint64_t after, std::vector<Events::Event>& out) {
+        out.resize(Events::Channel::Capacity);
+        out.resize(events_.Since(after, out.data(), out.size()));
+        return true;
+    }
+
+    bool Engine::GetStats(Stats& out) {
+        out.uptimeMs = MicrosSince(started_) / 1000;
+        out.ticks = metrics_.monitorTicks.Value();
+        out.transitions = metrics_.transitionsEnter.Value()
+            + metrics_.transitionsExit.Value();
+        out.lastEnterUs = lastEnterUs_;
+        out.lastExitUs = lastExitUs_;
+        out.steeredProcesses = static_cast<uint32_t>(metrics_.processesSteered.Value());
+        out.wakeIdle = probe_.Summary(LatencyProbe::Mode::Idle);
+        out.wakeBoosted = probe_.Summary(LatencyProbe::Mode::Boosted);
+        const ProcessUtil::SelfUsage self = ProcessUtil::QuerySelf();
+        out.selfCpuUs = self.cpuTime / 10;
+        out.selfResidentBytes = self.workingSet;
+        out.selfPrivateBytes = self.privateBytes;
+        std::lock_guard lock(gamesMutex_);
+        out.gameCount = static_cast<uint32_t>(games_.Size());
+        return true;
+    }
+
+    // ------------------------------------------------------------
+    // Transitions
+    // ------------------------------------------------------------
+
+    void Engine::Enter(const std::string& gameName) {
+        if (active_) return;
+        OpenJournal();
+        Trace::Scope span("Enter", "transition", gameName.c_str());
+        const auto t0 = std::chrono::steady_clock::now();
+        SetStatus("Activating Game Mode...");
+        session_ = {};
+        session_.startMs = History::NowMs();
+        Events::Copy(session_.game, gameName);
+        if (forced_) session_.flags |= History::Forced;
+        sessionCpuSum_ = 0;
+        sessionCpuSamples_ = 0;
+        sessionPeakWs_ = 0;
+        loadUntil_ = t0 + std::chrono::milliseconds(opts_.headroom.loadWindowMs);
+
+        {
+            Trace::Scope s("EnumerateProcesses", "transition");
+            platform_.Enumerate(scratch_);
+        }
+        // A detected game has not been vouched for: boost it, but leave other
+        // processes alone until the user lists it.
+        const bool intrusive = !autoDetected_;
+        for (const auto& proc : scratch_) {
+            if (!intrusive) break;
+            const bool listed = std::any_of(opts_.killList.begin(), opts_.killList.end(),
+                [&](const auto& target) { return _stricmp(proc.exe.c_str(), target.c_str()) == 0; });
+            if (!listed) continue;
+            Trace::Scope s("TerminateProcess", "transition", proc.exe.c_str());
+            // Journaled by name until Terminate reports the image path.
+            const auto relaunch = Journal::Entry::Make(Journal::Kind::Relaunch, proc, 0, proc.exe);
+            if (!journal_.Record(relaunch)) {
+                Report(Action::Kill, Outcome::Failed, proc.exe);
+                continue;
+            }
+            std::string path;
+            uint32_t error = 0;
+            if (platform_.Terminate(proc, path, error)) {
+                if (!path.empty())
+                    journal_.Update(Journal::Entry::Make(Journal::Kind::Relaunch, proc, 0, path));
+                metrics_.processesKilled.Add();
+                ++session_.killed;
+                Report(Action::Kill, Outcome::Ok, proc.exe);
+            }
+            else {
+                journal_.Drop(relaunch);
+                Report(Action::Kill, Outcome::Failed, proc.exe, error);
+            }
+        }
+
+        activeGameName_ = gameName;
+        {
+            Trace::Scope s("SetPriority", "transition", gameName.c_str());
+            int raised = 0;
+            DWORD original = 0;
+            for (const auto& proc : scratch_)
+                if (_stricmp(proc.exe.c_str(), gameName.c_str()) == 0)
+                    raised += ChangePriority(proc, HIGH_PRIORITY_CLASS, original);
+            session_.raised = static_cast<uint16_t>(std::min(raised, 0xFFFF));
+            Report(Action::Priority, raised ? Outcome::Ok : Outcome::Failed, gameName);
+        }
+        if (intrusive) {
+            Trace::Scope s("SetPriority", "transition", "svchost.exe");
+            DWORD original = 0;
+            for (const auto& proc : scratch_)
+                if (_stricmp(proc.exe.c_str(), "svchost.exe") == 0)
+                    ChangePriority(proc, IDLE_PRIORITY_CLASS, original);
+        }
+        {
+            Trace::Scope s("CpuSteering.Apply", "transition");
+            Report(Action::CpuSteering,
+                steering_.Apply(gameName) ? Outcome::Ok : Outcome::Skipped, gameName);
+        }
+        {
+            Trace::Scope s("Numa.Apply", "transition");
+            const bool placed = opts_.numaPlacement
+                && numa_.Apply(gameName, steering_.GameMask());
+            Report(Action::NumaPlacement, placed ? Outcome::Ok : Outcome::Skipped, gameName);
+            if (placed) session_.flags |= History::NumaPlaced;
+        }
+        {
+            Trace::Scope s("PowerQos.Hold", "transition");
+            HoldPowerQos(gameName);
+        }
+        {
+            Trace::Scope s("Journal.Sync", "transition");
+            journal_.Sync();
+        }
+        session_.steered = static_cast<uint16_t>(std::min<size_t>(steering_.JournalSize(), 0xFFFF));
+        metrics_.processesSteered.Set(static_cast<double>(steering_.JournalSize()));
+        // Probe where the game now runs: its cores, at its priority.
+        probe_.Configure(LatencyProbe::Mode::Boosted, steering_.GameMask(), HIGH_PRIORITY_CLASS);
+
+        gameProcs_.clear();
+        platform_.Enumerate(scratch_);
+        for (const auto& proc : scratch_)
+            if (_stricmp(proc.exe.c_str(), gameName.c_str()) == 0) gameProcs_.push_back(proc);
+        lastGameCpu_ = 0;
+        lastGameSample_ = std::chrono::steady_clock::now();
+        SampleGameCpu();
+
+        active_ = true;
+        lastEnterUs_ = MicrosSince(t0);
+        session_.enterUs = static_cast<uint32_t>(std::min<uint64_t>(lastEnterUs_, UINT32_MAX));
+        metrics_.transitionsEnter.Add();
+        metrics_.enterSeconds.Observe(lastEnterUs_ / 1e6);
+        metrics_.gameModeActive.Set(1);
+        Emit(Events::Kind::Transition, static_cast<uint8_t>(Events::Transition::Enter),
+            Outcome::Ok, gameName);
+        SetStatus("Game Mode Active - " + gameName);
+    }
+
+    void Engine::Exit() {
+        if (!active_) return;
+        Trace::Scope span("Exit", "transition", activeGameName_.c_str());
+        const auto t0 = std::chrono::steady_clock::now();
+        SetStatus("Restoring Desktop...");
+
+        // Throttled offenders are in the journal with everything else.
+        escalations_.clear();
+        escalator_.Reset();
+        offenders_.Reset();
+        metrics_.escalationLevel.Set(0);
+        if (numa_.Active()) {
+            Trace::Scope s("Numa.Restore", "transition");
+            numa_.Restore();
+            // Where the game's memory was, for the event log; the placement
+            // itself was counted on Enter.
+            const uint8_t code = static_cast<uint8_t>(Action::NumaPlacement);
+            Emit(Events::Kind::Action, code, Outcome::Ok, "before " + Numa::Describe(numa_.Before()));
+            Emit(Events::Kind::Action, code, Outcome::Ok, "after " + Numa::Describe(numa_.After()));
+        }
+        ObserveResidency(true);
+        {
+            Trace::Scope s("Journal.Replay", "transition");
+            Replay(false);
+            steering_.Release();
+        }
+        metrics_.processesSteered.Set(0);
+        probe_.Configure(LatencyProbe::Mode::Idle, 0, NORMAL_PRIORITY_CLASS);
+
+        Emit(Events::Kind::Transition, static_cast<uint8_t>(Events::Transition::Exit),
+            Outcome::Ok, activeGameName_);
+        // A detected game the user kept playing is confirmed.
+        if (autoDetected_ && History::NowMs() - session_.startMs >= 10 * 60 * 1000)
+            detector_.Learn(activeGameName_, Detect::Verdict::Allow);
+        autoDetected_ = false;
+        activeGameName_.clear();
+        gameProcs_.clear();
+        active_ = false;
+        forced_ = false;
+        lastExitUs_ = MicrosSince(t0);
+        metrics_.transitionsExit.Add();
+        metrics_.exitSeconds.Observe(lastExitUs_ / 1e6);
+        RecordSession();
+        metrics_.gameModeActive.Set(0);
+        metrics_.gameCpuShare.Set(0);
+        {
+            Trace::Scope wait("Sleep", "transition", "settle");
+            platform_.Sleep(opts_.settleMs);
+        }
+        SetStatus("Ready - Monitoring for games");
+    }
+
+    // The first process of a listed game, before the game has a window to
+    // bring to the front: the load is still ahead of it. Runs on the monitor
+    // thread outside modeMutex_, so the budget holds no control client back.
+    void Engine::WatchLaunches() {
+        {
+            Trace::Scope s("QueryUsage", "monitor");
+            platform_.QueryUsage(launchUsage_);
+        }
+        std::vector<std::string> running;
+        for (const auto& u : launchUsage_) {
+            std::string exe = ToLower(u.proc.exe);
+            if (std::find(running.begin(), running.end(), exe) == running.end() && IsGameInList(exe))
+                running.push_back(std::move(exe));
+        }
+        std::string launched;
+        if (launchesPrimed_) {
+            for (const auto& game : running) {
+                if (std::find(runningGames_.begin(), runningGames_.end(), game) == runningGames_.end()) {
+                    launched = game;
+                    break;
+                }
+            }
+        }
+        runningGames_.swap(running);
+        launchesPrimed_ = true;
+        if (launched.empty()) return;
+        {
+            // Trimming would reach the game already being played.
+            std::lock_guard lock(modeMutex_);
+            if (active_) return;
+        }
+        ReserveHeadroom(launched);
+    }
+
+    void Engine::ReserveHeadroom(const std::string& game) {
+        // No session yet, so outcomes are not Report()ed against one.
+        auto report = [&](Outcome outcome, const std::string& subject) {
+            metrics_.Record(Action::Headroom, outcome);
+            Emit(outcome == Outcome::Failed ? Events::Kind::Error : Events::Kind::Action,
+                static_cast<uint8_t>(Action::Headroom), outcome, subject);
+            };
+        Headroom::MemoryState mem;
+        if (!platform_.QueryMemory(mem)) {
+            report(Outcome::Skipped, game);
+            return;
+        }
+        Trace::Scope span("ReserveHeadroom", "monitor", game.c_str());
+        const auto deadline = std::chrono::steady_clock::now()
+            + std::chrono::milliseconds(opts_.headroom.budgetMs);
+        auto inBudget = [&] { return std::chrono::steady_clock::now() < deadline; };
+
+        Headroom::Result r;
+        const uint32_t peakMb = OpenHistory() ? history_.Percentile(game, 0,
+            opts_.headroom.quantile, &History::Record::peakWorkingSetMb, true) : 0;
+        r.footprint = static_cast<uint64_t>(peakMb ? peakMb : opts_.headroom.fallbackMb) << 20;
+        r.target = Headroom::Target(opts_.headroom, r.footprint, mem.total);
+        r.freeBefore = mem.free;
+
+        // Cheapest first: cache nobody has touched lately.
+        if (mem.free < r.target) {
+            Trace::Scope s("PurgeStandby", "monitor", "low priority");
+            if (platform_.PurgeStandby(true)) platform_.QueryMemory(mem);
+        }
+        // Then the largest background working sets, until what they held
+        // would cover the rest.
+        if (mem.free < r.target && inBudget()) {
+            const uint64_t deficit = r.target - mem.free;
+            std::sort(launchUsage_.begin(), launchUsage_.end(), [](const auto& a, const auto& b) {
+                return a.workingSet > b.workingSet;
+                });
+            uint64_t trimmed = 0;
+            for (const auto& u : launchUsage_) {
+                if (trimmed >= deficit || r.trimmed >= opts_.headroom.maxTrims || !inBudget()) break;
+                if (Protected(u.proc, game)) continue;
+                Trace::Scope s("TrimWorkingSet", "monitor", u.proc.exe.c_str());
+                if (!platform_.TrimWorkingSet(u.proc)) continue;
+                trimmed += u.workingSet;
+                ++r.trimmed;
+            }
+            platform_.QueryMemory(mem);
+        }
+        // Trimmed pages only reach the standby list; the last resort drops
+        // all of it, the game's own cached files included.
+        if (mem.free < r.target && inBudget()) {
+            Trace::Scope s("PurgeStandby", "monitor", "all");
+            if (platform_.PurgeStandby(false)) platform_.QueryMemory(mem);
+        }
+        r.freeAfter = mem.free;
+
+        metrics_.headroomFreeBytes.Set(static_cast<double>(r.freeAfter));
+        metrics_.headroomTargetBytes.Set(static_cast<double>(r.target));
+        report(r.Reached() ? Outcome::Ok : Outcome::Failed, Headroom::Describe(r));
+    }
+
+    void Engine::HoldPowerQos(const std::string& gameName) {
+        if (!opts_.powerQos.enabled) {
+            Report(Action::PowerQos, Outcome::Skipped, gameName);
+            return;
+        }
+        ObserveResidency(false);
+
+        bool available = false, limited = false;
+        PowerQos::IdleLimit original;
+        const uint32_t limit = opts_.powerQos.idleStateLimit;
+        if (limit && platform_.GetIdleStateLimit(original)) {
+            available = true;
+            // A stricter limit already in the plan stays; on battery the
+            // plan keeps its own.
+            const uint32_t ac = original.ac && original.ac <= limit ? original.ac : limit;
+            const PowerQos::IdleLimit held{ ac, original.dc, original.scheme };
+            if (held.ac == original.ac) {
+                limited = true;
+            }
+            else {
+                const auto entry = Journal::Entry::Make(Journal::Kind::IdleLimit, {},
+                    original.Pack(), original.scheme);
+                limited = journal_.Record(entry) && platform_.SetIdleStateLimit(held);
+                if (!limited) journal_.Drop(entry);
+            }
+        }
+
+        int exempted = 0;
+        if (opts_.powerQos.exemptGame) {
+            for (const auto& proc : scratch_) {
+                if (_stricmp(proc.exe.c_str(), gameName.c_str()) != 0) continue;
+                PowerQos::Throttling was;
+                if (!platform_.GetPowerThrottling(proc, was)) continue;
+                available = true;
+                const auto entry = Journal::Entry::Make(Journal::Kind::Throttling, proc, was.Pack());
+                if (!journal_.Record(entry)) continue;
+                if (platform_.SetPowerThrottling(proc, PowerQos::Exempt)) ++exempted;
+                else journal_.Drop(entry);
+            }
+        }
+
+        Report(Action::PowerQos,
+            limited || exempted ? Outcome::Ok : available ? Outcome::Failed : Outcome::Skipped,
+            gameName);
+    }
+
+    void Engine::ObserveResidency(bool boosted) {
+        PowerQos::Residency r;
+        if (!opts_.powerQos.enabled || !platform_.ReadIdleResidency(r)) return;
+        auto& gauges = metrics_.idleResidency[boosted ? 1 : 0];
+        gauges[0].Set(r.c1);
+        gauges[1].Set(r.c2);
+        gauges[2].Set(r.c3);
+    }
+
+    bool Engine::OpenHistory() {
+        if (opts_.historyFile.empty()) return false;
+        // Launches are watched outside modeMutex_.
+        std::lock_guard lock(historyMutex_);
+        return history_.IsOpen() || history_.Open(opts_.historyFile, true);
+    }
+
+    void Engine::RecordSession() {
+        if (opts_.historyFile.empty()) return;
+        Trace::Scope s("History.Append", "transition");
+        if (!OpenHistory()) return;
+        session_.endMs = History::NowMs();
+        session_.exitUs = static_cast<uint32_t>(std::min<uint64_t>(lastExitUs_, UINT32_MAX));
+        if (sessionCpuSamples_)
+            session_.gameCpuPermille = static_cast<uint16_t>(1000 * sessionCpuSum_ / sessionCpuSamples_);
+        session_.peakWorkingSetMb = static_cast<uint32_t>(sessionPeakWs_ >> 20);
+        const WakeLatency wake = probe_.SessionSummary();
+        session_.wakeP50Us = wake.p50Us;
+        session_.wakeP99Us = wake.p99Us;
+        session_.wakeP999Us = wake.p999Us;
+        session_.wakeMaxUs = wake.maxUs;
+        history_.Append(session_);
+    }
+
+    // ------------------------------------------------------------
+    // Journal
+    // ------------------------------------------------------------
+
+    size_t Engine::Recover() {
+        std::lock_guard lock(modeMutex_);
+        return OpenJournal();
+    }
+
+    size_t Engine::OpenJournal() {
+        if (journalOpened_) return 0;
+        journalOpened_ = true;
+        if (opts_.journalFile.empty()) return 0;
+        Trace::Scope span("Recover", "transition");
+        const auto t0 = std::chrono::steady_clock::now();
+        if (!journal_.Open(opts_.journalFile) || journal_.Pending().empty()) return 0;
+
+        // Processes that exited since cannot be restored and need not be.
+        const size_t pending = journal_.Pending().size();
+        const size_t undone = Replay(true);
+        const uint64_t us = MicrosSince(t0);
+        metrics_.recoverySeconds.Set(us / 1e6);
+        Emit(Events::Kind::Transition, static_cast<uint8_t>(Events::Transition::Recover),
+            Outcome::Ok, std::to_string(undone) + " of " + std::to_string(pending) + " changes");
+        return undone;
+    }
+
+    bool Engine::ChangePriority(const ProcessInfo& p, DWORD priorityClass, DWORD& original) {
+        // Unreadable: NORMAL, what Exit assumed before there was a journal.
+        if (!platform_.GetPriority(p, original)) original = NORMAL_PRIORITY_CLASS;
+        if (original == priorityClass) return true;
+        const auto entry = Journal::Entry::Make(Journal::Kind::Priority, p, original);
+        if (!journal_.Record(entry)) return false;
+        if (platform_.SetPriority(p, priorityClass)) return true;
+        journal_.Drop(entry);
+        return false;
+    }
+
+    // Newest first, so a process changed twice ends at its first original
+    // and relaunches come last, after the machine has been given back.
+    size_t Engine::Replay(bool crashed) {
+        std::vector<std::string> launched;
+        if (crashed) platform_.Enumerate(scratch_);
+        size_t undone = 0;
+        const auto& pending = journal_.Pending();
+        for (auto it = pending.rbegin(); it != pending.rend(); ++it) {
+            const ProcessInfo proc = it->Process();
+            switch (it->Type()) {
+            case Journal::Kind::Priority:
+                undone += platform_.SetPriority(proc, static_cast<DWORD>(it->value));
+                break;
+            case Journal::Kind::Affinity:
+                undone += platform_.SetAffinity(proc, static_cast<DWORD_PTR>(it->value));
+                break;
+            case Journal::Kind::IdleLimit:
+                undone += platform_.SetIdleStateLimit(PowerQos::IdleLimit::Unpack(it->value, it->path));
+                break;
+            case Journal::Kind::Throttling:
+                undone += platform_.SetPowerThrottling(proc, PowerQos::Throttling::Unpack(it->value));
+                break;
+            case Journal::Kind::Relaunch: {
+                const std::string exe = ToLower(proc.exe);
+                if (std::find(launched.begin(), launched.end(), exe) != launched.end()) {
+                    ++undone;
+                    break;
+                }
+                launched.push_back(exe);
+                // After a crash the shell may well have come back on its own.
+                if (crashed && std::any_of(scratch_.begin(), scratch_.end(), [&](const ProcessInfo& p) {
+                    return _stricmp(p.exe.c_str(), exe.c_str()) == 0;
+                    })) {
+                    ++undone;
+                    break;
+                }
+                Trace::Scope s("Relaunch", "transition", proc.exe.c_str());
+                const std::string cmd = exe == "explorer.exe" ? exe : std::string(it->path);
+                uint32_t error = 0;
+                if (platform_.Launch(cmd, error)) {
+                    metrics_.processesRelaunched.Add();
+                    if (!crashed) ++session_.relaunched;
+                    Report(Action::Relaunch, Outcome::Ok, proc.exe);
+                    ++undone;
+                }
+                else {
+                    Report(Action::Relaunch, Outcome::Failed, proc.exe, error);
+                }
+                Trace::Scope wait("Sleep", "transition", "relaunch gap");
+                platform_.Sleep(opts_.relaunchGapMs);
+                break;
+            }
+            }
+        }
+        journal_.Clear();
+        return undone;
+    }
+
+    bool Engine::ForceEnter(const std::string& name) {
+        const std::string game = ToLower(name);
+        if (game.empty()) return false;
+        std::lock_guard lock(modeMutex_);
+        if (active_ && activeGameName_ != game) Exit();
+        forced_ = true;
+        autoDetected_ = false;
+        Enter(game);
+        SetStatus("Game Mode Active - " + game);
+        return true;
+    }
+
+    bool Engine::ForceExit() {
+        std::lock_guard lock(modeMutex_);
+        if (!active_) return false;
+        // Stay out until the user switches away from this game.
+        suppressed_ = activeGameName_;
+        // Backing out of a detected game says it was not one.
+        if (autoDetected_) {
+            detector_.Learn(activeGameName_, Detect::Verdict::Deny);
+            autoDetected_ = false;
+        }
+        Exit();
+        return true;
+    }
+
+    bool Engine::DumpTrace(const std::string& path) {
+        return Trace::WriteChromeJson(path);
+    }
+
+    // ------------------------------------------------------------
+    // Monitor loop
+    // ------------------------------------------------------------
+
+    void Engine::Tick() {
+        Trace::Scope span("Tick", "monitor");
+        std::string fg;
+        {
+            Trace::Scope s("ForegroundProcess", "monitor");
+            fg = ToLower(platform_.ForegroundProcess());
+        }
+        const bool listed = IsGameInList(fg);
+        const bool detected = (opts_.detect.enabled || !opts_.detect.recordFile.empty())
+            && DetectGame(fg, listed);
+        const bool isMonitored = listed || detected;
+        if (opts_.headroom.enabled) WatchLaunches();
+
+        std::lock_guard lock(modeMutex_);
+        metrics_.monitorTicks.Add();
+        SampleSelf();
+        if (fg != suppressed_) suppressed_.clear();
+        if (active_) {
+            SampleGameCpu();
+            {
+                Trace::Scope s("QueryUsage", "monitor");
+                platform_.QueryUsage(usage_);
+            }
+            SampleGameMemory();
+            UpdatePressure();
+        }
+        if (forced_) {
+            Trace::Scope s("CpuSteering.Refresh", "monitor");
+            steering_.Refresh();
+            journal_.Sync();
+            return;
+        }
+
+        // Rules only gate entering: a `for 5s` condition resets on every dip,
+        // and ending a session on one would flap in and out of Game Mode.
+        Rules::RuleSet::Decision rule;
+        if (!rules_.Empty() && !active_) {
+            Trace::Scope s("Rules", "monitor");
+            UpdateFacts(fg);
+            rule = rules_.Evaluate(MicrosSince(started_) / 1000);
+        }
+
+        if (isMonitored && !active_ && suppressed_.empty() && rule.allow) {
+            autoDetected_ = !listed;
+            Enter(fg);
+        }
+        else if (active_ && !isMonitored) {
+            Exit();
+        }
+        else if (isMonitored && active_) {
+            Trace::Scope s("CpuSteering.Refresh", "monitor");
+            steering_.Refresh();
+            journal_.Sync();
+        }
+
+        // Tell the user why a listed game in front is not being boosted.
+        const int held = isMonitored && !active_ && suppressed_.empty() ? rule.line : 0;
+        if (held != heldBy_) {
+            heldBy_ = held;
+            if (held) SetStatus("Boost held back by rule on line " + std::to_string(held));
+            else if (!active_) SetStatus("Ready - Monitoring for games");
+        }
+    }
+
+    bool Engine::DetectGame(const std::string& fg, bool listed) {
+        Trace::Scope span("Detect", "monitor");
+        Detect::Sample s;
+        if (fg.empty() || !platform_.SampleForeground(s, detectCache_) || s.exe != fg) {
+            metrics_.detectConfidence.Set(0);
+            return false;
+        }
+        if (!opts_.detect.recordFile.empty()) {
+            if (!detectLog_.is_open()) {
+                detectLog_.open(opts_.detect.recordFile, std::ios::app);
+                if (detectLog_.tellp() == 0) detectLog_ << Detect::CsvHeader << '\n';
+            }
+            // The list is the label: record with detection off to collect ground truth.
+            detectLog_ << Detect::Format(s, listed) << '\n';
+            detectLog_.flush();
+        }
+        if (listed || !opts_.detect.enabled) return false;
+        const Detect::Decision d = detector_.Observe(s);
+        metrics_.detectConfidence.Set(d.confidence);
+        return d.game;
+    }
+
+    void Engine::UpdateFacts(const std::string& game) {
+        using Rules::Fact;
+        SystemState sys;
+        if (rules_.Uses(Fact::AcPower) || rules_.Uses(Fact::Battery) || rules_.Uses(Fact::FreeRam))
+            sys = platform_.QuerySystem();
+
+        const time_t now = std::time(nullptr);
+        tm local{};
+        localtime_s(&local, &now);
+
+        if (rules_.Uses(Fact::Running) || rules_.Uses(Fact::GameCpu))
+            platform_.Enumerate(scratch_);
+
+        double gameCpu = 0;
+        if (rules_.Uses(Fact::GameCpu)) {
+            ULONGLONG cpu = 0;
+            for (const auto& p : scratch_)
+                if (_stricmp(p.exe.c_str(), game.c_str()) == 0) cpu += platform_.CpuTime(p);
+            const auto t = std::chrono::steady_clock::now();
+            const double wall = std::chrono::duration<double>(t - factGameSample_).count()
+                * 1e7 * std::max(1u, std::thread::hardware_concurrency());
+            if (game == factGame_ && wall > 0 && cpu >= factGameCpu_)
+                gameCpu = 100.0 * (cpu - factGameCpu_) / wall;
+            factGame_ = game;
+            factGameCpu_ = cpu;
+            factGameSample_ = t;
+        }
+
+        const auto& facts = rules_.Facts();
+        for (size_t i = 0; i < facts.size(); ++i) {
+            const std::string& arg = facts[i].arg;
+            double v = 0;
+            switch (facts[i].kind) {
+            case Fact::AcPower: v = sys.acPower; break;
+            case Fact::Battery: v = sys.batteryPercent; break;
+            case Fact::FreeRam: v = static_cast<double>(sys.availableMemoryMb); break;
+            case Fact::Time:    v = local.tm_hour * 60 + local.tm_min; break;
+            case Fact::Weekday: v = local.tm_wday; break;
+            case Fact::GameCpu: v = gameCpu; break;
+            case Fact::Game:    v = game == arg; break;
+            case Fact::Running:
+                v = std::any_of(scratch_.begin(), scratch_.end(),
+                    [&](const ProcessInfo& p) { return _stricmp(p.exe.c_str(), arg.c_str()) == 0; });
+                break;
+            default: break;
+            }
+            rules_.Set(i, v);
+        }
+    }
+
+    void Engine::SampleGameCpu() {
+        Trace::Scope span("SampleGameCpu", "monitor");
+        ULONGLONG cpu = 0;
+        for (const auto& p : gameProcs_) cpu += platform_.CpuTime(p);
+        const auto now = std::chrono::steady_clock::now();
+        const double wall = std::chrono::duration<double>(now - lastGameSample_).count()
+            * 1e7 * std::max(1u, std::thread::hardware_concurrency());
+        if (lastGameCpu_ && wall > 0 && cpu >= lastGameCpu_) {
+            const double share = (cpu - lastGameCpu_) / wall;
+            metrics_.gameCpuShare.Set(share);
+            sessionCpuSum_ += share;
+            ++sessionCpuSamples_;
+        }
+        lastGameCpu_ = cpu;
+        lastGameSample_ = now;
+    }
+
+    void Engine::SampleGameMemory() {
+        uint64_t workingSet = 0, faults = 0;
+        for (const auto& u : usage_) {
+            if (_stricmp(u.proc.exe.c_str(), activeGameName_.c_str()) != 0) continue;
+            workingSet += u.workingSet;
+            faults += u.hardFaults;
+        }
+        sessionPeakWs_ = std::max(sessionPeakWs_, workingSet);
+        // Counted since the game started, which is the load for a game
+        // that came to the front early in it.
+        if (std::chrono::steady_clock::now() < loadUntil_)
+            metrics_.gameLoadHardFaults.Set(static_cast<double>(faults));
+    }
+
+    void Engine::SampleSelf() {
+        const ProcessUtil::SelfUsage u = ProcessUtil::QuerySelf();
+        const auto now = std::chrono::steady_clock::now();
+        const double wall = std::chrono::duration<double>(now - lastSelfSample_).count()
+            * 1e7 * std::max(1u, std::thread::hardware_concurrency());
+        if (lastSelfCpu_ && wall > 0 && u.cpuTime >= lastSelfCpu_)
+            metrics_.selfCpuShare.Set((u.cpuTime - lastSelfCpu_) / wall);
+        metrics_.selfCpuSeconds.Set(u.cpuTime / 1e7);
+        metrics_.selfResidentBytes.Set(static_cast<double>(u.workingSet));
+        lastSelfCpu_ = u.cpuTime;
+        lastSelfSample_ = now;
+    }
+
+    // ------------------------------------------------------------
+    // Escalation
+    // ------------------------------------------------------------
+
+    void Engine::UpdatePressure() {
+        Pressure::Source* source = opts_.pressure.enabled ? platform_.PressureSource() : nullptr;
+        Pressure::Reading r;
+        if (!source || !source->Read(r)) return;
+        Trace::Scope span("Pressure", "monitor");
+        metrics_.pressureCpu.Set(r.cpu);
+        metrics_.pressureMemory.Set(r.memory);
+        metrics_.pressureIo.Set(r.io);
+
+        // Every tick, so CPU deltas cover one tick when a step comes.
+        offenders_.Observe(usage_);
+        const int step = escalator_.Update(r);
+        if (step > 0) Escalate(escalator_.Cause());
+        else if (step < 0) Deescalate();
+        metrics_.escalationLevel.Set(escalator_.Level());
+    }
+
+    bool Engine::Protected(const ProcessInfo& p, const std::string& game) const {
+        if (p.pid <= 4 || p.pid == GetCurrentProcessId()) return true;
+        if (_stricmp(p.exe.c_str(), game.c_str()) == 0) return true;
+        return std::any_of(opts_.steering.exempt.begin(), opts_.steering.exempt.end(),
+            [&](const std::string& e) { return _stricmp(e.c_str(), p.exe.c_str()) == 0; });
+    }
+
+    void Engine::Escalate(Pressure::Resource cause) {
+        Trace::Scope span("Escalate", "monitor", Pressure::ResourceName(cause));
+        auto skip = [&](const ProcessInfo& p) {
+            // svchost.exe already runs at idle for the session.
+            if (Protected(p, activeGameName_) || _stricmp(p.exe.c_str(), "svchost.exe") == 0) return true;
+            return std::any_of(escalations_.begin(), escalations_.end(), [&](const Escalation& e) {
+                return e.throttled && e.proc.pid == p.pid && e.proc.startTime == p.startTime;
+                });
+            };
+
+        Escalation step;
+        step.cause = cause;
+        if (cause == Pressure::Resource::Memory) {
+            // Trimmed pages go to the standby list; there is nothing to undo.
+            const auto top = offenders_.Top(cause, opts_.pressure.trimCount, skip);
+            for (const Pressure::Usage* u : top) {
+                Trace::Scope s("TrimWorkingSet", "monitor", u->proc.exe.c_str());
+                Report(Action::Trim,
+                    platform_.TrimWorkingSet(u->proc) ? Outcome::Ok : Outcome::Failed, u->proc.exe);
+            }
+            if (top.empty()) Report(Action::Trim, Outcome::Skipped, activeGameName_);
+        }
+        else {
+            // Another process's I/O priority cannot be lowered through a
+            // documented API; idling its CPU slows how fast it issues I/O.
+            const auto top = offenders_.Top(cause, 1, skip);
+            if (top.empty()) {
+                Report(Action::Throttle, Outcome::Skipped, activeGameName_);
+            }
+            else {
+                Trace::Scope s("Throttle", "monitor", top[0]->proc.exe.c_str());
+                step.proc = top[0]->proc;
+                step.throttled = ChangePriority(step.proc, IDLE_PRIORITY_CLASS,
+                    step.previousPriority);
+                journal_.Sync();
+                Report(Action::Throttle, step.throttled ? Outcome::Ok : Outcome::Failed,
+                    step.proc.exe);
+            }
+        }
+        escalations_.push_back(std::move(step));
+    }
+
+    bool Engine::Deescalate() {
+        if (escalations_.empty()) return false;
+        const Escalation step = std::move(escalations_.back());
+        escalations_.pop_back();
+        if (step.throttled) {
+            Trace::Scope s("Unthrottle", "monitor", step.proc.exe.c_str());
+            platform_.SetPriority(step.proc, step.previousPriority);
+            journal_.Drop(Journal::Entry::Make(Journal::Kind::Priority, step.proc,
+                step.previousPriority));
+        }
+        return true;
+    }
+
+    void Engine::Loop() {
+        Trace::NameThread("monitor");
+        platform_.Prepare();
+        Recover();
+        probe_.Start();
+        while (running_) {
+            // Transitions take seconds by design; only steady-state ticks
+            // count towards the tick cost.
+            const uint64_t before = metrics_.transitionsEnter.Value()
+                + metrics_.transitionsExit.Value();
+            const auto t0 = std::chrono::steady_clock::now();
+            Tick();
+            if (metrics_.transitionsEnter.Value() + metrics_.transitionsExit.Value() == before)
+                metrics_.tickSeconds.Observe(MicrosSince(t0) / 1e6);
+            std::unique_lock lock(wakeMutex_);
+            wake_.wait_for(lock, std::chrono::milliseconds(opts_.tickMs),
+                [this] { return !running_; });
+        }
+        {
+            std::lock_guard lock(modeMutex_);
+            Exit();
+        }
+        probe_.Stop();
+    }
+
+    void Engine::Run() {
+        running_ = true;
+        Loop();
+    }
+
+    void Engine::Start() {
+        if (monitor_.joinable()) return;
+        running_ = true;
+        monitor_ = std::thread([this] { Loop(); });
+    }
+
+    void Engine::Stop() {
+        {
+            std::lock_guard lock(wakeMutex_);
+            running_ = false;
+        }
+        wake_.notify_all();
+        if (monitor_.joinable()) monitor_.join();
+    }
+
+} // namespace Booster
@@ -0,0 +1,215 @@
+﻿#pragma once
+
+#include "Control.h"
+#include "CpuSteering.h"
+#include "Detect.h"
+#include "GameIndex.h"
+#include "Headroom.h"
+#include "History.h"
+#include "Journal.h"
+#include "LatencyProbe.h"
+#include "NumaPlacement.h"
+#include "Platform.h"
+#include "PowerQos.h"
+#include "Pressure.h"
+#include "Rules.h"
+#include "Telemetry.h"
+#include "Trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ============================================================
+// BOOST ENGINE
+// ============================================================
+//
+// The monitor loop and Game Mode transitions, independent of any window.
+// The GUI hosts one in-process; `--daemon` runs one headless behind the
+// control pipe. Construction does no I/O and starts no threads, so tests
+// can create engines by the thousand against a fake Platform.
+
+namespace Booster {
+
+    struct EngineOptions {
+        std::string configFile;     // empty keeps the game list in memory
+        std::string rulesFile;      // empty: boost whenever a listed game is in front
+        std::string historyFile;    // empty: sessions are not recorded
+        std::string journalFile;    // empty: a crashed session is not undone on restart
+        std::vector<std::string> killList{ "explorer.exe", "SearchHost.exe" };
+        CpuSteering::Options steering;
+        bool     numaPlacement = true;  // needs the real OS
+        LatencyProbe::Options latencyProbe;  // off by default; needs the real OS
+        Detect::Options detect;     // off by default: only listed games are boosted
+        Pressure::Options pressure; // mid-session escalation
+        Headroom::Options headroom; // off by default: purges and trims cannot be undone
+        PowerQos::Options powerQos; // idle states held shallow during a session
+        uint32_t tickMs = 1000;
+        uint32_t relaunchGapMs = 200;
+        uint32_t settleMs = 2000;
+    };
+
+    class Engine final : public Control {
+    public:
+        explicit Engine(EngineOptions opts, Platform& platform = Win32Platform::Instance());
+        ~Engine() override;
+
+        Engine(const Engine&) = delete;
+        Engine& operator=(const Engine&) = delete;
+
+        void LoadGames();
+        // Returns compile errors; rules on bad lines are dropped. The
+        // first error also goes to the status line.
+        std::vector<std::string> LoadRules();
+        // Undoes whatever a run that died mid-session left applied and
+        // returns how many changes that was. Loop() calls it before the
+        // first tick and Enter() before the first change; later calls do
+        // nothing.
+        size_t Recover();
+        void SaveGames() const;
+        bool IsGameInList(const std::string& name) const;
+
+        // Invoked on engine threads whenever status or the game list changes.
+        // Set both before Start().
+        void SetOnChange(std::function<void()> cb) { onChange_ = std::move(cb); }
+        void SetOnEvent(std::function<void(const Events::Event&)> cb) { onEvent_ = std::move(cb); }
+
+        const Telemetry::Registry& Metrics() const { return metrics_; }
+        // Opened on the first finished session.
+        const History::Store& SessionHistory() const { return history_; }
+
+        void Start();   // monitor loop on a background thread
+        void Run();     // monitor loop on the calling thread until Stop()
+        void Stop();
+        void Tick();    // one monitor iteration, for embedders driving their own loop
+
+        bool GetStatus(StatusInfo& out) override;
+        bool GetStats(Stats& out) override;
+        bool ListGames(std::vector<std::string>& out) override;
+        bool AddGame(const std::string& name) override;
+        bool RemoveGame(const std::string& name) override;
+        bool ForceEnter(const std::string& name) override;
+        bool ForceExit() override;
+        bool DumpTrace(const std::string& path) override;
+        bool RecentEvents(uint64_t after, std::vector<Events::Event>& out) override;
+
+        // Lock-free view for in-process front ends.
+        const Events::Channel& Channel() const { return events_; }
+
+    private:
+        void Loop();
+        void SampleGameCpu();
+        // Game working set and load-time hard faults, from usage_.
+        void SampleGameMemory();
+        void SampleSelf();
+        void UpdatePressure();
+        // Never trimmed or throttled: the system, the booster and `game`.
+        bool Protected(const ProcessInfo& p, const std::string& game) const;
+        void Escalate(Pressure::Resource cause);
+        // Undoes the most recent step; false when none is left.
+        bool Deescalate();
+        void AppendGameLog(const std::string& line) const;
+        bool DetectGame(const std::string& fg, bool listed);
+        void UpdateFacts(const std::string& game);
+        void Enter(const std::string& gameName);
+        void Exit();
+        void WatchLaunches();
+        void ReserveHeadroom(const std::string& game);
+        void HoldPowerQos(const std::string& gameName);
+        // Idle-state residency since the last call, as the idle or boosted gauges.
+        void ObserveResidency(bool boosted);
+        size_t OpenJournal();
+        // Journals the class it replaces before changing it.
+        bool ChangePriority(const ProcessInfo& p, DWORD priorityClass, DWORD& original);
+        // Undoes every journaled change, newest first; returns how many took.
+        size_t Replay(bool crashed);
+        bool OpenHistory();
+        void RecordSession();
+        void SetStatus(const std::string& text);
+        void BumpRevision();
+        void Report(Telemetry::Action action, Telemetry::Outcome outcome,
+            const std::string& subject, uint32_t error = 0);
+        void Emit(Events::Kind kind, uint8_t code, Telemetry::Outcome outcome,
+            const std::string& subject, uint32_t error = 0);
+        void Notify() const { if (onChange_) onChange_(); }
+
+        const EngineOptions opts_;
+        Platform&           platform_;
+
+        GameIndex::Index   games_;
+        mutable std::mutex gamesMutex_;
+
+        Events::Channel events_;
+
+        // Transitions can be requested from the monitor and from control
+        // clients; modeMutex_ serializes them.
+        std::mutex                         modeMutex_;
+        bool                               active_ = false;
+        bool                               forced_ = false;
+        std::string                        suppressed_;
+        std::string                        activeGameName_;
+        Journal::Log                       journal_;
+        bool                               journalOpened_ = false;
+        CpuSteering::Steering              steering_;
+        Numa::Placement                    numa_;
+        LatencyProbe::Probe                probe_;
+        History::Store                     history_;
+        History::Record                    session_;
+        double                             sessionCpuSum_ = 0;
+        uint32_t                           sessionCpuSamples_ = 0;
+        uint64_t                           sessionPeakWs_ = 0;
+        std::chrono::steady_clock::time_point loadUntil_;
+        std::mutex                         historyMutex_;      // opening history_
+        std::vector<ProcessInfo>           scratch_;
+        // One entry per step up, undone last-in first-out.
+        struct Escalation {
+            Pressure::Resource cause = Pressure::Resource::Cpu;
+            bool               throttled = false;
+            ProcessInfo        proc;
+            DWORD              previousPriority = 0;
+        };
+        Pressure::Escalator                escalator_;
+        Pressure::Offenders                offenders_;
+        std::vector<Pressure::Usage>       usage_;
+        std::vector<Escalation>            escalations_;
+        bool                               autoDetected_ = false;  // active game not on the list: no kills or demotions
+        Rules::RuleSet                     rules_;
+        int                                heldBy_ = 0;    // rule line holding the boost back
+        std::string                        factGame_;
+        ULONGLONG                          factGameCpu_ = 0;
+        std::chrono::steady_clock::time_point factGameSample_;
+
+        // Sampled and observed on the monitor thread only.
+        std::vector<Pressure::Usage> launchUsage_;
+        std::vector<std::string>     runningGames_;     // listed games seen last tick
+        bool                         launchesPrimed_ = false;
+        Detect::Detector    detector_;
+        Detect::SampleCache detectCache_;
+        std::ofstream       detectLog_;
+
+        std::atomic<bool>       running_{ false };
+        std::mutex              wakeMutex_;
+        std::condition_variable wake_;
+        std::thread             monitor_;
+        std::function<void()>   onChange_;
+        std::function<void(const Events::Event&)> onEvent_;
+
+        Telemetry::Registry metrics_;
+        const std::chrono::steady_clock::time_point started_ =
+            std::chrono::steady_clock::now();
+        std::atomic<uint64_t> lastEnterUs_{ 0 }, lastExitUs_{ 0 };
+
+        std::vector<ProcessUtil::ProcessInfo>  gameProcs_;
+        ULONGLONG                              lastGameCpu_ = 0;
+        std::chrono::steady_clock::time_point  lastGameSample_;
+        ULONGLONG                              lastSelfCpu_ = 0;
+        std::chrono::steady_clock::time_point  lastSelfSample_;
+    };
+
+} // namespace Booster
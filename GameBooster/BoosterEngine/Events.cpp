@@ -0,0 +1,127 @@
+﻿#define NOMINMAX
+
+#include "Events.h"
+#include "Telemetry.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <thread>
+
+namespace Events {
+
+    // ------------------------------------------------------------
+    // Writers
+    // ------------------------------------------------------------
+
+    void Channel::Publish() {
+        const uint32_t v = version_.load(std::memory_order_relaxed);
+        version_.store(v + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&published_, &current_, sizeof(published_));
+        version_.store(v + 2, std::memory_order_release);
+    }
+
+    uint64_t Channel::Push(Kind kind, uint8_t code, uint8_t outcome,
+        const std::string& subject, uint32_t error)
+    {
+        std::lock_guard lock(writer_);
+        const uint64_t i = head_.load(std::memory_order_relaxed);
+        Slot& slot = ring_[i % Capacity];
+
+        Event e;
+        e.seq = i + 1;
+        e.timeUs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        e.kind = kind;
+        e.code = code;
+        e.outcome = outcome;
+        e.error = error;
+        Copy(e.subject, subject);
+
+        slot.seq.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&slot.event, &e, sizeof(e));
+        slot.seq.store(e.seq, std::memory_order_release);
+        head_.store(i + 1, std::memory_order_release);
+
+        current_.lastEvent = e.seq;
+        Publish();
+        return e.seq;
+    }
+
+    // ------------------------------------------------------------
+    // Readers
+    // ------------------------------------------------------------
+
+    void Channel::Read(Snapshot& out) const {
+        for (;;) {
+            const uint32_t v = version_.load(std::memory_order_acquire);
+            if (v & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            std::memcpy(&out, &published_, sizeof(out));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (version_.load(std::memory_order_relaxed) == v) return;
+        }
+    }
+
+    size_t Channel::Since(uint64_t after, Event* out, size_t max) const {
+        const uint64_t head = head_.load(std::memory_order_acquire);
+        uint64_t first = head > Capacity ? head - Capacity : 0;
+        if (first < after) first = after;
+        size_t n = 0;
+        for (uint64_t i = first; i < head && n < max; ++i) {
+            const Slot& slot = ring_[i % Capacity];
+            if (slot.seq.load(std::memory_order_acquire) != i + 1) continue;
+            std::memcpy(&out[n], &slot.event, sizeof(Event));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) != i + 1) continue;
+            ++n;
+        }
+        return n;
+    }
+
+    // ------------------------------------------------------------
+    // Formatting
+    // ------------------------------------------------------------
+
+    std::string Describe(const Event& e) {
+        const time_t secs = static_cast<time_t>(e.timeUs / 1000000);
+        tm local{};
+        localtime_s(&local, &secs);
+        char when[32];
+        snprintf(when, sizeof(when), "%02d:%02d:%02d.%03u",
+            local.tm_hour, local.tm_min, local.tm_sec,
+            static_cast<unsigned>(e.timeUs / 1000 % 1000));
+
+        const auto action = static_cast<Telemetry::Action>(e.code);
+        const auto outcome = static_cast<Telemetry::Outcome>(e.outcome);
+        char line[160];
+        switch (e.kind) {
+        case Kind::Transition: {
+            const auto t = static_cast<Transition>(e.code);
+            snprintf(line, sizeof(line), "%s #%llu %s %s", when,
+                static_cast<unsigned long long>(e.seq),
+                t == Transition::Enter ? "enter" : t == Transition::Exit ? "exit" : "recover",
+                e.subject);
+            break;
+        }
+        case Kind::Action:
+            snprintf(line, sizeof(line), "%s #%llu %s %s %s", when,
+                static_cast<unsigned long long>(e.seq),
+                Telemetry::ActionName(action), Telemetry::OutcomeName(outcome), e.subject);
+            break;
+        default:
+            snprintf(line, sizeof(line), "%s #%llu %s failed %s (error %lu)", when,
+                static_cast<unsigned long long>(e.seq),
+                Telemetry::ActionName(action), e.subject,
+                static_cast<unsigned long>(e.error));
+            break;
+        }
+        return line;
+    }
+
+} // namespace Events
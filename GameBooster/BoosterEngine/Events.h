@@ -0,0 +1,95 @@
+﻿#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// ============================================================
+// EVENT CHANNEL
+// ============================================================
+//
+// What the engine publishes for its front ends: the current state as a
+// seqlock-protected snapshot, and a ring of recent typed events. Readers
+// never lock or allocate. Writers are serialized among themselves, so
+// the ring always has exactly one producer at a time.
+
+namespace Events {
+
+    enum class Kind : uint8_t { Transition = 1, Action, Error };
+    enum class Transition : uint8_t { Enter, Exit, Recover };
+
+    struct Event {
+        uint64_t seq = 0;       // 1-based, no gaps
+        uint64_t timeUs = 0;    // system clock, microseconds since 1970
+        Kind     kind = Kind::Transition;
+        uint8_t  code = 0;      // Transition, or Telemetry::Action for Action/Error
+        uint8_t  outcome = 0;   // Telemetry::Outcome
+        uint32_t error = 0;     // Win32 error for Error events
+        char     subject[48]{}; // game or process name
+    };
+
+    struct Snapshot {
+        bool     active = false;
+        bool     forced = false;
+        uint32_t revision = 0;  // bumped whenever the game list changes
+        uint64_t lastEvent = 0; // seq of the newest event
+        char     game[64]{};
+        char     text[96]{};
+    };
+
+    // Truncating copy into a fixed field.
+    template <size_t N>
+    void Copy(char (&dst)[N], const std::string& src) {
+        const size_t n = src.size() < N - 1 ? src.size() : N - 1;
+        src.copy(dst, n);
+        dst[n] = 0;
+    }
+
+    // One-line human-readable form, for logs and the CLI.
+    std::string Describe(const Event& e);
+
+    class Channel {
+    public:
+        static constexpr size_t Capacity = 256;
+
+        Channel() = default;
+        Channel(const Channel&) = delete;
+        Channel& operator=(const Channel&) = delete;
+
+        // Applies `edit` to the current state and publishes the result.
+        template <class F>
+        void Update(F&& edit) {
+            std::lock_guard lock(writer_);
+            edit(current_);
+            Publish();
+        }
+
+        uint64_t Push(Kind kind, uint8_t code, uint8_t outcome,
+            const std::string& subject, uint32_t error = 0);
+
+        void Read(Snapshot& out) const;
+
+        // Copies up to `max` retained events with seq > `after`, oldest
+        // first. Events the ring has already overwritten are skipped.
+        size_t Since(uint64_t after, Event* out, size_t max) const;
+
+    private:
+        struct Slot {
+            std::atomic<uint64_t> seq{ 0 };     // event seq once complete, 0 while written
+            Event                 event;
+        };
+
+        void Publish();
+
+        std::mutex             writer_;
+        Snapshot               current_;
+        std::atomic<uint32_t>  version_{ 0 };  // odd while `published_` is written
+        Snapshot               published_;
+        std::atomic<uint64_t>  head_{ 0 };
+        std::array<Slot, Capacity> ring_;
+    };
+
+} // namespace Events
@@ -0,0 +1,104 @@
+﻿#define NOMINMAX
+#include "FrameStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+namespace FrameStats {
+
+    namespace {
+
+        void MeanVar(const std::vector<double>& v, double& mean, double& var) {
+            mean = 0;
+            var = 0;
+            if (v.empty()) return;
+            for (double x : v) mean += x;
+            mean /= v.size();
+            if (v.size() < 2) return;
+            for (double x : v) var += (x - mean) * (x - mean);
+            var /= v.size() - 1;
+        }
+
+    } // namespace
+
+    double Percentile(const std::vector<double>& sorted, double q) {
+        if (sorted.empty()) return 0;
+        const double rank = std::ceil(q * sorted.size());
+        const size_t i = rank < 1 ? 0 : static_cast<size_t>(rank) - 1;
+        return sorted[std::min(i, sorted.size() - 1)];
+    }
+
+    Summary Summarize(std::vector<double> frameMs, double targetMs) {
+        Summary s;
+        s.frames = frameMs.size();
+        if (frameMs.empty()) return s;
+        double var;
+        MeanVar(frameMs, s.meanMs, var);
+        s.stddevMs = std::sqrt(var);
+        std::sort(frameMs.begin(), frameMs.end());
+        s.p50Ms = Percentile(frameMs, 0.5);
+        s.p99Ms = Percentile(frameMs, 0.99);
+        s.p999Ms = Percentile(frameMs, 0.999);
+        s.maxMs = frameMs.back();
+        const double limit = targetMs * StutterFactor;
+        s.stutters = frameMs.end()
+            - std::upper_bound(frameMs.begin(), frameMs.end(), limit);
+        return s;
+    }
+
+    Comparison Compare(const std::vector<double>& a, const std::vector<double>& b) {
+        Comparison c;
+        c.runsA = a.size();
+        c.runsB = b.size();
+        if (a.empty() || b.empty()) return c;
+
+        std::vector<double> pooled(a);
+        pooled.insert(pooled.end(), b.begin(), b.end());
+        double total = 0;
+        for (double x : pooled) total += x;
+        const size_t n = pooled.size(), na = a.size(), nb = b.size();
+        auto difference = [&](double sumA) { return sumA / na - (total - sumA) / nb; };
+
+        double sumA = 0;
+        for (double x : a) sumA += x;
+        c.difference = difference(sumA);
+        // Relabellings at least as extreme; the slack absorbs rounding in
+        // the sums so the observed split always counts itself.
+        const double observed = std::fabs(c.difference) * (1 - 1e-12);
+
+        double splits = 1;
+        for (size_t k = 1; k <= na; ++k) splits = splits * (n - na + k) / k;
+
+        size_t extreme = 0;
+        if (n < 32 && splits <= 1e6) {
+            // Every subset of na runs, in mask order (Gosper's hack).
+            const uint32_t end = 1u << n;
+            for (uint32_t mask = (1u << na) - 1; mask < end;) {
+                double s = 0;
+                for (size_t i = 0; i < n; ++i)
+                    if (mask >> i & 1) s += pooled[i];
+                extreme += std::fabs(difference(s)) >= observed;
+                const uint32_t low = mask & (0u - mask);
+                const uint32_t ripple = mask + low;
+                mask = (((ripple ^ mask) >> 2) / low) | ripple;
+            }
+            c.p = extreme / splits;
+        }
+        else {
+            constexpr size_t Samples = 100000;
+            std::mt19937 rng(1);    // fixed, so a report reproduces
+            std::vector<double> shuffled(pooled);
+            for (size_t i = 0; i < Samples; ++i) {
+                std::shuffle(shuffled.begin(), shuffled.end(), rng);
+                double s = 0;
+                for (size_t k = 0; k < na; ++k) s += shuffled[k];
+                extreme += std::fabs(difference(s)) >= observed;
+            }
+            c.p = (extreme + 1.0) / (Samples + 1.0);
+        }
+        return c;
+    }
+
+} // namespace FrameStats
@@ -0,0 +1,47 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// ============================================================
+// FRAME-TIME STATISTICS
+// ============================================================
+//
+// Summaries and A/B comparison for frame-time samples (milliseconds).
+// Pure math, no OS calls.
+
+namespace FrameStats {
+
+    struct Summary {
+        size_t frames = 0;
+        double meanMs = 0;
+        double stddevMs = 0;
+        double p50Ms = 0;
+        double p99Ms = 0;
+        double p999Ms = 0;
+        double maxMs = 0;
+        size_t stutters = 0;    // frames longer than StutterFactor x target
+    };
+
+    constexpr double StutterFactor = 2.0;
+
+    Summary Summarize(std::vector<double> frameMs, double targetMs);
+
+    // Nearest-rank percentile of an ascending sample, q in [0, 1].
+    double Percentile(const std::vector<double>& sorted, double q);
+
+    // Two-sided permutation test of `a` against `b`, where each holds one
+    // statistic per run (its mean or p99, say). Frames within a run are
+    // far from independent, so the run is the unit of evidence: every way
+    // of relabelling the runs is tried, or 100 000 random ones past a
+    // million. With n runs a side the smallest p-value possible is
+    // 2 / C(2n, n): 0.1 at 3, 0.008 at 5.
+    struct Comparison {
+        double difference = 0;      // mean of a minus mean of b; positive when a is slower
+        double p = 1;
+        size_t runsA = 0, runsB = 0;
+    };
+
+    Comparison Compare(const std::vector<double>& a, const std::vector<double>& b);
+
+} // namespace FrameStats
@@ -0,0 +1,315 @@
+﻿#define NOMINMAX
+#include "GameIndex.h"
+
+#include <algorithm>
+
+namespace GameIndex {
+
+    namespace {
+
+        // ASCII only, like the rest of the game list; no locale lookup per byte.
+        char Fold(char c) {
+            return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+
+        std::string Lower(std::string s) {
+            std::transform(s.begin(), s.end(), s.begin(), Fold);
+            return s;
+        }
+
+        uint32_t Gram(const std::string& s, size_t i) {
+            return static_cast<uint32_t>(static_cast<unsigned char>(Fold(s[i]))) << 16
+                | static_cast<uint32_t>(static_cast<unsigned char>(Fold(s[i + 1]))) << 8
+                | static_cast<unsigned char>(Fold(s[i + 2]));
+        }
+
+        // `lowerQuery` is already folded.
+        bool ContainsFolded(const std::string& name, const std::string& lowerQuery) {
+            return std::search(name.begin(), name.end(), lowerQuery.begin(), lowerQuery.end(),
+                [](char a, char b) { return Fold(a) == b; }) != name.end();
+        }
+
+    } // namespace
+
+    Index::Index() : nodes_(1) {}
+
+    // ------------------------------------------------------------
+    // Treap
+    // ------------------------------------------------------------
+
+    uint32_t Index::Update(uint32_t t) {
+        Node& n = nodes_[t];
+        n.size = 1 + nodes_[n.left].size + nodes_[n.right].size;
+        return t;
+    }
+
+    uint32_t Index::Merge(uint32_t a, uint32_t b) {
+        if (!a) return b;
+        if (!b) return a;
+        if (nodes_[a].priority > nodes_[b].priority) {
+            nodes_[a].right = Merge(nodes_[a].right, b);
+            return Update(a);
+        }
+        nodes_[b].left = Merge(a, nodes_[b].left);
+        return Update(b);
+    }
+
+    void Index::Split(uint32_t t, const std::string& name, uint32_t& lo, uint32_t& hi) {
+        if (!t) {
+            lo = hi = 0;
+            return;
+        }
+        if (nodes_[t].name < name) {
+            Split(nodes_[t].right, name, nodes_[t].right, hi);
+            lo = Update(t);
+        }
+        else {
+            Split(nodes_[t].left, name, lo, nodes_[t].left);
+            hi = Update(t);
+        }
+    }
+
+    uint32_t Index::EraseFrom(uint32_t t, const std::string& name, bool& erased) {
+        if (!t) return 0;
+        Node& n = nodes_[t];
+        if (name < n.name) {
+            n.left = EraseFrom(n.left, name, erased);
+        }
+        else if (n.name < name) {
+            n.right = EraseFrom(n.right, name, erased);
+        }
+        else {
+            erased = true;
+            n.alive = false;
+            const uint32_t rest = Merge(n.left, n.right);
+            n.left = n.right = 0;
+            return rest;
+        }
+        return Update(t);
+    }
+
+    bool Index::Insert(const std::string& name) {
+        if (Contains(name)) return false;
+        uint32_t lo, hi;
+        Split(root_, name, lo, hi);
+
+        seed_ ^= seed_ << 13;
+        seed_ ^= seed_ >> 17;
+        seed_ ^= seed_ << 5;
+        Node n;
+        n.name = name;
+        n.size = 1;
+        n.priority = seed_;
+        n.alive = true;
+        nodes_.push_back(std::move(n));
+        const uint32_t slot = static_cast<uint32_t>(nodes_.size() - 1);
+
+        root_ = Merge(Merge(lo, slot), hi);
+        if (indexed_) IndexGrams(slot);
+        ++revision_;
+        return true;
+    }
+
+    bool Index::Erase(const std::string& name) {
+        bool erased = false;
+        root_ = EraseFrom(root_, name, erased);
+        if (!erased) return false;
+        ++dead_;
+        ++revision_;
+        // Amortised: a sweep costs O(n log n) after more than n erases.
+        if (dead_ > 1024 && dead_ > Size()) Sweep();
+        return true;
+    }
+
+    bool Index::Contains(const std::string& name) const {
+        for (uint32_t t = root_; t;) {
+            const Node& n = nodes_[t];
+            if (name < n.name) t = n.left;
+            else if (n.name < name) t = n.right;
+            else return true;
+        }
+        return false;
+    }
+
+    void Index::Clear() {
+        nodes_.assign(1, Node());
+        root_ = 0;
+        dead_ = 0;
+        indexed_ = false;
+        grams_.clear();
+        ++revision_;
+    }
+
+    const std::string& Index::At(size_t rank) const {
+        uint32_t t = root_;
+        for (;;) {
+            const Node& n = nodes_[t];
+            const size_t left = nodes_[n.left].size;
+            if (rank < left) {
+                t = n.left;
+            }
+            else if (rank == left) {
+                return n.name;
+            }
+            else {
+                rank -= left + 1;
+                t = n.right;
+            }
+        }
+    }
+
+    size_t Index::LowerBound(const std::string& name) const {
+        size_t rank = 0;
+        for (uint32_t t = root_; t;) {
+            const Node& n = nodes_[t];
+            if (n.name < name) {
+                rank += nodes_[n.left].size + 1;
+                t = n.right;
+            }
+            else {
+                t = n.left;
+            }
+        }
+        return rank;
+    }
+
+    void Index::InOrder(std::vector<uint32_t>& out) const {
+        out.clear();
+        out.reserve(Size());
+        std::vector<uint32_t> stack;
+        for (uint32_t t = root_; t || !stack.empty();) {
+            if (t) {
+                stack.push_back(t);
+                t = nodes_[t].left;
+                continue;
+            }
+            t = stack.back();
+            stack.pop_back();
+            out.push_back(t);
+            t = nodes_[t].right;
+        }
+    }
+
+    std::vector<std::string> Index::Items() const {
+        std::vector<uint32_t> slots;
+        InOrder(slots);
+        std::vector<std::string> out;
+        out.reserve(slots.size());
+        for (const uint32_t s : slots) out.push_back(nodes_[s].name);
+        return out;
+    }
+
+    void Index::Assign(std::vector<std::string> names) {
+        std::sort(names.begin(), names.end());
+        names.erase(std::unique(names.begin(), names.end()), names.end());
+        const std::vector<std::string> current = Items();
+        size_t i = 0, j = 0;
+        while (i < current.size() || j < names.size()) {
+            if (j == names.size() || (i < current.size() && current[i] < names[j]))
+                Erase(current[i++]);
+            else if (i == current.size() || names[j] < current[i])
+                Insert(names[j++]);
+            else
+                ++i, ++j;
+        }
+    }
+
+    void Index::Sweep() {
+        const std::vector<std::string> names = Items();
+        const bool indexed = indexed_;
+        Clear();
+        for (const auto& name : names) Insert(name);
+        if (indexed) {
+            indexed_ = true;
+            for (uint32_t s = 1; s < nodes_.size(); ++s) IndexGrams(s);
+        }
+    }
+
+    // ------------------------------------------------------------
+    // Search
+    // ------------------------------------------------------------
+
+    void Index::IndexGrams(uint32_t slot) {
+        const std::string& name = nodes_[slot].name;
+        for (size_t i = 0; i + 3 <= name.size(); ++i) {
+            auto& postings = grams_[Gram(name, i)];
+            // Slots only grow, so postings stay sorted without effort.
+            if (postings.empty() || postings.back() != slot) postings.push_back(slot);
+        }
+    }
+
+    std::vector<uint32_t> Index::Search(const std::string& query) {
+        const std::string q = Lower(query);
+        std::vector<uint32_t> out;
+        if (q.size() < 3) {
+            // Too short for trigrams: a scan, already in name order.
+            InOrder(out);
+            Refine(out, q);
+            return out;
+        }
+        if (!indexed_) {
+            indexed_ = true;
+            for (uint32_t s = 1; s < nodes_.size(); ++s)
+                if (nodes_[s].alive) IndexGrams(s);
+        }
+
+        const std::vector<uint32_t>* shortest = nullptr;
+        for (size_t i = 0; i + 3 <= q.size(); ++i) {
+            const auto it = grams_.find(Gram(q, i));
+            if (it == grams_.end()) return out;
+            if (!shortest || it->second.size() < shortest->size()) shortest = &it->second;
+        }
+        for (const uint32_t s : *shortest)
+            if (nodes_[s].alive && ContainsFolded(nodes_[s].name, q)) out.push_back(s);
+        std::sort(out.begin(), out.end(),
+            [this](uint32_t a, uint32_t b) { return nodes_[a].name < nodes_[b].name; });
+        return out;
+    }
+
+    void Index::Refine(std::vector<uint32_t>& slots, const std::string& query) const {
+        const std::string q = Lower(query);
+        slots.erase(std::remove_if(slots.begin(), slots.end(), [&](uint32_t s) {
+            return !nodes_[s].alive || !ContainsFolded(nodes_[s].name, q);
+            }), slots.end());
+    }
+
+    // ------------------------------------------------------------
+    // View
+    // ------------------------------------------------------------
+
+    bool View::Update(Index& index, const std::string& query) {
+        const std::string q = Lower(query);
+        const bool fresh = revision_ == index.Revision();
+        if (fresh && q == query_) return false;
+
+        if (q.empty())
+            hits_.clear();
+        else if (fresh && !query_.empty() && q.find(query_) != std::string::npos)
+            index.Refine(hits_, q);
+        else
+            hits_ = index.Search(q);
+        query_ = q;
+        revision_ = index.Revision();
+        return true;
+    }
+
+    size_t View::Size(const Index& index) const {
+        return query_.empty() ? index.Size() : hits_.size();
+    }
+
+    const std::string& View::Row(const Index& index, size_t row) const {
+        return query_.empty() ? index.At(row) : index.Name(hits_[row]);
+    }
+
+    int View::Find(const Index& index, const std::string& name) const {
+        if (query_.empty()) {
+            const size_t rank = index.LowerBound(name);
+            return rank < index.Size() && index.At(rank) == name ? static_cast<int>(rank) : -1;
+        }
+        const auto it = std::lower_bound(hits_.begin(), hits_.end(), name,
+            [&](uint32_t s, const std::string& n) { return index.Name(s) < n; });
+        return it != hits_.end() && index.Name(*it) == name
+            ? static_cast<int>(it - hits_.begin()) : -1;
+    }
+
+} // namespace GameIndex
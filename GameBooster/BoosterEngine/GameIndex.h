@@ -0,0 +1,98 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ============================================================
+// GAME INDEX
+// ============================================================
+//
+// The game list as an ordered set: a treap keyed by name with subtree
+// sizes, so insert, erase, lookup and "n-th entry" are all O(log n).
+// A trigram index for substring search is built on the first search and
+// kept up to date from then on; erased entries are tombstoned and swept
+// once they outnumber the live ones. Not thread-safe.
+
+namespace GameIndex {
+
+    class Index {
+    public:
+        Index();
+
+        bool Insert(const std::string& name);
+        bool Erase(const std::string& name);
+        bool Contains(const std::string& name) const;
+        void Clear();
+
+        size_t Size() const { return nodes_[root_].size; }
+        bool Empty() const { return Size() == 0; }
+        // Entry at `rank` (< Size()) in name order.
+        const std::string& At(size_t rank) const;
+        // Rank of `name`, or of where it would be inserted.
+        size_t LowerBound(const std::string& name) const;
+
+        std::vector<std::string> Items() const;
+        // Makes the contents equal to `names`, touching only the differences.
+        void Assign(std::vector<std::string> names);
+
+        // Bumped by every change; lets views tell whether they are stale.
+        uint64_t Revision() const { return revision_; }
+
+        // Slots of live entries containing `query` (case-insensitive),
+        // in name order.
+        std::vector<uint32_t> Search(const std::string& query);
+        // Narrows `slots` to those whose entry contains `query`.
+        void Refine(std::vector<uint32_t>& slots, const std::string& query) const;
+        const std::string& Name(uint32_t slot) const { return nodes_[slot].name; }
+
+    private:
+        struct Node {
+            std::string name;
+            uint32_t    left = 0, right = 0;    // 0 is the empty tree
+            uint32_t    size = 0;
+            uint32_t    priority = 0;
+            bool        alive = false;
+        };
+
+        uint32_t Update(uint32_t t);
+        uint32_t Merge(uint32_t a, uint32_t b);
+        // Splits `t` into keys < name and keys >= name.
+        void Split(uint32_t t, const std::string& name, uint32_t& lo, uint32_t& hi);
+        uint32_t EraseFrom(uint32_t t, const std::string& name, bool& erased);
+        void InOrder(std::vector<uint32_t>& out) const;
+        void IndexGrams(uint32_t slot);
+        void Sweep();
+
+        std::vector<Node> nodes_;
+        uint32_t root_ = 0;
+        uint32_t dead_ = 0;
+        uint32_t seed_ = 0x9E3779B9u;
+        uint64_t revision_ = 0;
+        bool     indexed_ = false;
+        std::unordered_map<uint32_t, std::vector<uint32_t>> grams_;
+    };
+
+    // A filtered, virtualized window onto an Index: rows are resolved on
+    // demand, and typing more of the same query refines the previous
+    // matches instead of searching again.
+    class View {
+    public:
+        // Returns true when the rows changed.
+        bool Update(Index& index, const std::string& query);
+
+        size_t Size(const Index& index) const;
+        const std::string& Row(const Index& index, size_t row) const;
+        // Row showing `name`, or -1.
+        int Find(const Index& index, const std::string& name) const;
+        const std::string& Query() const { return query_; }
+        bool Filtered() const { return !query_.empty(); }
+
+    private:
+        std::string           query_;
+        uint64_t              revision_ = UINT64_MAX;
+        std::vector<uint32_t> hits_;
+    };
+
+} // namespace GameIndex
@@ -0,0 +1,23 @@
+﻿#define NOMINMAX
+#include "Headroom.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace Headroom {
+
+    uint64_t Target(const Options& opts, uint64_t footprint, uint64_t total) {
+        const uint64_t want = footprint + (opts.marginMb << 20);
+        return std::min(want, static_cast<uint64_t>(total * opts.maxShare));
+    }
+
+    std::string Describe(const Result& r) {
+        char text[48];
+        snprintf(text, sizeof(text), "%llu->%llu/%llu MB free, %d trimmed",
+            static_cast<unsigned long long>(r.freeBefore >> 20),
+            static_cast<unsigned long long>(r.freeAfter >> 20),
+            static_cast<unsigned long long>(r.target >> 20), r.trimmed);
+        return text;
+    }
+
+} // namespace Headroom
@@ -0,0 +1,55 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <string>
+
+// ============================================================
+// MEMORY HEADROOM
+// ============================================================
+//
+// Free physical memory for a game that is about to load. Windows hands
+// out free and zeroed pages at once; every other page has to be taken
+// from someone first (repurposed from the standby cache, or trimmed from
+// a working set and written out if dirty), and a loading game pays for
+// that in stalled faults. When a listed game's first process appears, the
+// engine estimates what it will need from its past sessions and frees that
+// much ahead of its load: cache nobody has used lately first, then the
+// largest background working sets, then the rest of the cache, stopping at
+// the target or the budget. None of it can be undone, so it is opt-in.
+
+namespace Headroom {
+
+    struct Options {
+        bool     enabled = false;
+        uint32_t budgetMs = 1000;
+        double   quantile = 0.9;        // of the game's past peak working sets
+        uint64_t fallbackMb = 2048;     // footprint of a game without history
+        uint64_t marginMb = 512;
+        double   maxShare = 0.75;       // never aim for more of RAM than this
+        int      maxTrims = 32;         // background working sets trimmed at most
+        uint32_t loadWindowMs = 120000; // the game's hard faults count this long
+    };
+
+    // Physical memory by page list, in bytes.
+    struct MemoryState {
+        uint64_t total = 0;
+        uint64_t free = 0;          // free and zeroed: handed out without a stall
+        uint64_t standby = 0;       // clean cache, every priority
+        uint64_t modified = 0;      // dirty; written out before reuse
+    };
+
+    // Free memory to aim for ahead of a game that peaks at `footprint`.
+    uint64_t Target(const Options& opts, uint64_t footprint, uint64_t total);
+
+    struct Result {
+        uint64_t footprint = 0, target = 0;
+        uint64_t freeBefore = 0, freeAfter = 0;
+        int      trimmed = 0;       // working sets emptied
+
+        bool Reached() const { return freeAfter >= target; }
+    };
+
+    // "310->2240/2560 MB free, 6 trimmed", short enough for an event subject.
+    std::string Describe(const Result& r);
+
+} // namespace Headroom
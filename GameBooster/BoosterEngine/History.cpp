@@ -0,0 +1,241 @@
+﻿#define NOMINMAX
+#include "History.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+namespace History {
+
+    namespace {
+
+        constexpr char     Magic[8] = { 'G', 'B', 'H', 'I', 'S', 'T', '1', 0 };
+        constexpr uint32_t Version = 1;
+        constexpr uint64_t MinCapacity = 64 * 1024;
+
+        uint32_t Checksum(const Record& r) {
+            // FNV-1a over everything but the check field.
+            const auto* p = reinterpret_cast<const uint8_t*>(&r);
+            uint32_t h = 2166136261u;
+            for (size_t i = 0; i < offsetof(Record, check); ++i) {
+                h ^= p[i];
+                h *= 16777619u;
+            }
+            return h;
+        }
+
+        bool Valid(const Record& r) {
+            return r.startMs != 0 && r.check == Checksum(r);
+        }
+
+        std::string GameOf(const Record& r) {
+            return std::string(r.game, strnlen(r.game, sizeof(r.game)));
+        }
+
+    } // namespace
+
+    uint64_t NowMs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+    // ------------------------------------------------------------
+    // Mapping
+    // ------------------------------------------------------------
+
+    bool Store::Open(const std::string& path, bool writable) {
+        Close();
+        std::lock_guard lock(mutex_);
+        file_ = CreateFileA(path.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+            FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+            writable ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) return false;
+        writable_ = writable;
+
+        LARGE_INTEGER size{};
+        GetFileSizeEx(file_, &size);
+        const bool fresh = size.QuadPart == 0;
+        if (fresh && !writable) {
+            Unmap();
+            return false;
+        }
+        // An existing file is only grown once it has been recognised.
+        const uint64_t bytes = static_cast<uint64_t>(size.QuadPart);
+        if (!Map(fresh ? MinCapacity : bytes)) {
+            Unmap();
+            return false;
+        }
+
+        auto* header = reinterpret_cast<Header*>(view_);
+        if (fresh) {
+            std::memcpy(header->magic, Magic, sizeof(Magic));
+            header->version = Version;
+            header->recordSize = sizeof(Record);
+        }
+        else if (bytes < sizeof(Header) || std::memcmp(header->magic, Magic, sizeof(Magic)) != 0
+            || header->recordSize != sizeof(Record)) {
+            // Not ours; leave it untouched.
+            Unmap();
+            return false;
+        }
+        ours_ = true;
+
+        const Record* records = Records();
+        const uint64_t fits = (capacity_ - sizeof(Header)) / sizeof(Record);
+        while (count_ < fits && Valid(records[count_])) {
+            byGame_[GameOf(records[count_])].push_back(count_);
+            lastStartMs_ = records[count_].startMs;
+            ++count_;
+        }
+        return true;
+    }
+
+    bool Store::Map(uint64_t bytes) {
+        if (view_) UnmapViewOfFile(view_);
+        if (mapping_) CloseHandle(mapping_);
+        view_ = nullptr;
+        mapping_ = CreateFileMappingA(file_, nullptr, writable_ ? PAGE_READWRITE : PAGE_READONLY,
+            static_cast<DWORD>(bytes >> 32), static_cast<DWORD>(bytes), nullptr);
+        if (!mapping_) return false;
+        view_ = static_cast<uint8_t*>(MapViewOfFile(mapping_,
+            writable_ ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, static_cast<SIZE_T>(bytes)));
+        capacity_ = view_ ? bytes : 0;
+        return view_ != nullptr;
+    }
+
+    void Store::Unmap() {
+        if (view_) UnmapViewOfFile(view_);
+        if (mapping_) CloseHandle(mapping_);
+        // Growing the mapping extended the file with zeros; drop them.
+        if (writable_ && ours_) {
+            LARGE_INTEGER end;
+            end.QuadPart = static_cast<LONGLONG>(sizeof(Header) + uint64_t{ count_ } * sizeof(Record));
+            if (SetFilePointerEx(file_, end, nullptr, FILE_BEGIN)) SetEndOfFile(file_);
+        }
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+        view_ = nullptr;
+        mapping_ = nullptr;
+        file_ = INVALID_HANDLE_VALUE;
+        capacity_ = 0;
+        ours_ = false;
+        count_ = 0;
+        lastStartMs_ = 0;
+        byGame_.clear();
+    }
+
+    void Store::Close() {
+        std::lock_guard lock(mutex_);
+        Unmap();
+    }
+
+    bool Store::IsOpen() const {
+        std::lock_guard lock(mutex_);
+        return view_ != nullptr;
+    }
+
+    const Record* Store::Records() const {
+        return reinterpret_cast<const Record*>(view_ + sizeof(Header));
+    }
+
+    // ------------------------------------------------------------
+    // Append
+    // ------------------------------------------------------------
+
+    bool Store::Append(Record r) {
+        std::lock_guard lock(mutex_);
+        if (!view_ || !writable_) return false;
+
+        const uint64_t need = sizeof(Header) + (uint64_t{ count_ } + 1) * sizeof(Record);
+        if (need > capacity_ && !Map(std::max(need, capacity_ * 2))) return false;
+
+        // Clock steps backwards must not unsort the log.
+        r.startMs = std::max({ r.startMs, lastStartMs_, uint64_t{ 1 } });
+        r.endMs = std::max(r.endMs, r.startMs);
+        r.game[sizeof(r.game) - 1] = '\0';
+        r.check = Checksum(r);
+
+        auto* slot = reinterpret_cast<Record*>(view_ + sizeof(Header)) + count_;
+        std::memcpy(slot, &r, sizeof(r));
+        FlushViewOfFile(slot, sizeof(r));
+        byGame_[GameOf(r)].push_back(count_);
+        lastStartMs_ = r.startMs;
+        ++count_;
+        return true;
+    }
+
+    // ------------------------------------------------------------
+    // Queries
+    // ------------------------------------------------------------
+
+    size_t Store::Size() const {
+        std::lock_guard lock(mutex_);
+        return count_;
+    }
+
+    std::vector<std::string> Store::Games() const {
+        std::lock_guard lock(mutex_);
+        std::vector<std::string> games;
+        for (const auto& [game, ids] : byGame_) games.push_back(game);
+        return games;
+    }
+
+    void Store::Range(const std::string& game, uint64_t sinceMs, uint64_t untilMs,
+        std::vector<uint32_t>& out) const
+    {
+        out.clear();
+        if (!view_) return;
+        const Record* records = Records();
+        auto byStart = [records](uint32_t id, uint64_t ms) { return records[id].startMs < ms; };
+        if (game.empty()) {
+            // All records, in order: search the record numbers implicitly.
+            uint32_t lo = 0, hi = count_;
+            while (lo < hi) {
+                const uint32_t mid = lo + (hi - lo) / 2;
+                if (byStart(mid, sinceMs)) lo = mid + 1; else hi = mid;
+            }
+            for (uint32_t i = lo; i < count_ && records[i].startMs < untilMs; ++i) out.push_back(i);
+            return;
+        }
+        const auto it = byGame_.find(game);
+        if (it == byGame_.end()) return;
+        const auto& ids = it->second;
+        auto first = std::lower_bound(ids.begin(), ids.end(), sinceMs, byStart);
+        auto last = std::lower_bound(first, ids.end(), untilMs, byStart);
+        out.assign(first, last);
+    }
+
+    std::vector<Record> Store::Select(const std::string& game, uint64_t sinceMs,
+        uint64_t untilMs) const
+    {
+        std::lock_guard lock(mutex_);
+        std::vector<uint32_t> ids;
+        Range(game, sinceMs, untilMs, ids);
+        std::vector<Record> out;
+        out.reserve(ids.size());
+        for (uint32_t id : ids) out.push_back(Records()[id]);
+        return out;
+    }
+
+    uint32_t Store::Percentile(const std::string& game, uint64_t sinceMs, double q,
+        uint32_t Record::* field, bool skipZero) const
+    {
+        std::lock_guard lock(mutex_);
+        std::vector<uint32_t> ids;
+        Range(game, sinceMs, UINT64_MAX, ids);
+        if (ids.empty()) return 0;
+        std::vector<uint32_t> values;
+        values.reserve(ids.size());
+        for (uint32_t id : ids) {
+            const uint32_t v = Records()[id].*field;
+            if (v || !skipZero) values.push_back(v);
+        }
+        if (values.empty()) return 0;
+        const double rank = std::ceil(std::clamp(q, 0.0, 1.0) * values.size());
+        const size_t k = rank < 1 ? 0 : static_cast<size_t>(rank) - 1;
+        std::nth_element(values.begin(), values.begin() + k, values.end());
+        return values[k];
+    }
+
+} // namespace History
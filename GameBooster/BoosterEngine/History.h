@@ -0,0 +1,111 @@
+﻿#pragma once
+
+#include <windows.h>
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// ============================================================
+// SESSION HISTORY
+// ============================================================
+//
+// Append-only log of Game Mode sessions, one fixed 128-byte record each,
+// memory-mapped for queries. Records are written and then checksummed in
+// place, so a torn append at the tail is simply not there on reopen.
+// Start times never go backwards, which keeps every per-game list sorted
+// and range queries a binary search.
+
+namespace History {
+
+    enum RecordFlags : uint8_t {
+        Forced     = 1,     // entered through ForceEnter
+        NumaPlaced = 2,
+    };
+
+    struct Record {
+        uint64_t startMs = 0;           // Unix epoch ms
+        uint64_t endMs = 0;
+        uint32_t enterUs = 0;           // activation latency
+        uint32_t exitUs = 0;            // restoration latency, settle excluded
+        uint32_t wakeP50Us = 0;         // latency probe, this session only
+        uint32_t wakeP99Us = 0;
+        uint32_t wakeP999Us = 0;
+        uint32_t wakeMaxUs = 0;
+        uint16_t killed = 0;
+        uint16_t relaunched = 0;
+        uint16_t steered = 0;           // processes moved off the game's cores
+        uint16_t raised = 0;            // game processes raised to HIGH
+        uint16_t failed = 0;            // boost actions that failed
+        uint8_t  flags = 0;
+        uint8_t  reserved0 = 0;
+        uint16_t gameCpuPermille = 0;   // mean share of machine capacity
+        uint16_t reserved1 = 0;
+        char     game[64] = {};         // lower-case exe
+        uint32_t peakWorkingSetMb = 0;  // all of the game's processes together
+        uint32_t check = 0;
+    };
+    static_assert(sizeof(Record) == 128, "record layout is on disk");
+
+    uint64_t NowMs();
+
+    class Store {
+    public:
+        Store() = default;
+        ~Store() { Close(); }
+
+        Store(const Store&) = delete;
+        Store& operator=(const Store&) = delete;
+
+        // Read-only stores may share the file with a live writer; they see
+        // the records present when opened.
+        bool Open(const std::string& path, bool writable);
+        void Close();
+        bool IsOpen() const;
+
+        bool Append(Record r);
+
+        size_t Size() const;
+        std::vector<std::string> Games() const;
+
+        // Sessions of `game` ("" for all) that started in [sinceMs, untilMs).
+        std::vector<Record> Select(const std::string& game, uint64_t sinceMs,
+            uint64_t untilMs = UINT64_MAX) const;
+
+        // Nearest-rank percentile of `field` over the same selection, 0 if empty.
+        // `skipZero` leaves out records that lack the field, e.g. ones
+        // written before it existed.
+        uint32_t Percentile(const std::string& game, uint64_t sinceMs, double q,
+            uint32_t Record::* field, bool skipZero = false) const;
+
+    private:
+        struct Header {
+            char     magic[8];
+            uint32_t version;
+            uint32_t recordSize;
+            uint8_t  reserved[48];
+        };
+        static_assert(sizeof(Header) == 64, "header layout is on disk");
+
+        bool Map(uint64_t bytes);
+        void Unmap();
+        const Record* Records() const;
+        // Record numbers of `game` starting in [sinceMs, untilMs).
+        void Range(const std::string& game, uint64_t sinceMs, uint64_t untilMs,
+            std::vector<uint32_t>& out) const;
+
+        mutable std::mutex mutex_;
+        HANDLE   file_ = INVALID_HANDLE_VALUE;
+        HANDLE   mapping_ = nullptr;
+        uint8_t* view_ = nullptr;
+        uint64_t capacity_ = 0;     // mapped bytes
+        bool     writable_ = false;
+        bool     ours_ = false;      // header checked; safe to truncate
+        uint32_t count_ = 0;
+        uint64_t lastStartMs_ = 0;
+        std::map<std::string, std::vector<uint32_t>> byGame_;
+    };
+
+} // namespace History
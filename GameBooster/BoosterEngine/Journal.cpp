@@ -0,0 +1,192 @@
+﻿#define NOMINMAX
+#include "Journal.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace Journal {
+
+    namespace {
+
+        constexpr char     Magic[8] = { 'G', 'B', 'J', 'R', 'N', 'L', '1', 0 };
+        constexpr uint32_t Version = 1;
+
+        enum Op : uint8_t { Add = 1, Replace, Remove };
+
+        struct Header {
+            char     magic[8];
+            uint32_t version;
+            uint32_t recordSize;
+            uint8_t  reserved[48];
+        };
+        static_assert(sizeof(Header) == 64, "header layout is on disk");
+
+        uint32_t Checksum(const Entry& e) {
+            // FNV-1a over everything but the check field.
+            const auto* p = reinterpret_cast<const uint8_t*>(&e);
+            uint32_t h = 2166136261u;
+            for (size_t i = 0; i < offsetof(Entry, check); ++i) {
+                h ^= p[i];
+                h *= 16777619u;
+            }
+            return h;
+        }
+
+        bool Valid(const Entry& e) {
+            return e.op >= Add && e.op <= Remove && e.check == Checksum(e);
+        }
+
+    } // namespace
+
+    Entry Entry::Make(Kind kind, const ProcessUtil::ProcessInfo& p, uint64_t value,
+        const std::string& path)
+    {
+        Entry e;
+        e.kind = static_cast<uint8_t>(kind);
+        e.pid = p.pid;
+        e.startTime = p.startTime;
+        e.value = value;
+        strncpy_s(e.exe, p.exe.c_str(), _TRUNCATE);
+        strncpy_s(e.path, path.c_str(), _TRUNCATE);
+        return e;
+    }
+
+    ProcessUtil::ProcessInfo Entry::Process() const {
+        ProcessUtil::ProcessInfo p;
+        p.pid = pid;
+        p.startTime = startTime;
+        p.exe.assign(exe, strnlen(exe, sizeof(exe)));
+        return p;
+    }
+
+    // ------------------------------------------------------------
+    // File
+    // ------------------------------------------------------------
+
+    bool Log::Open(const std::string& path) {
+        Close();
+        pending_.clear();
+        file_ = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+            nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER size{};
+        GetFileSizeEx(file_, &size);
+        if (size.QuadPart == 0) {
+            Header header{};
+            std::memcpy(header.magic, Magic, sizeof(Magic));
+            header.version = Version;
+            header.recordSize = sizeof(Entry);
+            DWORD wrote = 0;
+            if (!WriteFile(file_, &header, sizeof(header), &wrote, nullptr) || wrote != sizeof(header)) {
+                Close();
+                return false;
+            }
+            FlushFileBuffers(file_);
+            end_ = sizeof(header);
+            return true;
+        }
+
+        // A session's worth of records; read it whole.
+        std::vector<uint8_t> bytes(static_cast<size_t>(size.QuadPart));
+        DWORD got = 0;
+        const auto* header = reinterpret_cast<const Header*>(bytes.data());
+        if (bytes.size() < sizeof(Header)
+            || !ReadFile(file_, bytes.data(), static_cast<DWORD>(bytes.size()), &got, nullptr)
+            || got != bytes.size() || std::memcmp(header->magic, Magic, sizeof(Magic)) != 0
+            || header->recordSize != sizeof(Entry)) {
+            // Not ours; leave it untouched.
+            Close();
+            return false;
+        }
+
+        size_t offset = sizeof(Header);
+        for (; offset + sizeof(Entry) <= bytes.size(); offset += sizeof(Entry)) {
+            Entry e;
+            std::memcpy(&e, bytes.data() + offset, sizeof(e));
+            if (!Valid(e)) break;
+            Apply(e);
+        }
+        // New records go after the last good one.
+        LARGE_INTEGER end;
+        end.QuadPart = static_cast<LONGLONG>(offset);
+        SetFilePointerEx(file_, end, nullptr, FILE_BEGIN);
+        SetEndOfFile(file_);
+        end_ = end.QuadPart;
+        return true;
+    }
+
+    void Log::Close() {
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+        file_ = INVALID_HANDLE_VALUE;
+        dirty_ = false;
+    }
+
+    void Log::Sync() {
+        if (!dirty_) return;
+        FlushFileBuffers(file_);
+        dirty_ = false;
+    }
+
+    void Log::Clear() {
+        pending_.clear();
+        if (file_ == INVALID_HANDLE_VALUE) return;
+        LARGE_INTEGER end;
+        end.QuadPart = sizeof(Header);
+        SetFilePointerEx(file_, end, nullptr, FILE_BEGIN);
+        SetEndOfFile(file_);
+        end_ = end.QuadPart;
+        dirty_ = true;
+        Sync();
+    }
+
+    // ------------------------------------------------------------
+    // Entries
+    // ------------------------------------------------------------
+
+    void Log::Apply(const Entry& e) {
+        if (e.op == Add) {
+            pending_.push_back(e);
+            return;
+        }
+        const auto same = std::find_if(pending_.rbegin(), pending_.rend(),
+            [&](const Entry& p) { return p.Same(e); });
+        if (e.op == Replace) {
+            if (same != pending_.rend()) *same = e;
+            else pending_.push_back(e);
+        }
+        else if (same != pending_.rend()) {
+            pending_.erase(std::next(same).base());
+        }
+    }
+
+    bool Log::Append(Entry e, uint8_t op, bool applyAnyway) {
+        e.op = op;
+        e.check = Checksum(e);
+        bool written = true;
+        if (file_ != INVALID_HANDLE_VALUE) {
+            DWORD wrote = 0;
+            written = WriteFile(file_, &e, sizeof(e), &wrote, nullptr) && wrote == sizeof(e);
+            dirty_ = true;
+            if (written) {
+                end_ += sizeof(e);
+            }
+            else {
+                // Cut off any part that got out, so the next record lands
+                // where a reopen will look for it.
+                LARGE_INTEGER end;
+                end.QuadPart = end_;
+                SetFilePointerEx(file_, end, nullptr, FILE_BEGIN);
+                SetEndOfFile(file_);
+            }
+        }
+        if (written || applyAnyway) Apply(e);
+        return written;
+    }
+
+    bool Log::Record(const Entry& e) { return Append(e, Add); }
+    bool Log::Update(const Entry& e) { return Append(e, Replace); }
+    void Log::Drop(const Entry& e) { Append(e, Remove, true); }
+
+} // namespace Journal
@@ -0,0 +1,103 @@
+﻿#pragma once
+
+#include "ProcessUtil.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ============================================================
+// CHANGE JOURNAL
+// ============================================================
+//
+// Every change the booster makes to another process, with the value it
+// replaced, written to disk before the change is made. Exit undoes a
+// session from it in one pass; if the booster dies mid-session, the next
+// start finds the entries still pending and undoes them the same way.
+//
+// Each record reaches the OS in one write ahead of its change, so a crash
+// of the booster cannot lose it. Surviving a power cut as well takes a
+// flush, which is paid once per batch (Sync) rather than per record. A
+// torn record at the tail fails its checksum and is ignored on reopen.
+// A record that cannot be written is not taken: its change must not be
+// made either, since nothing would undo it after a crash.
+
+namespace Journal {
+
+    enum class Kind : uint8_t {
+        Priority = 1,   // value: the priority class replaced
+        Affinity,       // value: the affinity mask replaced
+        Relaunch,       // a killed process; path: how to start it again
+        IdleLimit,      // machine-wide; value: the PowerQos::IdleLimit replaced; path: its plan
+        Throttling,     // value: the PowerQos::Throttling replaced
+    };
+
+    struct Entry {
+        uint8_t  kind = 0;
+        uint8_t  op = 0;                // set by Log
+        uint16_t reserved0 = 0;
+        uint32_t pid = 0;
+        uint64_t startTime = 0;         // FILETIME ticks; with pid, the instance
+        uint64_t value = 0;
+        char     exe[64] = {};
+        char     path[420] = {};
+        uint32_t check = 0;
+
+        static Entry Make(Kind kind, const ProcessUtil::ProcessInfo& p, uint64_t value,
+            const std::string& path = {});
+
+        Kind Type() const { return static_cast<Kind>(kind); }
+        ProcessUtil::ProcessInfo Process() const;
+        // Same kind of change to the same process instance.
+        bool Same(const Entry& o) const {
+            return kind == o.kind && pid == o.pid && startTime == o.startTime;
+        }
+    };
+    static_assert(sizeof(Entry) == 512, "record layout is on disk");
+
+    // Works in memory alone until opened, e.g. when no file is configured.
+    class Log {
+    public:
+        Log() = default;
+        ~Log() { Close(); }
+
+        Log(const Log&) = delete;
+        Log& operator=(const Log&) = delete;
+
+        // Opens or creates the file and loads what an earlier run left
+        // pending. Call before recording anything.
+        bool Open(const std::string& path);
+        void Close();
+        bool IsOpen() const { return file_ != INVALID_HANDLE_VALUE; }
+
+        // The change in `e` is about to be made. False if it could not be
+        // written; make no change then.
+        bool Record(const Entry& e);
+        // Replaces the pending entry for the same change, e.g. once a
+        // relaunch path is known. False, keeping the old entry, if it could
+        // not be written.
+        bool Update(const Entry& e);
+        // The change in `e` has been undone, or was never made. Forgotten
+        // in memory even if the file keeps it: a replay only repeats the undo.
+        void Drop(const Entry& e);
+        // Makes everything written so far durable; free when nothing was.
+        void Sync();
+        // Forgets every entry, in memory and on disk.
+        void Clear();
+
+        // Changes still in force, oldest first.
+        const std::vector<Entry>& Pending() const { return pending_; }
+
+    private:
+        // Writes `e` as operation `op` and, unless that failed with the
+        // file open, applies it to Pending().
+        bool Append(Entry e, uint8_t op, bool applyAnyway = false);
+        void Apply(const Entry& e);
+
+        HANDLE  file_ = INVALID_HANDLE_VALUE;
+        int64_t end_ = 0;               // just past the last whole record
+        bool    dirty_ = false;         // written since the last flush
+        std::vector<Entry> pending_;
+    };
+
+} // namespace Journal
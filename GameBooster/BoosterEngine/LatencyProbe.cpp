@@ -0,0 +1,166 @@
+﻿#define NOMINMAX
+#include "LatencyProbe.h"
+
+#include "Trace.h"
+
+#include <algorithm>
+#include <chrono>
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+namespace LatencyProbe {
+
+    // ------------------------------------------------------------
+    // Histogram
+    // ------------------------------------------------------------
+
+    size_t Histogram::Index(uint64_t us) {
+        if (us < 16) return static_cast<size_t>(us);
+        us = std::min<uint64_t>(us, (1ull << 31) - 1);
+        int msb = 4;
+        while ((us >> (msb + 1)) != 0) ++msb;
+        const size_t sub = (us >> (msb - 3)) & 7;
+        return 16 + static_cast<size_t>(msb - 4) * 8 + sub;
+    }
+
+    uint64_t Histogram::UpperBound(size_t index) {
+        if (index < 16) return index;
+        const size_t octave = (index - 16) / 8, sub = (index - 16) % 8;
+        const int shift = static_cast<int>(octave) + 1;
+        return ((8 + sub) << shift) + (1ull << shift) - 1;
+    }
+
+    void Histogram::Record(uint64_t us) {
+        buckets_[Index(us)].fetch_add(1, std::memory_order_relaxed);
+        uint64_t seen = max_.load(std::memory_order_relaxed);
+        while (us > seen && !max_.compare_exchange_weak(seen, us, std::memory_order_relaxed)) {}
+    }
+
+    void Histogram::Reset() {
+        for (auto& b : buckets_) b.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    Booster::WakeLatency Histogram::Summary() const {
+        std::array<uint64_t, Buckets> counts;
+        Booster::WakeLatency s;
+        for (size_t i = 0; i < Buckets; ++i) {
+            counts[i] = buckets_[i].load(std::memory_order_relaxed);
+            s.samples += counts[i];
+        }
+        if (!s.samples) return s;
+        s.maxUs = static_cast<uint32_t>(std::min<uint64_t>(max_.load(std::memory_order_relaxed), UINT32_MAX));
+
+        auto quantile = [&](double q) {
+            const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * s.samples + 0.999999));
+            uint64_t seen = 0;
+            for (size_t i = 0; i < Buckets; ++i) {
+                seen += counts[i];
+                if (seen >= rank)
+                    return static_cast<uint32_t>(std::min<uint64_t>(UpperBound(i), s.maxUs));
+            }
+            return s.maxUs;
+            };
+        s.p50Us = quantile(0.5);
+        s.p99Us = quantile(0.99);
+        s.p999Us = quantile(0.999);
+        return s;
+    }
+
+    // ------------------------------------------------------------
+    // Priority mapping
+    // ------------------------------------------------------------
+
+    namespace {
+
+        int ClassBase(DWORD priorityClass) {
+            switch (priorityClass) {
+            case IDLE_PRIORITY_CLASS:         return 4;
+            case BELOW_NORMAL_PRIORITY_CLASS: return 6;
+            case ABOVE_NORMAL_PRIORITY_CLASS: return 10;
+            case HIGH_PRIORITY_CLASS:         return 13;
+            case REALTIME_PRIORITY_CLASS:     return 24;
+            default:                          return 8;
+            }
+        }
+
+    } // namespace
+
+    int ThreadPriorityFor(DWORD priorityClass, DWORD ownClass) {
+        const int delta = ClassBase(priorityClass) - ClassBase(ownClass);
+        return std::clamp(delta, THREAD_PRIORITY_LOWEST, THREAD_PRIORITY_HIGHEST);
+    }
+
+    // ------------------------------------------------------------
+    // Probe
+    // ------------------------------------------------------------
+
+    void Probe::Start() {
+        if (running_ || opts_.threads == 0) return;
+        running_ = true;
+        for (uint32_t i = 0; i < opts_.threads; ++i)
+            threads_.emplace_back([this] { Worker(); });
+    }
+
+    void Probe::Stop() {
+        running_ = false;
+        for (auto& t : threads_) t.join();
+        threads_.clear();
+    }
+
+    void Probe::Configure(Mode mode, DWORD_PTR affinity, DWORD priorityClass) {
+        {
+            std::lock_guard lock(setupMutex_);
+            setup_ = Setup{ mode, affinity, priorityClass };
+        }
+        if (mode == Mode::Boosted) session_.Reset();
+        generation_.fetch_add(1, std::memory_order_release);
+    }
+
+    void Probe::Worker() {
+        Trace::NameThread("latency probe");
+        HANDLE timer = CreateWaitableTimerExW(nullptr, nullptr,
+            CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        // Before Windows 10 1803 only the coarse timer exists; its lateness
+        // is still worth knowing.
+        if (!timer) timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+        if (!timer) return;
+
+        const DWORD ownClass = GetPriorityClass(GetCurrentProcess());
+        const auto period = std::chrono::microseconds(opts_.periodUs);
+        uint32_t applied = ~0u;
+        Setup setup;
+        while (running_) {
+            const uint32_t gen = generation_.load(std::memory_order_acquire);
+            if (gen != applied) {
+                {
+                    std::lock_guard lock(setupMutex_);
+                    setup = setup_;
+                }
+                DWORD_PTR processMask = 0, systemMask = 0;
+                GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask);
+                const DWORD_PTR mask = setup.affinity & processMask;
+                SetThreadAffinityMask(GetCurrentThread(), mask ? mask : processMask);
+                SetThreadPriority(GetCurrentThread(), ThreadPriorityFor(setup.priorityClass, ownClass));
+                applied = gen;
+            }
+
+            LARGE_INTEGER due;
+            due.QuadPart = -10ll * opts_.periodUs;
+            const auto t0 = std::chrono::steady_clock::now();
+            if (!SetWaitableTimer(timer, &due, 0, nullptr, nullptr, FALSE)) break;
+            WaitForSingleObject(timer, INFINITE);
+            const auto late = std::chrono::steady_clock::now() - t0 - period;
+
+            if (generation_.load(std::memory_order_acquire) != applied) continue;
+            const auto us = std::chrono::duration_cast<std::chrono::microseconds>(late).count();
+            const uint64_t lateUs = us > 0 ? static_cast<uint64_t>(us) : 0;
+            hist_[static_cast<size_t>(setup.mode)].Record(lateUs);
+            if (setup.mode == Mode::Boosted) session_.Record(lateUs);
+        }
+        CloseHandle(timer);
+    }
+
+} // namespace LatencyProbe
@@ -0,0 +1,96 @@
+﻿#pragma once
+
+#include "Control.h"
+
+#include <windows.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ============================================================
+// SCHEDULING-LATENCY PROBE
+// ============================================================
+//
+// cyclictest for the boosted game: probe threads sleep on high-resolution
+// timers with the game's affinity and (as near as an in-process thread can
+// get) its priority, and record how late they wake. Idle and boosted
+// samples are kept apart, so the two can be compared for a given
+// steering / priority / power-plan configuration.
+
+namespace LatencyProbe {
+
+    struct Options {
+        uint32_t threads = 0;       // 0 disables the probe
+        uint32_t periodUs = 1000;
+    };
+
+    enum class Mode : uint8_t { Idle, Boosted, Count };
+
+    // Log-linear microsecond buckets: exact below 16 us, then 8 per octave
+    // (<= 12.5% error) up to ~17 minutes.
+    class Histogram {
+    public:
+        void Record(uint64_t us);
+        void Reset();
+        Booster::WakeLatency Summary() const;
+
+    private:
+        static constexpr size_t Buckets = 16 + 27 * 8;
+        static size_t   Index(uint64_t us);
+        static uint64_t UpperBound(size_t index);
+
+        std::array<std::atomic<uint64_t>, Buckets> buckets_{};
+        std::atomic<uint64_t> max_{ 0 };
+    };
+
+    // Thread priority giving the closest base priority to a process of
+    // `priorityClass`, from inside a process of `ownClass`. Thread levels
+    // only reach +-2 (short of TIME_CRITICAL), so HIGH_PRIORITY_CLASS from a
+    // normal process ends up at base 10 rather than 13.
+    int ThreadPriorityFor(DWORD priorityClass, DWORD ownClass);
+
+    class Probe {
+    public:
+        explicit Probe(Options opts = {}) : opts_(opts) {}
+        ~Probe() { Stop(); }
+
+        Probe(const Probe&) = delete;
+        Probe& operator=(const Probe&) = delete;
+
+        void Start();
+        void Stop();
+
+        // Threads adopt the new setup at their next wakeup; the sample
+        // that straddles the change is dropped. `affinity` 0 = any CPU.
+        void Configure(Mode mode, DWORD_PTR affinity, DWORD priorityClass);
+
+        Booster::WakeLatency Summary(Mode mode) const {
+            return hist_[static_cast<size_t>(mode)].Summary();
+        }
+        // Boosted samples since the last switch to Mode::Boosted.
+        Booster::WakeLatency SessionSummary() const { return session_.Summary(); }
+
+    private:
+        struct Setup {
+            Mode      mode = Mode::Idle;
+            DWORD_PTR affinity = 0;
+            DWORD     priorityClass = NORMAL_PRIORITY_CLASS;
+        };
+
+        void Worker();
+
+        const Options opts_;
+        std::atomic<bool>     running_{ false };
+        std::atomic<uint32_t> generation_{ 0 };
+        std::mutex            setupMutex_;
+        Setup                 setup_;
+        Histogram             hist_[static_cast<size_t>(Mode::Count)];
+        Histogram             session_;
+        std::vector<std::thread> threads_;
+    };
+
+} // namespace LatencyProbe
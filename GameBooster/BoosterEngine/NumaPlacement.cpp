@@ -0,0 +1,277 @@
+﻿#define NOMINMAX
+
+#include "NumaPlacement.h"
+#include "ProcessScan.h"
+
+#include <psapi.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+
+namespace Numa {
+
+    namespace {
+
+        int CountBits(DWORD_PTR mask) {
+            int n = 0;
+            for (; mask; mask &= mask - 1) ++n;
+            return n;
+        }
+
+        DWORD_PTR SystemMask() {
+            DWORD_PTR procMask = 0, sysMask = 0;
+            GetProcessAffinityMask(GetCurrentProcess(), &procMask, &sysMask);
+            return sysMask;
+        }
+
+        std::vector<ULONG> CpuSetIds(WORD group, DWORD_PTR cores) {
+            std::vector<ULONG> ids;
+            ULONG len = 0;
+            GetSystemCpuSetInformation(nullptr, 0, &len, GetCurrentProcess(), 0);
+            if (!len) return ids;
+            std::vector<BYTE> buf(len);
+            auto* base = reinterpret_cast<PSYSTEM_CPU_SET_INFORMATION>(buf.data());
+            if (!GetSystemCpuSetInformation(base, len, &len, GetCurrentProcess(), 0))
+                return ids;
+            for (ULONG off = 0; off < len;) {
+                const auto* info = reinterpret_cast<const SYSTEM_CPU_SET_INFORMATION*>(
+                    buf.data() + off);
+                if (info->Type == CpuSetInformation
+                    && info->CpuSet.Group == group
+                    && ((cores >> info->CpuSet.LogicalProcessorIndex) & 1))
+                    ids.push_back(info->CpuSet.Id);
+                off += info->Size;
+            }
+            return ids;
+        }
+
+        std::vector<BYTE> CoreIndices(DWORD_PTR cores) {
+            std::vector<BYTE> idx;
+            for (BYTE bit = 0; bit < sizeof(DWORD_PTR) * 8; ++bit)
+                if ((cores >> bit) & 1) idx.push_back(bit);
+            return idx;
+        }
+
+    } // namespace
+
+    // ------------------------------------------------------------
+    // Topology
+    // ------------------------------------------------------------
+
+    Topology Topology::Query() {
+        Topology t;
+        ULONG highest = 0;
+        if (!GetNumaHighestNodeNumber(&highest)) return t;
+        for (ULONG id = 0; id <= highest; ++id) {
+            GROUP_AFFINITY ga{};
+            if (!GetNumaNodeProcessorMaskEx(static_cast<USHORT>(id), &ga) || !ga.Mask)
+                continue;
+            Node n;
+            n.id = static_cast<USHORT>(id);
+            n.group = ga.Group;
+            n.mask = ga.Mask;
+            GetNumaAvailableMemoryNodeEx(n.id, &n.freeBytes);
+            t.nodes.push_back(n);
+        }
+        return t;
+    }
+
+    Topology Topology::Synthetic(DWORD_PTR processors, int count) {
+        Topology t;
+        t.synthetic = true;
+        const std::vector<BYTE> cores = CoreIndices(processors);
+        if (count < 1 || cores.size() < static_cast<size_t>(count)) return t;
+
+        MEMORYSTATUSEX ms{ sizeof(ms) };
+        GlobalMemoryStatusEx(&ms);
+
+        const size_t per = cores.size() / count;
+        for (int i = 0; i < count; ++i) {
+            Node n;
+            n.id = static_cast<USHORT>(i);
+            n.freeBytes = ms.ullAvailPhys / count;
+            const size_t end = (i == count - 1) ? cores.size() : (i + 1) * per;
+            for (size_t c = i * per; c < end; ++c)
+                n.mask |= static_cast<DWORD_PTR>(1) << cores[c];
+            t.nodes.push_back(n);
+        }
+        return t;
+    }
+
+    const Node* Topology::Pick(DWORD_PTR cores) const {
+        const Node* best = nullptr;
+        int bestOverlap = 0;
+        for (const auto& n : nodes) {
+            const int overlap = CountBits(n.mask & cores);
+            if (overlap > bestOverlap) { best = &n; bestOverlap = overlap; }
+        }
+        if (best) return best;
+        for (const auto& n : nodes)
+            if (!best || n.freeBytes > best->freeBytes) best = &n;
+        return best;
+    }
+
+    // ------------------------------------------------------------
+    // Usage report
+    // ------------------------------------------------------------
+
+    UsageReport MeasureUsage(HANDLE proc, const Options& opts) {
+        SYSTEM_INFO si;
+        GetSystemInfo(&si);
+
+        // PSAPI_WORKING_SET_INFORMATION is a count followed by one block per
+        // page; ULONG_PTR storage keeps it correctly aligned.
+        std::vector<ULONG_PTR> ws(1 + 4096);
+        for (int attempt = 0; attempt < 4; ++attempt) {
+            const DWORD bytes = static_cast<DWORD>(ws.size() * sizeof(ULONG_PTR));
+            if (QueryWorkingSet(proc, ws.data(), bytes)) break;
+            if (GetLastError() != ERROR_BAD_LENGTH) return {};
+            ws.resize(1 + ws[0] + ws[0] / 8 + 256);
+        }
+        const auto* info = reinterpret_cast<const PSAPI_WORKING_SET_INFORMATION*>(ws.data());
+        const size_t entries = std::min<size_t>(info->NumberOfEntries, ws.size() - 1);
+        if (!entries) return {};
+
+        const size_t samples = std::max<size_t>(opts.maxSampledPages, 1);
+        const size_t stride = (entries + samples - 1) / samples;
+        std::map<USHORT, ULONGLONG> pages;
+        std::vector<PSAPI_WORKING_SET_EX_INFORMATION> batch;
+        batch.reserve(opts.batchPages);
+
+        auto flush = [&] {
+            if (batch.empty()) return;
+            const DWORD bytes = static_cast<DWORD>(batch.size() * sizeof(batch[0]));
+            if (QueryWorkingSetEx(proc, batch.data(), bytes))
+                for (const auto& e : batch)
+                    if (e.VirtualAttributes.Valid)
+                        ++pages[static_cast<USHORT>(e.VirtualAttributes.Node)];
+            batch.clear();
+            };
+
+        for (size_t i = 0; i < entries; i += stride) {
+            PSAPI_WORKING_SET_EX_INFORMATION e{};
+            e.VirtualAddress = reinterpret_cast<PVOID>(
+                info->WorkingSetInfo[i].Flags & ~static_cast<ULONG_PTR>(0xFFF));
+            batch.push_back(e);
+            if (batch.size() >= opts.batchPages) flush();
+        }
+        flush();
+
+        UsageReport report;
+        for (const auto& [node, count] : pages)
+            report.push_back({ node, count * stride * si.dwPageSize });
+        return report;
+    }
+
+    std::string Describe(const UsageReport& report) {
+        if (report.empty()) return "n/a";
+        std::string out;
+        char buf[64];
+        for (const auto& u : report) {
+            snprintf(buf, sizeof(buf), "%snode %u: %.1f MB",
+                out.empty() ? "" : ", ", u.node, u.bytes / (1024.0 * 1024.0));
+            out += buf;
+        }
+        return out;
+    }
+
+    // ------------------------------------------------------------
+    // Placement
+    // ------------------------------------------------------------
+
+    Placement::Placement(Options opts) : opts_(opts) {}
+
+    bool Placement::Apply(const std::string& gameExe, DWORD_PTR gameCores) {
+        if (Active()) return true;
+        before_.clear();
+        after_.clear();
+
+        const Topology topo = opts_.syntheticNodes > 1
+            ? Topology::Synthetic(SystemMask(), opts_.syntheticNodes)
+            : Topology::Query();
+        if (topo.nodes.size() < 2) return false;
+
+        const Node* node = topo.Pick(gameCores);
+        if (!node) return false;
+        DWORD_PTR cores = node->mask & gameCores;
+        if (!cores) cores = node->mask;
+
+        constexpr DWORD access = PROCESS_QUERY_INFORMATION | PROCESS_VM_READ
+            | PROCESS_SET_LIMITED_INFORMATION;
+        ProcessScan::Snapshot& scan = ProcessScan::ThisThread();
+        if (!scan.Take()) return false;
+        for (const auto& p : scan.Processes()) {
+            if (!p.startTime || !p.NameIs(gameExe)) continue;
+            ProcessEntry entry;
+            entry.proc = { p.pid, p.startTime, p.Name() };
+            HANDLE h = ProcessUtil::OpenVerified(entry.proc, access);
+            if (!h) continue;
+            if (journal_.empty()) before_ = MeasureUsage(h, opts_);
+            Place(entry, h, p, node->group, cores);
+            CloseHandle(h);
+            journal_.push_back(std::move(entry));
+        }
+        if (journal_.empty()) return false;
+        node_ = node->id;
+        return true;
+    }
+
+    void Placement::Place(ProcessEntry& entry, HANDLE h, const ProcessScan::Process& p,
+        WORD group, DWORD_PTR cores) {
+        ULONG required = 0;
+        if (!GetProcessDefaultCpuSets(h, nullptr, 0, &required) && required) {
+            entry.previousCpuSets.resize(required);
+            if (!GetProcessDefaultCpuSets(h, entry.previousCpuSets.data(),
+                required, &required))
+                entry.previousCpuSets.clear();
+        }
+
+        const std::vector<ULONG> ids = CpuSetIds(group, cores);
+        if (!ids.empty())
+            SetProcessDefaultCpuSets(h, ids.data(), static_cast<ULONG>(ids.size()));
+
+        // Page placement follows the ideal processor of the faulting thread.
+        const std::vector<BYTE> idx = CoreIndices(cores);
+        if (idx.empty()) return;
+        size_t next = 0;
+        for (uint32_t i = 0; i < p.threadCount; ++i) {
+            const auto tid = static_cast<DWORD>(p.threads[i].threadId);
+            HANDLE th = OpenThread(THREAD_SET_INFORMATION | THREAD_QUERY_INFORMATION,
+                FALSE, tid);
+            if (!th) continue;
+            PROCESSOR_NUMBER ideal{ group, idx[next++ % idx.size()], 0 };
+            ThreadEntry t;
+            t.tid = tid;
+            if (SetThreadIdealProcessorEx(th, &ideal, &t.previous))
+                entry.threads.push_back(t);
+            CloseHandle(th);
+        }
+    }
+
+    void Placement::Restore() {
+        constexpr DWORD access = PROCESS_QUERY_INFORMATION | PROCESS_VM_READ
+            | PROCESS_SET_LIMITED_INFORMATION;
+        for (auto& entry : journal_) {
+            HANDLE h = ProcessUtil::OpenVerified(entry.proc, access);
+            if (!h) continue;
+            if (after_.empty()) after_ = MeasureUsage(h, opts_);
+            SetProcessDefaultCpuSets(h,
+                entry.previousCpuSets.empty() ? nullptr : entry.previousCpuSets.data(),
+                static_cast<ULONG>(entry.previousCpuSets.size()));
+            CloseHandle(h);
+
+            for (auto& t : entry.threads) {
+                HANDLE th = OpenThread(THREAD_SET_INFORMATION | THREAD_QUERY_INFORMATION,
+                    FALSE, t.tid);
+                if (!th) continue;
+                if (GetProcessIdOfThread(th) == entry.proc.pid)
+                    SetThreadIdealProcessorEx(th, &t.previous, nullptr);
+                CloseHandle(th);
+            }
+        }
+        journal_.clear();
+        node_ = -1;
+    }
+
+} // namespace Numa
@@ -0,0 +1,96 @@
+﻿#pragma once
+
+#include "ProcessScan.h"
+#include "ProcessUtil.h"
+
+#include <string>
+#include <vector>
+
+// ============================================================
+// NUMA PLACEMENT
+// ============================================================
+//
+// Keeps the game's memory on the node that owns its cores. Windows places
+// new pages on the node of the faulting thread's ideal processor, so the
+// policy is expressed as default CPU sets for the process plus an ideal
+// processor per thread, all inside the chosen node.
+
+namespace Numa {
+
+    struct Node {
+        USHORT    id = 0;
+        WORD      group = 0;
+        DWORD_PTR mask = 0;
+        ULONGLONG freeBytes = 0;
+    };
+
+    struct Topology {
+        std::vector<Node> nodes;
+        bool synthetic = false;
+
+        static Topology Query();
+
+        // Splits `processors` into `count` equal nodes so placement can be
+        // exercised on single-node machines.
+        static Topology Synthetic(DWORD_PTR processors, int count);
+
+        // Node owning most of `cores`; falls back to the node with the most
+        // free memory when `cores` is empty.
+        const Node* Pick(DWORD_PTR cores) const;
+    };
+
+    struct NodeUsage {
+        USHORT    node = 0;
+        ULONGLONG bytes = 0;
+    };
+    using UsageReport = std::vector<NodeUsage>;
+
+    struct Options {
+        int    syntheticNodes = 0;      // > 1 forces a fake topology
+        size_t maxSampledPages = 1 << 16;
+        size_t batchPages = 4096;
+    };
+
+    // Resident bytes of `proc` per node. Large working sets are sampled
+    // with a fixed stride and scaled, so the cost stays bounded.
+    UsageReport MeasureUsage(HANDLE proc, const Options& opts);
+
+    std::string Describe(const UsageReport& report);
+
+    class Placement {
+    public:
+        explicit Placement(Options opts = {});
+
+        Placement(const Placement&) = delete;
+        Placement& operator=(const Placement&) = delete;
+
+        bool Apply(const std::string& gameExe, DWORD_PTR gameCores);
+        void Restore();
+
+        bool Active() const { return node_ >= 0; }
+        int  NodeId() const { return node_; }
+        const UsageReport& Before() const { return before_; }
+        const UsageReport& After() const { return after_; }
+
+    private:
+        struct ThreadEntry {
+            DWORD            tid = 0;
+            PROCESSOR_NUMBER previous{};
+        };
+        struct ProcessEntry {
+            ProcessUtil::ProcessInfo proc;
+            std::vector<ULONG>       previousCpuSets;
+            std::vector<ThreadEntry> threads;
+        };
+
+        // `p` is the scanned table entry for `entry`, listing its threads.
+        void Place(ProcessEntry& entry, HANDLE h, const ProcessScan::Process& p,
+            WORD group, DWORD_PTR cores);
+
+        Options opts_;
+        int     node_ = -1;
+        std::vector<ProcessEntry> journal_;
+        UsageReport before_, after_;
+    };
+
+} // namespace Numa
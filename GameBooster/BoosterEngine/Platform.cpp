@@ -0,0 +1,374 @@
+﻿#define NOMINMAX
+
+#include "Platform.h"
+#include "ProcessScan.h"
+
+#include <shellapi.h>
+#include <psapi.h>
+#include <powrprof.h>
+#include <winternl.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+
+#pragma comment(lib, "ntdll.lib")
+#pragma comment(lib, "powrprof.lib")
+
+extern "C" NTSTATUS NTAPI NtSetSystemInformation(ULONG infoClass, PVOID info, ULONG length);
+
+namespace Booster {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        // SystemMemoryListInformation: page counts per list, both to read
+        // and, as a command, to purge.
+        constexpr ULONG MemoryListInformation = 80;
+        enum MemoryListCommand : int {
+            MemoryPurgeStandbyList = 4,
+            MemoryPurgeLowPriorityStandbyList = 5,
+        };
+
+        // Processor power management / processor idle state maximum. Hidden
+        // in the power options UI, but read and written like any setting.
+        constexpr GUID ProcessorSubgroup =
+            { 0x54533251, 0x82be, 0x4824, { 0x96, 0xc1, 0x47, 0xb6, 0x0b, 0x74, 0x0d, 0x00 } };
+        constexpr GUID IdleStateMaximum =
+            { 0x9943e905, 0x9a30, 0x4ec1, { 0x9b, 0x99, 0x44, 0xdd, 0x3b, 0x76, 0xf7, 0xa2 } };
+
+        std::string FormatGuid(const GUID& g) {
+            char text[40];
+            snprintf(text, sizeof(text), "{%08lX-%04X-%04X-%02X%02X-%02X%02X%02X%02X%02X%02X}",
+                g.Data1, g.Data2, g.Data3, g.Data4[0], g.Data4[1], g.Data4[2], g.Data4[3],
+                g.Data4[4], g.Data4[5], g.Data4[6], g.Data4[7]);
+            return text;
+        }
+
+        bool ParseGuid(const std::string& text, GUID& g) {
+            unsigned long d1 = 0;
+            unsigned d2 = 0, d3 = 0, d4[8] = {};
+            if (sscanf_s(text.c_str(), "{%8lx-%4x-%4x-%2x%2x-%2x%2x%2x%2x%2x%2x}", &d1, &d2, &d3,
+                &d4[0], &d4[1], &d4[2], &d4[3], &d4[4], &d4[5], &d4[6], &d4[7]) != 11)
+                return false;
+            g.Data1 = d1;
+            g.Data2 = static_cast<unsigned short>(d2);
+            g.Data3 = static_cast<unsigned short>(d3);
+            for (int i = 0; i < 8; ++i) g.Data4[i] = static_cast<unsigned char>(d4[i]);
+            return true;
+        }
+
+        struct MemoryListCounts {
+            ULONG_PTR zeroPageCount;
+            ULONG_PTR freePageCount;
+            ULONG_PTR modifiedPageCount;
+            ULONG_PTR modifiedNoWritePageCount;
+            ULONG_PTR badPageCount;
+            ULONG_PTR pageCountByPriority[8];   // standby, by page priority
+            ULONG_PTR repurposedPagesByPriority[8];
+            ULONG_PTR modifiedPageCountPageFile;
+        };
+
+        std::string Lower(std::string s) {
+            std::transform(s.begin(), s.end(), s.begin(),
+                [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return s;
+        }
+
+        bool CoversMonitor(HWND wnd) {
+            RECT rc;
+            MONITORINFO mi{ sizeof(mi) };
+            if (!GetWindowRect(wnd, &rc)
+                || !GetMonitorInfoA(MonitorFromWindow(wnd, MONITOR_DEFAULTTONEAREST), &mi))
+                return false;
+            return rc.left <= mi.rcMonitor.left && rc.top <= mi.rcMonitor.top
+                && rc.right >= mi.rcMonitor.right && rc.bottom >= mi.rcMonitor.bottom;
+        }
+
+        // Thread count, shell children and per-thread CPU since the last pass.
+        // The process table carries thread CPU times, so no thread is opened.
+        void SampleThreads(DWORD pid, Detect::SampleCache& cache, Clock::time_point now) {
+            Detect::Sample& s = cache.last;
+            ProcessScan::Snapshot& scan = ProcessScan::ThisThread();
+            if (!scan.Take()) return;
+
+            s.childShell = false;
+            const ProcessScan::Process* self = nullptr;
+            for (const auto& p : scan.Processes()) {
+                if (p.pid == pid) {
+                    self = &p;
+                } else if (p.parentPid == pid) {
+                    if (p.NameIs("cmd.exe") || p.NameIs("powershell.exe") || p.NameIs("pwsh.exe")
+                        || p.NameIs("conhost.exe"))
+                        s.childShell = true;
+                }
+            }
+
+            const bool first = cache.deepAt == Clock::time_point{};
+            const double window = std::chrono::duration<double>(now - cache.deepAt).count() * 1e7;
+            std::map<uint32_t, uint64_t> threadCpu;
+            uint32_t hot = 0;
+            if (self) {
+                s.threads = self->threadCount;
+                for (uint32_t i = 0; i < self->threadCount; ++i) {
+                    const ProcessScan::RawThread& t = self->threads[i];
+                    const auto tid = static_cast<uint32_t>(t.threadId);
+                    const auto cpu = static_cast<uint64_t>(t.kernelTime + t.userTime);
+                    threadCpu[tid] = cpu;
+                    const auto prev = cache.threadCpu.find(tid);
+                    if (!first && prev != cache.threadCpu.end() && cpu - prev->second > window / 2)
+                        ++hot;
+                }
+            }
+            if (!first) s.hotThreads = hot;
+            cache.threadCpu = std::move(threadCpu);
+            cache.deepAt = now;
+        }
+
+        void SampleModules(HANDLE proc, Detect::Sample& s) {
+            HMODULE mods[1024];
+            DWORD needed = 0;
+            if (!EnumProcessModulesEx(proc, mods, sizeof(mods), &needed, LIST_MODULES_ALL)) return;
+            const DWORD n = std::min<DWORD>(needed / sizeof(HMODULE), 1024);
+            char name[MAX_PATH];
+            for (DWORD i = 0; i < n; ++i)
+                if (GetModuleBaseNameA(proc, mods[i], name, MAX_PATH))
+                    Detect::ClassifyModule(Lower(name), s);
+        }
+
+    } // namespace
+
+    Win32Platform& Win32Platform::Instance() {
+        static Win32Platform platform;
+        return platform;
+    }
+
+    void Win32Platform::Prepare() {
+        ProcessUtil::EnableDebugPrivilege();
+        // Purging the standby list; without it headroom only trims.
+        ProcessUtil::EnablePrivilege(SE_PROF_SINGLE_PROCESS_NAME);
+        // Opens the idle-state counters, so the first session has a baseline.
+        PowerQos::Residency unused;
+        residency_.Read(unused);
+    }
+
+    std::string Win32Platform::ForegroundProcess() {
+        return ProcessUtil::GetForegroundProcessName();
+    }
+
+    bool Win32Platform::Terminate(const ProcessInfo& p, std::string& imagePath,
+        uint32_t& error)
+    {
+        HANDLE proc = ProcessUtil::OpenVerified(p, PROCESS_TERMINATE | PROCESS_VM_READ);
+        if (!proc) {
+            error = GetLastError();
+            return false;
+        }
+        char path[MAX_PATH]{};
+        imagePath = GetModuleFileNameExA(proc, nullptr, path, MAX_PATH) ? path : p.exe;
+        const bool ok = TerminateProcess(proc, 0) != FALSE;
+        error = ok ? 0 : GetLastError();
+        CloseHandle(proc);
+        return ok;
+    }
+
+    bool Win32Platform::GetPriority(const ProcessInfo& p, DWORD& priorityClass) {
+        HANDLE h = ProcessUtil::OpenVerified(p, 0);
+        if (!h) return false;
+        priorityClass = GetPriorityClass(h);
+        CloseHandle(h);
+        return priorityClass != 0;
+    }
+
+    bool Win32Platform::SetPriority(const ProcessInfo& p, DWORD priorityClass) {
+        HANDLE h = ProcessUtil::OpenVerified(p, PROCESS_SET_INFORMATION);
+        if (!h) return false;
+        const bool ok = SetPriorityClass(h, priorityClass) != FALSE;
+        CloseHandle(h);
+        return ok;
+    }
+
+    bool Win32Platform::Launch(const std::string& command, uint32_t& error) {
+        const HINSTANCE r = ShellExecuteA(nullptr, "open", command.c_str(), nullptr, nullptr,
+            SW_SHOWDEFAULT);
+        const bool ok = reinterpret_cast<INT_PTR>(r) > 32;
+        error = ok ? 0 : GetLastError();
+        return ok;
+    }
+
+    ULONGLONG Win32Platform::CpuTime(const ProcessInfo& p) {
+        HANDLE h = ProcessUtil::OpenVerified(p, 0);
+        if (!h) return 0;
+        const ULONGLONG cpu = ProcessUtil::CpuTimeOf(h);
+        CloseHandle(h);
+        return cpu;
+    }
+
+    void Win32Platform::Sleep(DWORD ms) {
+        ::Sleep(ms);
+    }
+
+    SystemState Win32Platform::QuerySystem() {
+        SystemState s;
+        SYSTEM_POWER_STATUS power;
+        if (GetSystemPowerStatus(&power)) {
+            s.acPower = power.ACLineStatus != 0;
+            if (power.BatteryLifePercent <= 100) s.batteryPercent = power.BatteryLifePercent;
+        }
+        MEMORYSTATUSEX mem{ sizeof(mem) };
+        if (GlobalMemoryStatusEx(&mem)) s.availableMemoryMb = mem.ullAvailPhys >> 20;
+        return s;
+    }
+
+    bool Win32Platform::SampleForeground(Detect::Sample& out, Detect::SampleCache& cache) {
+        HWND fg = GetForegroundWindow();
+        if (!fg || fg == GetShellWindow()) return false;
+        DWORD pid = 0;
+        GetWindowThreadProcessId(fg, &pid);
+        HANDLE proc = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, pid);
+        if (!proc) return false;
+
+        const ULONGLONG start = ProcessUtil::StartTimeOf(proc);
+        if (pid != cache.pid || start != cache.startTime) {
+            cache = Detect::SampleCache();
+            cache.pid = pid;
+            cache.startTime = start;
+            char path[MAX_PATH]{};
+            DWORD len = MAX_PATH;
+            std::string exe = QueryFullProcessImageNameA(proc, 0, path, &len) ? path : "";
+            if (auto pos = exe.find_last_of("\\/"); pos != std::string::npos)
+                exe = exe.substr(pos + 1);
+            cache.last.exe = Lower(exe);
+            cache.last.pid = pid;
+            cache.last.startTime = start;
+        }
+        Detect::Sample& s = cache.last;
+
+        const auto now = Clock::now();
+        const ULONGLONG cpu = ProcessUtil::CpuTimeOf(proc);
+        if (cache.cpuAt != Clock::time_point{}) {
+            const double seconds = std::chrono::duration<double>(now - cache.cpuAt).count();
+            if (seconds > 0) s.cpuCores = (cpu - cache.cpu) / 1e7 / seconds;
+        }
+        cache.cpu = cpu;
+        cache.cpuAt = now;
+        s.fullscreen = CoversMonitor(fg);
+
+        // Snapshots and module lists are the expensive part; games do not
+        // change shape second to second.
+        if (now - cache.deepAt >= std::chrono::seconds(2))
+            SampleThreads(pid, cache, now);
+        if (!s.graphics && now - cache.modulesAt >= std::chrono::seconds(10)) {
+            SampleModules(proc, s);
+            cache.modulesAt = now;
+        }
+        CloseHandle(proc);
+        out = s;
+        return true;
+    }
+
+    void Win32Platform::QueryUsage(std::vector<Pressure::Usage>& out) {
+        size_t n = 0;
+        ProcessScan::Snapshot& scan = ProcessScan::ThisThread();
+        if (scan.Take()) {
+            for (const auto& p : scan.Processes()) {
+                if (!p.startTime) continue;
+                if (n == out.size()) out.emplace_back();
+                Pressure::Usage& u = out[n++];
+                u.proc.pid = p.pid;
+                u.proc.startTime = p.startTime;
+                p.NameTo(u.proc.exe);
+                u.cpuTime = p.cpuTime;
+                u.workingSet = p.workingSet;
+                u.hardFaults = p.hardFaults;
+                u.cpuDelta = 0;
+            }
+        }
+        out.resize(n);
+    }
+
+    bool Win32Platform::TrimWorkingSet(const ProcessInfo& p) {
+        HANDLE h = ProcessUtil::OpenVerified(p, PROCESS_QUERY_INFORMATION | PROCESS_SET_QUOTA);
+        if (!h) return false;
+        const bool ok = EmptyWorkingSet(h) != FALSE;
+        CloseHandle(h);
+        return ok;
+    }
+
+    bool Win32Platform::QueryMemory(Headroom::MemoryState& out) {
+        MemoryListCounts lists{};
+        if (NtQuerySystemInformation(static_cast<SYSTEM_INFORMATION_CLASS>(MemoryListInformation),
+            &lists, sizeof(lists), nullptr) < 0)
+            return false;
+        SYSTEM_INFO si;
+        GetSystemInfo(&si);
+        MEMORYSTATUSEX ms{ sizeof(ms) };
+        GlobalMemoryStatusEx(&ms);
+
+        const uint64_t page = si.dwPageSize;
+        out.total = ms.ullTotalPhys;
+        out.free = (uint64_t(lists.zeroPageCount) + lists.freePageCount) * page;
+        out.standby = 0;
+        for (ULONG_PTR n : lists.pageCountByPriority) out.standby += uint64_t(n) * page;
+        out.modified = (uint64_t(lists.modifiedPageCount) + lists.modifiedNoWritePageCount) * page;
+        return true;
+    }
+
+    bool Win32Platform::PurgeStandby(bool lowPriorityOnly) {
+        int command = lowPriorityOnly ? MemoryPurgeLowPriorityStandbyList : MemoryPurgeStandbyList;
+        return NtSetSystemInformation(MemoryListInformation, &command, sizeof(command)) >= 0;
+    }
+
+    bool Win32Platform::GetIdleStateLimit(PowerQos::IdleLimit& out) {
+        GUID* scheme = nullptr;
+        if (PowerGetActiveScheme(nullptr, &scheme) != ERROR_SUCCESS) return false;
+        DWORD ac = 0, dc = 0;
+        const bool ok =
+            PowerReadACValueIndex(nullptr, scheme, &ProcessorSubgroup, &IdleStateMaximum, &ac) == ERROR_SUCCESS
+            && PowerReadDCValueIndex(nullptr, scheme, &ProcessorSubgroup, &IdleStateMaximum, &dc) == ERROR_SUCCESS;
+        out = { ac, dc, FormatGuid(*scheme) };
+        LocalFree(scheme);
+        return ok;
+    }
+
+    // Into the plan named by `limit`, so a replay after the user switched
+    // plans still restores the one that was changed.
+    bool Win32Platform::SetIdleStateLimit(const PowerQos::IdleLimit& limit) {
+        GUID* active = nullptr;
+        if (PowerGetActiveScheme(nullptr, &active) != ERROR_SUCCESS) return false;
+        GUID scheme = *active;
+        LocalFree(active);
+        const bool isActive = limit.scheme.empty() || limit.scheme == FormatGuid(scheme);
+        if (!limit.scheme.empty() && !ParseGuid(limit.scheme, scheme)) return false;
+        bool ok =
+            PowerWriteACValueIndex(nullptr, &scheme, &ProcessorSubgroup, &IdleStateMaximum, limit.ac) == ERROR_SUCCESS
+            && PowerWriteDCValueIndex(nullptr, &scheme, &ProcessorSubgroup, &IdleStateMaximum, limit.dc) == ERROR_SUCCESS;
+        // Written values take effect when the plan is applied again.
+        if (ok && isActive) ok = PowerSetActiveScheme(nullptr, &scheme) == ERROR_SUCCESS;
+        return ok;
+    }
+
+    bool Win32Platform::GetPowerThrottling(const ProcessInfo& p, PowerQos::Throttling& out) {
+        HANDLE h = ProcessUtil::OpenVerified(p, 0);
+        if (!h) return false;
+        PROCESS_POWER_THROTTLING_STATE state{ PROCESS_POWER_THROTTLING_CURRENT_VERSION };
+        // Windows 11 and later; without it there is nothing to restore.
+        const bool ok = GetProcessInformation(h, ProcessPowerThrottling, &state, sizeof(state)) != FALSE;
+        CloseHandle(h);
+        if (ok) out = { state.ControlMask, state.StateMask };
+        return ok;
+    }
+
+    bool Win32Platform::SetPowerThrottling(const ProcessInfo& p, const PowerQos::Throttling& state) {
+        HANDLE h = ProcessUtil::OpenVerified(p, PROCESS_SET_INFORMATION);
+        if (!h) return false;
+        PROCESS_POWER_THROTTLING_STATE s{ PROCESS_POWER_THROTTLING_CURRENT_VERSION };
+        s.ControlMask = state.controlMask;
+        s.StateMask = state.stateMask;
+        const bool ok = SetProcessInformation(h, ProcessPowerThrottling, &s, sizeof(s)) != FALSE;
+        CloseHandle(h);
+        return ok;
+    }
+
+} // namespace Booster
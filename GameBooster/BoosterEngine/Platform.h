@@ -0,0 +1,110 @@
+﻿#pragma once
+
+#include "CpuSteering.h"
+#include "Detect.h"
+#include "Headroom.h"
+#include "PowerQos.h"
+#include "Pressure.h"
+#include "ProcessUtil.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ============================================================
+// ENGINE PLATFORM
+// ============================================================
+
+namespace Booster {
+
+    using ProcessUtil::ProcessInfo;
+
+    struct SystemState {
+        bool     acPower = true;
+        int      batteryPercent = 100;
+        uint64_t availableMemoryMb = 0;
+    };
+
+    // Everything the engine asks of the OS. Win32Platform is the real one;
+    // embedders and tests substitute their own (BoosterApi.h exposes the
+    // same surface as a table of C callbacks).
+    class Platform : public CpuSteering::Backend {
+    public:
+        // Once per monitor loop, before the first tick.
+        virtual void Prepare() {}
+        virtual std::string ForegroundProcess() = 0;
+        virtual bool Terminate(const ProcessInfo& p, std::string& imagePath, uint32_t& error) = 0;
+        virtual bool GetPriority(const ProcessInfo& p, DWORD& priorityClass) = 0;
+        virtual bool SetPriority(const ProcessInfo& p, DWORD priorityClass) = 0;
+        virtual bool Launch(const std::string& command, uint32_t& error) = 0;
+        virtual ULONGLONG CpuTime(const ProcessInfo& p) = 0;   // 100 ns units
+        virtual void Sleep(DWORD ms) = 0;
+        virtual SystemState QuerySystem() { return {}; }
+        // Behavioural signals for the foreground process; false when there is
+        // none or the platform cannot observe it.
+        virtual bool SampleForeground(Detect::Sample&, Detect::SampleCache&) { return false; }
+
+        // Mid-session escalation. Null: pressure is not observed.
+        virtual Pressure::Source* PressureSource() { return nullptr; }
+        // Every process with its cumulative CPU time and working set.
+        virtual void QueryUsage(std::vector<Pressure::Usage>& out) { out.clear(); }
+        virtual bool TrimWorkingSet(const ProcessInfo&) { return false; }
+
+        // Headroom ahead of a game. False: memory is not managed.
+        virtual bool QueryMemory(Headroom::MemoryState&) { return false; }
+        // Drops clean cached pages; with `lowPriorityOnly`, only those
+        // nobody has touched lately.
+        virtual bool PurgeStandby(bool /*lowPriorityOnly*/) { return false; }
+
+        // Power QoS for a session. False: not available here.
+        virtual bool GetIdleStateLimit(PowerQos::IdleLimit&) { return false; }
+        virtual bool SetIdleStateLimit(const PowerQos::IdleLimit&) { return false; }
+        virtual bool GetPowerThrottling(const ProcessInfo&, PowerQos::Throttling&) { return false; }
+        virtual bool SetPowerThrottling(const ProcessInfo&, const PowerQos::Throttling&) { return false; }
+        // Idle-state residency since the previous call.
+        virtual bool ReadIdleResidency(PowerQos::Residency&) { return false; }
+    };
+
+    class Win32Platform final : public Platform {
+    public:
+        // Every engine on the real OS shares one; the only state, the
+        // pressure counters, is machine-wide and locked.
+        static Win32Platform& Instance();
+
+        DWORD_PTR SystemMask() override { return steering_.SystemMask(); }
+        void Enumerate(std::vector<ProcessInfo>& out) override { steering_.Enumerate(out); }
+        bool GetAffinity(const ProcessInfo& p, DWORD_PTR& mask) override {
+            return steering_.GetAffinity(p, mask);
+        }
+        bool SetAffinity(const ProcessInfo& p, DWORD_PTR mask) override {
+            return steering_.SetAffinity(p, mask);
+        }
+
+        void Prepare() override;
+        std::string ForegroundProcess() override;
+        bool Terminate(const ProcessInfo& p, std::string& imagePath, uint32_t& error) override;
+        bool GetPriority(const ProcessInfo& p, DWORD& priorityClass) override;
+        bool SetPriority(const ProcessInfo& p, DWORD priorityClass) override;
+        bool Launch(const std::string& command, uint32_t& error) override;
+        ULONGLONG CpuTime(const ProcessInfo& p) override;
+        void Sleep(DWORD ms) override;
+        SystemState QuerySystem() override;
+        bool SampleForeground(Detect::Sample& out, Detect::SampleCache& cache) override;
+        Pressure::Source* PressureSource() override { return &pressure_; }
+        void QueryUsage(std::vector<Pressure::Usage>& out) override;
+        bool TrimWorkingSet(const ProcessInfo& p) override;
+        bool QueryMemory(Headroom::MemoryState& out) override;
+        bool PurgeStandby(bool lowPriorityOnly) override;
+        bool GetIdleStateLimit(PowerQos::IdleLimit& out) override;
+        bool SetIdleStateLimit(const PowerQos::IdleLimit& limit) override;
+        bool GetPowerThrottling(const ProcessInfo& p, PowerQos::Throttling& out) override;
+        bool SetPowerThrottling(const ProcessInfo& p, const PowerQos::Throttling& state) override;
+        bool ReadIdleResidency(PowerQos::Residency& out) override { return residency_.Read(out); }
+
+    private:
+        CpuSteering::Win32Backend steering_;
+        Pressure::Win32Source     pressure_;
+        PowerQos::Win32Residency  residency_;
+    };
+
+} // namespace Booster
@@ -0,0 +1,61 @@
+﻿#define NOMINMAX
+#include "PowerQos.h"
+
+#include <windows.h>
+#include <pdh.h>
+
+#include <algorithm>
+
+#pragma comment(lib, "pdh.lib")
+
+namespace PowerQos {
+
+    // ------------------------------------------------------------
+    // Win32Residency
+    // ------------------------------------------------------------
+
+    Win32Residency::~Win32Residency() {
+        if (query_) PdhCloseQuery(static_cast<PDH_HQUERY>(query_));
+    }
+
+    bool Win32Residency::Open() {
+        opened_ = true;
+        PDH_HQUERY query = nullptr;
+        if (PdhOpenQueryA(nullptr, 0, &query) != ERROR_SUCCESS) return false;
+        query_ = query;
+        const char* const paths[] = {
+            "\\Processor Information(_Total)\\% C1 Time",
+            "\\Processor Information(_Total)\\% C2 Time",
+            "\\Processor Information(_Total)\\% C3 Time",
+        };
+        for (size_t i = 0; i < 3; ++i) {
+            PDH_HCOUNTER c = nullptr;
+            if (PdhAddEnglishCounterA(query, paths[i], 0, &c) == ERROR_SUCCESS) states_[i] = c;
+        }
+        PdhCollectQueryData(query);
+        return true;
+    }
+
+    bool Win32Residency::Read(Residency& out) {
+        std::lock_guard lock(mutex_);
+        if (!opened_) {
+            Open();
+            return false;   // rate counters need a second sample
+        }
+        if (!query_ || PdhCollectQueryData(static_cast<PDH_HQUERY>(query_)) != ERROR_SUCCESS)
+            return false;
+
+        double share[3] = {};
+        for (size_t i = 0; i < 3; ++i) {
+            PDH_FMT_COUNTERVALUE v{};
+            if (states_[i] && PdhGetFormattedCounterValue(static_cast<PDH_HCOUNTER>(states_[i]),
+                PDH_FMT_DOUBLE, nullptr, &v) == ERROR_SUCCESS && v.CStatus == ERROR_SUCCESS)
+                share[i] = std::clamp(v.doubleValue / 100.0, 0.0, 1.0);
+        }
+        out.c1 = share[0];
+        out.c2 = share[1];
+        out.c3 = share[2];
+        return true;
+    }
+
+} // namespace PowerQos
@@ -0,0 +1,88 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+
+// ============================================================
+// POWER QOS
+// ============================================================
+//
+// Keeps the game out of the power throttling that coalesces its timers,
+// and on request holds the processors out of deep idle states for a
+// session. A core in C3 or deeper takes hundreds of microseconds to wake,
+// and the render thread pays that on every frame it sleeps through.
+// Windows has no process-held latency bound (the nearest user-mode knob is
+// the power plan's deepest allowed idle state), so the limit is written to
+// the active plan's AC setting and journaled together with that plan's
+// GUID; the battery setting is never touched. Exit puts it back; after a
+// crash it stays in that plan until the next start replays the journal,
+// which is why the cap is opt-in. Residency counters show what it changed.
+
+namespace PowerQos {
+
+    struct Options {
+        bool     enabled = true;
+        // Deepest idle state allowed on AC power during a session: 1 = C1
+        // only; 0 leaves the power plan alone.
+        uint32_t idleStateLimit = 0;
+        bool     exemptGame = true;     // from EcoQoS and timer-resolution throttling
+    };
+
+    // The power plan's "processor idle state maximum"; 0 means no limit.
+    struct IdleLimit {
+        uint32_t    ac = 0, dc = 0;
+        std::string scheme;     // "{GUID}" of the plan; empty: the active one
+
+        uint64_t Pack() const { return static_cast<uint64_t>(dc) << 32 | ac; }
+        static IdleLimit Unpack(uint64_t v, std::string scheme = {}) {
+            return { static_cast<uint32_t>(v), static_cast<uint32_t>(v >> 32), std::move(scheme) };
+        }
+    };
+
+    // PROCESS_POWER_THROTTLING_STATE masks. A bit set in controlMask and
+    // clear in stateMask opts out; controlMask 0 lets the system decide.
+    constexpr uint32_t ThrottleExecutionSpeed = 0x1;
+    constexpr uint32_t ThrottleIgnoreTimerResolution = 0x4;
+
+    struct Throttling {
+        uint32_t controlMask = 0, stateMask = 0;
+
+        uint64_t Pack() const { return static_cast<uint64_t>(stateMask) << 32 | controlMask; }
+        static Throttling Unpack(uint64_t v) {
+            return { static_cast<uint32_t>(v), static_cast<uint32_t>(v >> 32) };
+        }
+    };
+
+    // Never slowed down, and its timer resolution requests always honoured.
+    constexpr Throttling Exempt{ ThrottleExecutionSpeed | ThrottleIgnoreTimerResolution, 0 };
+
+    // Share of processor time spent in each idle state, 0..1.
+    struct Residency {
+        double c1 = 0, c2 = 0, c3 = 0;
+    };
+
+    // "% C1/C2/C3 Time" over all processors, via PDH. Each Read covers the
+    // time since the previous one. Safe to share between engines.
+    class Win32Residency {
+    public:
+        Win32Residency() = default;
+        ~Win32Residency();
+
+        Win32Residency(const Win32Residency&) = delete;
+        Win32Residency& operator=(const Win32Residency&) = delete;
+
+        // False until there is a previous sample to measure from.
+        bool Read(Residency& out);
+
+    private:
+        bool Open();
+
+        std::mutex mutex_;
+        bool       opened_ = false;
+        void*      query_ = nullptr;        // PDH_HQUERY
+        void*      states_[3] = {};         // PDH_HCOUNTER, C1..C3
+    };
+
+} // namespace PowerQos
@@ -0,0 +1,168 @@
+﻿#define NOMINMAX
+#include "Pressure.h"
+
+#include <pdh.h>
+
+#include <algorithm>
+#include <thread>
+
+#pragma comment(lib, "pdh.lib")
+
+namespace Pressure {
+
+    namespace {
+
+        // What counts as saturated, per source counter.
+        constexpr double RunQueuePerCore = 2.0;     // waiting threads per processor
+        constexpr double PagesInPerSec = 2000.0;    // hard faults, ~8 MB/s read back
+        constexpr double DiskQueue = 4.0;           // outstanding requests
+
+        double Value(void* counter) {
+            PDH_FMT_COUNTERVALUE v{};
+            if (PdhGetFormattedCounterValue(static_cast<PDH_HCOUNTER>(counter),
+                PDH_FMT_DOUBLE | PDH_FMT_NOCAP100, nullptr, &v) != ERROR_SUCCESS
+                || v.CStatus != ERROR_SUCCESS)
+                return 0;
+            return v.doubleValue;
+        }
+
+    } // namespace
+
+    const char* ResourceName(Resource r) {
+        switch (r) {
+        case Resource::Cpu:    return "cpu";
+        case Resource::Memory: return "memory";
+        case Resource::Io:     return "io";
+        default:               return "unknown";
+        }
+    }
+
+    // ------------------------------------------------------------
+    // Win32Source
+    // ------------------------------------------------------------
+
+    Win32Source::Win32Source() = default;
+
+    Win32Source::~Win32Source() {
+        if (query_) PdhCloseQuery(static_cast<PDH_HQUERY>(query_));
+        if (lowMemory_) CloseHandle(lowMemory_);
+    }
+
+    bool Win32Source::Open() {
+        opened_ = true;
+        lowMemory_ = CreateMemoryResourceNotification(LowMemoryResourceNotification);
+        PDH_HQUERY query = nullptr;
+        if (PdhOpenQueryA(nullptr, 0, &query) != ERROR_SUCCESS) return false;
+        query_ = query;
+        // English names, so the counters resolve on localized systems too.
+        auto add = [query](const char* path, void*& out) {
+            PDH_HCOUNTER c = nullptr;
+            if (PdhAddEnglishCounterA(query, path, 0, &c) == ERROR_SUCCESS) out = c;
+            };
+        add("\\System\\Processor Queue Length", runQueue_);
+        add("\\Memory\\Pages Input/sec", pagesIn_);
+        add("\\PhysicalDisk(_Total)\\Avg. Disk Queue Length", diskQueue_);
+        PdhCollectQueryData(query);
+        return true;
+    }
+
+    bool Win32Source::Read(Reading& out) {
+        std::lock_guard lock(mutex_);
+        if (!opened_) {
+            Open();
+            return false;   // rate counters need a second sample
+        }
+        if (!query_ || PdhCollectQueryData(static_cast<PDH_HQUERY>(query_)) != ERROR_SUCCESS)
+            return false;
+
+        const double cores = std::max(1u, std::thread::hardware_concurrency());
+        out.cpu = runQueue_ ? std::min(1.0, Value(runQueue_) / (RunQueuePerCore * cores)) : 0;
+        out.memory = pagesIn_ ? std::min(1.0, Value(pagesIn_) / PagesInPerSec) : 0;
+        BOOL low = FALSE;
+        if (lowMemory_ && QueryMemoryResourceNotification(lowMemory_, &low) && low)
+            out.memory = 1;
+        out.io = diskQueue_ ? std::min(1.0, Value(diskQueue_) / DiskQueue) : 0;
+        return true;
+    }
+
+    // ------------------------------------------------------------
+    // Escalator
+    // ------------------------------------------------------------
+
+    int Escalator::Update(const Reading& r) {
+        bool over = false, under = true;
+        double worst = 0;
+        Resource worstOf = Resource::Cpu;
+        for (size_t i = 0; i < static_cast<size_t>(Resource::Count); ++i) {
+            const Resource res = static_cast<Resource>(i);
+            const double v = r.Of(res);
+            if (v >= opts_.raise[i]) over = true;
+            if (v > opts_.lower[i]) under = false;
+            const double excess = opts_.raise[i] > 0 ? v / opts_.raise[i] : 0;
+            if (excess > worst) {
+                worst = excess;
+                worstOf = res;
+            }
+        }
+
+        // Between the thresholds both runs restart: that band is the hysteresis.
+        above_ = over ? above_ + 1 : 0;
+        below_ = under ? below_ + 1 : 0;
+
+        if (above_ >= opts_.raiseTicks && level_ < opts_.maxLevel) {
+            above_ = 0;
+            ++level_;
+            cause_ = worstOf;
+            return 1;
+        }
+        if (below_ >= opts_.lowerTicks && level_ > 0) {
+            below_ = 0;
+            --level_;
+            return -1;
+        }
+        return 0;
+    }
+
+    void Escalator::Reset() {
+        level_ = 0;
+        above_ = below_ = 0;
+        cause_ = Resource::Cpu;
+    }
+
+    // ------------------------------------------------------------
+    // Offenders
+    // ------------------------------------------------------------
+
+    void Offenders::Observe(std::vector<Usage>& table) {
+        std::map<std::pair<DWORD, ULONGLONG>, uint64_t> current;
+        for (auto& u : table) {
+            const auto key = std::make_pair(u.proc.pid, u.proc.startTime);
+            const auto it = previous_.find(key);
+            u.cpuDelta = it != previous_.end() && u.cpuTime >= it->second
+                ? u.cpuTime - it->second : 0;
+            current.emplace(key, u.cpuTime);
+        }
+        previous_ = std::move(current);
+        table_.swap(table);
+    }
+
+    std::vector<const Usage*> Offenders::Top(Resource cause, size_t count,
+        const std::function<bool(const ProcessUtil::ProcessInfo&)>& skip) const
+    {
+        std::vector<const Usage*> ranked;
+        for (const auto& u : table_)
+            if (!skip(u.proc)) ranked.push_back(&u);
+        auto weight = [cause](const Usage* u) {
+            return cause == Resource::Memory ? u->workingSet : u->cpuDelta;
+            };
+        const size_t n = std::min(count, ranked.size());
+        std::partial_sort(ranked.begin(), ranked.begin() + n, ranked.end(),
+            [&](const Usage* a, const Usage* b) { return weight(a) > weight(b); });
+        ranked.resize(n);
+        // Nothing to gain from a process that is not using the resource.
+        ranked.erase(std::remove_if(ranked.begin(), ranked.end(),
+            [&](const Usage* u) { return weight(u) == 0; }), ranked.end());
+        return ranked;
+    }
+
+} // namespace Pressure
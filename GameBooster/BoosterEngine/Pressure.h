@@ -0,0 +1,130 @@
+﻿#pragma once
+
+#include "ProcessUtil.h"
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// ============================================================
+// PRESSURE
+// ============================================================
+//
+// Reacts to contention during a session. A Source reports how hard the
+// machine is pressed for CPU, memory and I/O; the Escalator turns those
+// readings into one step up or down at a time, with separate raise and
+// lower thresholds and a run of ticks required on either side, so a
+// reading hovering near a threshold does not flap.
+
+namespace Pressure {
+
+    enum class Resource : uint8_t { Cpu, Memory, Io, Count };
+
+    const char* ResourceName(Resource r);
+
+    // 0 = idle, 1 = saturated.
+    struct Reading {
+        double cpu = 0;
+        double memory = 0;
+        double io = 0;
+
+        double Of(Resource r) const {
+            return r == Resource::Cpu ? cpu : r == Resource::Memory ? memory : io;
+        }
+    };
+
+    struct Options {
+        bool     enabled = true;
+        // Escalate above `raise`, de-escalate below `lower`; cpu, memory, io.
+        double   raise[3] = { 0.75, 0.80, 0.60 };
+        double   lower[3] = { 0.40, 0.50, 0.25 };
+        uint32_t raiseTicks = 3;    // consecutive ticks above before each step up
+        uint32_t lowerTicks = 10;   // consecutive ticks below before each step down
+        int      maxLevel = 4;
+        int      trimCount = 4;     // working sets trimmed per memory step
+    };
+
+    // Where readings come from. Win32Source is the real one; fakes feed
+    // scripted readings.
+    class Source {
+    public:
+        virtual ~Source() = default;
+        // False until the source has a reading (rates need two samples).
+        virtual bool Read(Reading& out) = 0;
+    };
+
+    // Run queue per processor for CPU, hard page faults and the low-memory
+    // notification for memory, and disk queue length for I/O, all via PDH.
+    // Safe to share between engines.
+    class Win32Source final : public Source {
+    public:
+        Win32Source();
+        ~Win32Source() override;
+
+        Win32Source(const Win32Source&) = delete;
+        Win32Source& operator=(const Win32Source&) = delete;
+
+        bool Read(Reading& out) override;
+
+    private:
+        bool Open();
+
+        std::mutex mutex_;
+        bool       opened_ = false;
+        void*      query_ = nullptr;        // PDH_HQUERY
+        void*      runQueue_ = nullptr;     // PDH_HCOUNTER
+        void*      pagesIn_ = nullptr;
+        void*      diskQueue_ = nullptr;
+        void*      lowMemory_ = nullptr;    // memory resource notification
+    };
+
+    // One process as seen by a pressure pass.
+    struct Usage {
+        ProcessUtil::ProcessInfo proc;
+        uint64_t cpuTime = 0;       // cumulative, 100 ns units
+        uint64_t workingSet = 0;    // bytes
+        uint32_t hardFaults = 0;    // cumulative
+        uint64_t cpuDelta = 0;      // since the previous Observe
+    };
+
+    // Turns readings into steps: +1 escalate, -1 de-escalate, 0 hold.
+    class Escalator {
+    public:
+        explicit Escalator(const Options& opts = {}) : opts_(opts) {}
+
+        int Update(const Reading& r);
+        void Reset();
+
+        int Level() const { return level_; }
+        // The resource furthest past its threshold at the last step up.
+        Resource Cause() const { return cause_; }
+
+    private:
+        Options  opts_;
+        int      level_ = 0;
+        uint32_t above_ = 0, below_ = 0;
+        Resource cause_ = Resource::Cpu;
+    };
+
+    // Ranks processes by what they press on: CPU time since the previous
+    // table for CPU and I/O, resident bytes for memory.
+    class Offenders {
+    public:
+        // Takes over the entries of `table`, handing back the previous
+        // table's storage for the next pass.
+        void Observe(std::vector<Usage>& table);
+        void Reset() { previous_.clear(); table_.clear(); }
+
+        // Up to `count` heaviest entries not rejected by `skip`.
+        std::vector<const Usage*> Top(Resource cause, size_t count,
+            const std::function<bool(const ProcessUtil::ProcessInfo&)>& skip) const;
+
+    private:
+        std::map<std::pair<DWORD, ULONGLONG>, uint64_t> previous_;
+        std::vector<Usage> table_;
+    };
+
+} // namespace Pressure
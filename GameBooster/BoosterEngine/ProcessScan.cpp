@@ -0,0 +1,167 @@
+﻿#define NOMINMAX
+#include "ProcessScan.h"
+
+#include <windows.h>
+#include <winternl.h>
+
+#include <algorithm>
+#include <cstdio>
+
+#pragma comment(lib, "ntdll.lib")
+
+namespace ProcessScan {
+
+    namespace {
+
+        constexpr NTSTATUS InfoLengthMismatch = static_cast<NTSTATUS>(0xC0000004L);
+
+        uint16_t Fold(uint16_t c) {
+            return c >= 'A' && c <= 'Z' ? static_cast<uint16_t>(c - 'A' + 'a') : c;
+        }
+
+    } // namespace
+
+    // ------------------------------------------------------------
+    // Process
+    // ------------------------------------------------------------
+
+    bool Process::NameIs(const char* exe) const {
+        uint32_t i = 0;
+        for (; i < nameChars && exe[i]; ++i) {
+            const auto c = static_cast<unsigned char>(exe[i]);
+            if (c >= 0x80 || name[i] >= 0x80) return _stricmp(Name().c_str(), exe) == 0;
+            if (Fold(name[i]) != Fold(c)) return false;
+        }
+        return i == nameChars && !exe[i];
+    }
+
+    std::string Process::Name() const {
+        std::string out;
+        NameTo(out);
+        return out;
+    }
+
+    void Process::NameTo(std::string& out) const {
+        out.resize(nameChars);
+        for (uint32_t i = 0; i < nameChars; ++i) {
+            if (name[i] >= 0x80) {
+                // Rare enough to take the slow path; matches what toolhelp gave us.
+                const int n = WideCharToMultiByte(CP_ACP, 0,
+                    reinterpret_cast<const wchar_t*>(name), static_cast<int>(nameChars),
+                    nullptr, 0, nullptr, nullptr);
+                out.resize(n > 0 ? n : 0);
+                if (n > 0)
+                    WideCharToMultiByte(CP_ACP, 0,
+                        reinterpret_cast<const wchar_t*>(name), static_cast<int>(nameChars),
+                        out.data(), n, nullptr, nullptr);
+                return;
+            }
+            out[i] = static_cast<char>(name[i]);
+        }
+    }
+
+    // ------------------------------------------------------------
+    // Snapshot
+    // ------------------------------------------------------------
+
+    bool Snapshot::Take() {
+        if (buffer_.empty()) buffer_.resize(256 * 1024 / sizeof(uint64_t));
+        for (int attempt = 0; attempt < 4; ++attempt) {
+            ULONG needed = 0;
+            const ULONG size = static_cast<ULONG>(buffer_.size() * sizeof(uint64_t));
+            const NTSTATUS status = NtQuerySystemInformation(SystemProcessInformation,
+                buffer_.data(), size, &needed);
+            if (status == InfoLengthMismatch) {
+                // Processes come and go between calls; leave some slack.
+                const size_t want = std::max<size_t>(needed, size) + needed / 8;
+                buffer_.resize(want / sizeof(uint64_t) + 1);
+                continue;
+            }
+            if (status < 0) break;
+            Parse(buffer_.data(), size);
+            return true;
+        }
+        procs_.clear();
+        threads_ = 0;
+        return false;
+    }
+
+    void Snapshot::Parse(const void* table, size_t size) {
+        procs_.clear();
+        threads_ = 0;
+        const auto* base = static_cast<const uint8_t*>(table);
+        for (size_t offset = 0; offset + sizeof(RawProcess) <= size;) {
+            const auto* raw = reinterpret_cast<const RawProcess*>(base + offset);
+            Process p;
+            p.pid = static_cast<uint32_t>(raw->uniqueProcessId);
+            p.parentPid = static_cast<uint32_t>(raw->inheritedFromUniqueProcessId);
+            p.startTime = static_cast<uint64_t>(raw->createTime);
+            p.cpuTime = static_cast<uint64_t>(raw->kernelTime + raw->userTime);
+            p.workingSet = raw->workingSetSize;
+            p.hardFaults = raw->hardFaultCount;
+            p.name = raw->nameBuffer;
+            p.nameChars = raw->nameBuffer ? raw->nameLength / 2u : 0;
+            p.threads = reinterpret_cast<const RawThread*>(raw + 1);
+            p.threadCount = raw->numberOfThreads;
+            procs_.push_back(p);
+            threads_ += p.threadCount;
+            if (!raw->nextEntryOffset) break;
+            offset += raw->nextEntryOffset;
+        }
+    }
+
+    const Process* Snapshot::Find(uint32_t pid) const {
+        for (const auto& p : procs_)
+            if (p.pid == pid) return &p;
+        return nullptr;
+    }
+
+    Snapshot& ThisThread() {
+        thread_local Snapshot scan;
+        return scan;
+    }
+
+    // ------------------------------------------------------------
+    // Synthetic tables
+    // ------------------------------------------------------------
+
+    std::vector<uint64_t> Synthesize(size_t processes, size_t threadsPerProcess) {
+        constexpr size_t nameChars = 24;
+        const size_t entry = sizeof(RawProcess) + threadsPerProcess * sizeof(RawThread)
+            + (nameChars + 1) * sizeof(uint16_t);
+        const size_t stride = (entry + 7) / 8 * 8;
+
+        // Moving the vector keeps its storage, so the name pointers stay valid.
+        std::vector<uint64_t> table(processes * stride / sizeof(uint64_t) + 1);
+        auto* base = reinterpret_cast<uint8_t*>(table.data());
+        for (size_t i = 0; i < processes; ++i) {
+            uint8_t* at = base + i * stride;
+            auto* raw = reinterpret_cast<RawProcess*>(at);
+            auto* threads = reinterpret_cast<RawThread*>(raw + 1);
+            auto* name = reinterpret_cast<uint16_t*>(threads + threadsPerProcess);
+
+            char text[nameChars + 1];
+            const int len = snprintf(text, sizeof(text), "Worker%zu.exe", i);
+            for (int c = 0; c < len; ++c) name[c] = static_cast<unsigned char>(text[c]);
+
+            raw->nextEntryOffset = i + 1 < processes ? static_cast<uint32_t>(stride) : 0;
+            raw->numberOfThreads = static_cast<uint32_t>(threadsPerProcess);
+            raw->createTime = 133000000000000000LL + static_cast<int64_t>(i) * 10000;
+            raw->userTime = static_cast<int64_t>(i % 977) * 1000;
+            raw->kernelTime = static_cast<int64_t>(i % 131) * 1000;
+            raw->nameLength = static_cast<uint16_t>(len * 2);
+            raw->nameMaximumLength = static_cast<uint16_t>((len + 1) * 2);
+            raw->nameBuffer = name;
+            raw->uniqueProcessId = (i + 2) * 4;
+            raw->inheritedFromUniqueProcessId = (i / 16 + 1) * 4;
+            raw->workingSetSize = (i % 64 + 1) * 1024 * 1024;
+            for (size_t t = 0; t < threadsPerProcess; ++t) {
+                threads[t].processId = raw->uniqueProcessId;
+                threads[t].threadId = (i * threadsPerProcess + t + 1) * 4 + 2;
+                threads[t].userTime = static_cast<int64_t>(t) * 100;
+            }
+        }
+        return table;
+    }
+
+} // namespace ProcessScan
@@ -0,0 +1,127 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ============================================================
+// PROCESS SCAN
+// ============================================================
+//
+// The whole process and thread table from one system call. A toolhelp
+// walk copies the table, then needs an OpenProcess per entry to learn a
+// start time and an OpenThread per thread to learn its CPU time; the
+// kernel's own table already carries both. Snapshot keeps its buffer
+// between scans and parses in place, so a steady-state scan allocates
+// nothing.
+
+namespace ProcessScan {
+
+    // SYSTEM_THREAD_INFORMATION and SYSTEM_PROCESS_INFORMATION as the kernel
+    // lays them out, in fixed-width types so that synthetic tables can be
+    // built (and parsed) anywhere.
+    struct RawThread {
+        int64_t   kernelTime;
+        int64_t   userTime;
+        int64_t   createTime;
+        uint32_t  waitTime;
+        uintptr_t startAddress;
+        uintptr_t processId;
+        uintptr_t threadId;
+        int32_t   priority;
+        int32_t   basePriority;
+        uint32_t  contextSwitches;
+        uint32_t  threadState;
+        uint32_t  waitReason;
+    };
+
+    struct RawProcess {
+        uint32_t  nextEntryOffset;      // 0 on the last entry
+        uint32_t  numberOfThreads;
+        int64_t   workingSetPrivateSize;
+        uint32_t  hardFaultCount;
+        uint32_t  numberOfThreadsHighWatermark;
+        uint64_t  cycleTime;
+        int64_t   createTime;
+        int64_t   userTime;
+        int64_t   kernelTime;
+        uint16_t  nameLength;           // bytes, UTF-16
+        uint16_t  nameMaximumLength;
+        const uint16_t* nameBuffer;
+        int32_t   basePriority;
+        uintptr_t uniqueProcessId;
+        uintptr_t inheritedFromUniqueProcessId;
+        uint32_t  handleCount;
+        uint32_t  sessionId;
+        uintptr_t uniqueProcessKey;
+        size_t    peakVirtualSize;
+        size_t    virtualSize;
+        uint32_t  pageFaultCount;
+        size_t    peakWorkingSetSize;
+        size_t    workingSetSize;
+        size_t    quotaPeakPagedPoolUsage;
+        size_t    quotaPagedPoolUsage;
+        size_t    quotaPeakNonPagedPoolUsage;
+        size_t    quotaNonPagedPoolUsage;
+        size_t    pagefileUsage;
+        size_t    peakPagefileUsage;
+        size_t    privatePageCount;
+        int64_t   ioCounters[6];
+        // RawThread[numberOfThreads] follows.
+    };
+
+    static_assert(sizeof(void*) != 8 || (sizeof(RawProcess) == 0x100 && sizeof(RawThread) == 0x50),
+        "layout must match the kernel's");
+
+    // One process, pointing into the snapshot that produced it.
+    struct Process {
+        uint32_t         pid = 0;
+        uint32_t         parentPid = 0;
+        uint64_t         startTime = 0;     // FILETIME ticks, 0 for the idle process
+        uint64_t         cpuTime = 0;       // kernel + user, 100 ns units
+        uint64_t         workingSet = 0;
+        uint32_t         hardFaults = 0;    // since the process started
+        const uint16_t*  name = nullptr;    // UTF-16, not terminated
+        uint32_t         nameChars = 0;
+        const RawThread* threads = nullptr;
+        uint32_t         threadCount = 0;
+
+        // Case-insensitive, like _stricmp on the narrow name, but without
+        // converting it unless either side is outside ASCII.
+        bool NameIs(const char* exe) const;
+        bool NameIs(const std::string& exe) const { return NameIs(exe.c_str()); }
+        std::string Name() const;
+        // Same, into `out`, reusing its capacity.
+        void NameTo(std::string& out) const;
+    };
+
+    class Snapshot {
+    public:
+        // Re-reads the process table, growing the buffer only when the table
+        // outgrew it.
+        bool Take();
+        // Parses a table already in the kernel's layout, e.g. from
+        // Synthesize(). `table` must stay alive and unmoved while the entries are used.
+        void Parse(const void* table, size_t size);
+
+        const std::vector<Process>& Processes() const { return procs_; }
+        const Process* Find(uint32_t pid) const;
+        size_t ThreadCount() const { return threads_; }
+
+    private:
+        std::vector<uint64_t> buffer_;      // 8-byte aligned, like the kernel wants
+        std::vector<Process>  procs_;
+        size_t                threads_ = 0;
+    };
+
+    // The calling thread's snapshot. Shared callers (one Win32Platform
+    // serves every engine) get a retained buffer without taking a lock;
+    // entries are valid until the same thread scans again.
+    Snapshot& ThisThread();
+
+    // Builds a table of `processes` entries with `threadsPerProcess`
+    // threads each, in the kernel's layout.
+    std::vector<uint64_t> Synthesize(size_t processes, size_t threadsPerProcess);
+
+} // namespace ProcessScan
@@ -0,0 +1,112 @@
+﻿#define _CRT_SECURE_NO_WARNINGS
+#define NOMINMAX
+
+#include "ProcessUtil.h"
+#include "ProcessScan.h"
+
+#include <psapi.h>
+
+#include <malloc.h>
+
+namespace ProcessUtil {
+
+    void EnableDebugPrivilege() {
+        EnablePrivilege(SE_DEBUG_NAME);
+    }
+
+    bool EnablePrivilege(const char* name) {
+        HANDLE tok;
+        if (!OpenProcessToken(GetCurrentProcess(),
+            TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &tok))
+            return false;
+        LUID luid;
+        LookupPrivilegeValueA(nullptr, name, &luid);
+        TOKEN_PRIVILEGES tp{};
+        tp.PrivilegeCount = 1;
+        tp.Privileges[0] = { luid, SE_PRIVILEGE_ENABLED };
+        // Succeeds without assigning anything the token does not hold.
+        const bool ok = AdjustTokenPrivileges(tok, FALSE, &tp, sizeof(tp), nullptr, nullptr)
+            && GetLastError() == ERROR_SUCCESS;
+        CloseHandle(tok);
+        return ok;
+    }
+
+    std::string GetForegroundProcessName() {
+        HWND fg = GetForegroundWindow();
+        if (!fg) return {};
+        DWORD pid = 0;
+        GetWindowThreadProcessId(fg, &pid);
+        HANDLE proc = OpenProcess(
+            PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, pid);
+        if (!proc) return {};
+        char path[MAX_PATH]{};
+        std::string name;
+        if (GetModuleFileNameExA(proc, nullptr, path, MAX_PATH)) {
+            name = path;
+            if (auto pos = name.find_last_of("\\/"); pos != std::string::npos)
+                name = name.substr(pos + 1);
+        }
+        CloseHandle(proc);
+        return name;
+    }
+
+    ULONGLONG StartTimeOf(HANDLE proc) {
+        FILETIME created, exited, kernel, user;
+        if (!GetProcessTimes(proc, &created, &exited, &kernel, &user))
+            return 0;
+        return (static_cast<ULONGLONG>(created.dwHighDateTime) << 32)
+            | created.dwLowDateTime;
+    }
+
+    ULONGLONG CpuTimeOf(HANDLE proc) {
+        FILETIME created, exited, kernel, user;
+        if (!GetProcessTimes(proc, &created, &exited, &kernel, &user))
+            return 0;
+        auto ticks = [](const FILETIME& ft) {
+            return (static_cast<ULONGLONG>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+            };
+        return ticks(kernel) + ticks(user);
+    }
+
+    SelfUsage QuerySelf() {
+        SelfUsage u;
+        u.cpuTime = CpuTimeOf(GetCurrentProcess());
+        PROCESS_MEMORY_COUNTERS_EX pmc{};
+        pmc.cb = sizeof(pmc);
+        if (GetProcessMemoryInfo(GetCurrentProcess(),
+            reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&pmc), sizeof(pmc))) {
+            u.workingSet = pmc.WorkingSetSize;
+            u.privateBytes = pmc.PrivateUsage;
+        }
+        return u;
+    }
+
+    void TrimSelf() {
+        _heapmin();
+        HeapCompact(GetProcessHeap(), 0);
+        SetProcessWorkingSetSize(GetCurrentProcess(),
+            static_cast<SIZE_T>(-1), static_cast<SIZE_T>(-1));
+    }
+
+    HANDLE OpenVerified(const ProcessInfo& p, DWORD access) {
+        HANDLE h = OpenProcess(access | PROCESS_QUERY_LIMITED_INFORMATION,
+            FALSE, p.pid);
+        if (!h) return nullptr;
+        if (StartTimeOf(h) != p.startTime) {
+            CloseHandle(h);
+            return nullptr;
+        }
+        return h;
+    }
+
+    std::vector<ProcessInfo> FindByName(const std::string& name) {
+        std::vector<ProcessInfo> found;
+        ProcessScan::Snapshot& scan = ProcessScan::ThisThread();
+        if (!scan.Take()) return found;
+        for (const auto& p : scan.Processes())
+            if (p.startTime && p.NameIs(name))
+                found.push_back({ p.pid, p.startTime, p.Name() });
+        return found;
+    }
+
+} // namespace ProcessUtil
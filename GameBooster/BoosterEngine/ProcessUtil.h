@@ -0,0 +1,46 @@
+﻿#pragma once
+
+#include <windows.h>
+
+#include <string>
+#include <vector>
+
+// ============================================================
+// PROCESS UTILITIES
+// ============================================================
+
+namespace ProcessUtil {
+
+    // A process instance rather than just a pid: the start time lets us
+    // notice when a pid has been recycled between snapshot and use.
+    struct ProcessInfo {
+        DWORD       pid = 0;
+        ULONGLONG   startTime = 0;  // FILETIME ticks
+        std::string exe;
+    };
+
+    void EnableDebugPrivilege();
+    // `name` is an SE_*_NAME constant; false when the token lacks it.
+    bool EnablePrivilege(const char* name);
+    std::string GetForegroundProcessName();
+
+    ULONGLONG StartTimeOf(HANDLE proc);
+    ULONGLONG CpuTimeOf(HANDLE proc);   // kernel + user, 100 ns units
+
+    // What the booster itself costs the machine it is freeing up.
+    struct SelfUsage {
+        ULONGLONG cpuTime = 0;          // kernel + user, 100 ns units
+        SIZE_T    workingSet = 0;       // resident bytes
+        SIZE_T    privateBytes = 0;     // committed bytes
+    };
+    SelfUsage QuerySelf();
+    // Compacts the heaps and hands this process's pages back to the
+    // standby list; touched pages fault back in without disk I/O.
+    void TrimSelf();
+
+    // Opens `p` only if it is still the instance we enumerated.
+    HANDLE OpenVerified(const ProcessInfo& p, DWORD access);
+
+    std::vector<ProcessInfo> FindByName(const std::string& name);
+
+} // namespace ProcessUtil
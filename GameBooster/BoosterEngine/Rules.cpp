@@ -0,0 +1,440 @@
+﻿#define NOMINMAX
+
+#include "Rules.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+namespace Rules {
+
+    namespace {
+
+        std::string Lower(std::string s) {
+            std::transform(s.begin(), s.end(), s.begin(),
+                [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return s;
+        }
+
+        struct Token {
+            enum Kind { End, Ident, Number, String, LParen, RParen, Compare, Bad } kind = End;
+            std::string text;   // identifier, string body, unit or operator
+            double      value = 0;
+        };
+
+        class Lexer {
+        public:
+            explicit Lexer(const std::string& line) : s_(line) {}
+
+            Token Next() {
+                while (i_ < s_.size() && std::isspace(static_cast<unsigned char>(s_[i_]))) ++i_;
+                Token t;
+                if (i_ >= s_.size()) return t;
+
+                const char c = s_[i_];
+                if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+                    const size_t b = i_;
+                    while (i_ < s_.size() && (std::isalnum(static_cast<unsigned char>(s_[i_]))
+                        || s_[i_] == '_'))
+                        ++i_;
+                    t.kind = Token::Ident;
+                    t.text = Lower(s_.substr(b, i_ - b));
+                    return t;
+                }
+                if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+                    char* end = nullptr;
+                    t.value = std::strtod(s_.c_str() + i_, &end);
+                    if (end == s_.c_str() + i_) {
+                        t.kind = Token::Bad;
+                        t.text = "malformed number";
+                        i_ = s_.size();
+                        return t;
+                    }
+                    i_ = end - s_.c_str();
+                    // HH:MM is minutes since midnight.
+                    if (i_ < s_.size() && s_[i_] == ':') {
+                        const double minutes = std::strtod(s_.c_str() + i_ + 1, &end);
+                        i_ = end - s_.c_str();
+                        t.value = t.value * 60 + minutes;
+                    }
+                    const size_t b = i_;
+                    while (i_ < s_.size() && (std::isalpha(static_cast<unsigned char>(s_[i_]))
+                        || s_[i_] == '%'))
+                        ++i_;
+                    t.kind = Token::Number;
+                    t.text = Lower(s_.substr(b, i_ - b));
+                    return t;
+                }
+                if (c == '"') {
+                    const size_t close = s_.find('"', i_ + 1);
+                    if (close == std::string::npos) {
+                        t.kind = Token::Bad;
+                        t.text = "unterminated string";
+                        i_ = s_.size();
+                        return t;
+                    }
+                    t.kind = Token::String;
+                    t.text = Lower(s_.substr(i_ + 1, close - i_ - 1));
+                    i_ = close + 1;
+                    return t;
+                }
+                if (c == '(' || c == ')') {
+                    t.kind = c == '(' ? Token::LParen : Token::RParen;
+                    ++i_;
+                    return t;
+                }
+                static const char* const ops[] = { "<=", ">=", "==", "!=", "<", ">" };
+                for (const char* op : ops) {
+                    if (s_.compare(i_, strlen(op), op) == 0) {
+                        t.kind = Token::Compare;
+                        t.text = op;
+                        i_ += strlen(op);
+                        return t;
+                    }
+                }
+                t.kind = Token::Bad;
+                t.text = std::string("unexpected '") + c + "'";
+                ++i_;
+                return t;
+            }
+
+        private:
+            const std::string& s_;
+            size_t i_ = 0;
+        };
+
+        // Durations become milliseconds, sizes megabytes.
+        bool ApplyUnit(const std::string& unit, double& v) {
+            if (unit.empty() || unit == "%" || unit == "mb" || unit == "ms") return true;
+            if (unit == "gb") { v *= 1024; return true; }
+            if (unit == "s") { v *= 1000; return true; }
+            if (unit == "m" || unit == "min") { v *= 60 * 1000; return true; }
+            if (unit == "h") { v *= 60 * 60 * 1000; return true; }
+            return false;
+        }
+
+        bool NamedFact(const std::string& name, Fact& kind) {
+            static const std::pair<const char*, Fact> names[] = {
+                { "ac_power", Fact::AcPower }, { "battery", Fact::Battery },
+                { "free_ram", Fact::FreeRam }, { "time", Fact::Time },
+                { "weekday", Fact::Weekday }, { "game_cpu", Fact::GameCpu },
+            };
+            for (const auto& [n, k] : names) {
+                if (name == n) {
+                    kind = k;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    } // namespace
+
+    // ------------------------------------------------------------
+    // Compiler
+    // ------------------------------------------------------------
+
+    class Parser {
+    public:
+        Parser(RuleSet& set, const std::string& line) : set_(set), lex_(line) {
+            Advance();
+        }
+
+        // Appends one rule; on failure the code it emitted is rolled back.
+        bool Rule(int lineNo, std::string& error) {
+            const size_t codeMark = set_.code_.size();
+            const size_t constMark = set_.consts_.size();
+            const size_t timerMark = set_.timers_.size();
+            const size_t factMark = set_.facts_.size();
+            const uint32_t kinds = set_.kinds_;
+
+            RuleSet::Rule rule;
+            rule.line = lineNo;
+            rule.begin = static_cast<uint32_t>(codeMark);
+            bool ok = true;
+            if (IsWord("allow")) rule.deny = false;
+            else if (IsWord("deny")) rule.deny = true;
+            else ok = Fail("expected 'allow' or 'deny'");
+            if (ok) Advance();
+            ok = ok && Expect("when") && Or() && (tok_.kind == Token::End || Fail("trailing input"));
+            if (ok && maxDepth_ > RuleSet::MaxStack) ok = Fail("expression too deep");
+
+            if (!ok) {
+                set_.code_.resize(codeMark);
+                set_.consts_.resize(constMark);
+                set_.timers_.resize(timerMark);
+                // Facts only a bad line used would still be sampled every tick.
+                set_.facts_.resize(factMark);
+                set_.values_.resize(factMark);
+                set_.kinds_ = kinds;
+                error = error_;
+                return false;
+            }
+            rule.end = static_cast<uint32_t>(set_.code_.size());
+            rule.deps = deps_;
+            set_.rules_.push_back(rule);
+            return true;
+        }
+
+    private:
+        using Op = RuleSet::Op;
+
+        void Advance() { tok_ = lex_.Next(); }
+        bool IsWord(const char* w) const { return tok_.kind == Token::Ident && tok_.text == w; }
+
+        bool Fail(const std::string& msg) {
+            if (error_.empty())
+                error_ = tok_.kind == Token::Bad ? tok_.text : msg;
+            return false;
+        }
+
+        bool Expect(const char* w) {
+            if (!IsWord(w)) return Fail(std::string("expected '") + w + "'");
+            Advance();
+            return true;
+        }
+
+        void Emit(Op op, size_t arg, int stackDelta) {
+            set_.code_.push_back({ op, static_cast<uint16_t>(arg) });
+            depth_ += stackDelta;
+            maxDepth_ = std::max(maxDepth_, static_cast<size_t>(depth_));
+        }
+
+        void Constant(double v) {
+            set_.consts_.push_back(v);
+            Emit(Op::Const, set_.consts_.size() - 1, +1);
+        }
+
+        void LoadFact(Fact kind, const std::string& arg = {}) {
+            auto& facts = set_.facts_;
+            auto it = std::find_if(facts.begin(), facts.end(),
+                [&](const FactKey& f) { return f.kind == kind && f.arg == arg; });
+            const size_t id = it - facts.begin();
+            if (it == facts.end()) {
+                facts.push_back({ kind, arg });
+                set_.values_.push_back(0);
+                set_.kinds_ |= 1u << static_cast<int>(kind);
+            }
+            deps_ |= 1ull << std::min<size_t>(id, 63);
+            Emit(Op::Load, id, +1);
+        }
+
+        bool Or() {
+            if (!And()) return false;
+            while (IsWord("or")) {
+                Advance();
+                if (!And()) return false;
+                Emit(Op::Or, 0, -1);
+            }
+            return true;
+        }
+
+        bool And() {
+            if (!Unary()) return false;
+            while (IsWord("and")) {
+                Advance();
+                if (!Unary()) return false;
+                Emit(Op::And, 0, -1);
+            }
+            return true;
+        }
+
+        bool Unary() {
+            if (IsWord("not")) {
+                Advance();
+                if (!Unary()) return false;
+                Emit(Op::Not, 0, 0);
+                return true;
+            }
+            if (!Compare()) return false;
+            if (IsWord("for")) {
+                Advance();
+                double ms = tok_.value;
+                if (tok_.kind != Token::Number || !ApplyUnit(tok_.text, ms))
+                    return Fail("expected a duration after 'for'");
+                Advance();
+                set_.timers_.push_back({ ms });
+                Emit(Op::Sustain, set_.timers_.size() - 1, 0);
+            }
+            return true;
+        }
+
+        bool Compare() {
+            // game == "x.exe" is a fact of its own rather than a string compare.
+            if (IsWord("game")) {
+                Advance();
+                if (tok_.kind != Token::Compare || (tok_.text != "==" && tok_.text != "!="))
+                    return Fail("'game' compares with == or != only");
+                const bool negate = tok_.text == "!=";
+                Advance();
+                if (tok_.kind != Token::String) return Fail("expected a quoted exe name");
+                LoadFact(Fact::Game, tok_.text);
+                Advance();
+                if (negate) Emit(Op::Not, 0, 0);
+                return true;
+            }
+
+            if (!Primary()) return false;
+            if (tok_.kind == Token::Compare) {
+                const std::string op = tok_.text;
+                Advance();
+                if (!Primary()) return false;
+                Emit(op == "<" ? Op::Lt : op == "<=" ? Op::Le : op == ">" ? Op::Gt
+                    : op == ">=" ? Op::Ge : op == "==" ? Op::Eq : Op::Ne, 0, -1);
+            }
+            else if (IsWord("between")) {
+                Advance();
+                if (!Primary() || !Expect("and") || !Primary()) return false;
+                Emit(Op::Between, 0, -2);
+            }
+            return true;
+        }
+
+        bool Primary() {
+            switch (tok_.kind) {
+            case Token::Number: {
+                double v = tok_.value;
+                if (!ApplyUnit(tok_.text, v)) return Fail("unknown unit '" + tok_.text + "'");
+                Advance();
+                Constant(v);
+                return true;
+            }
+            case Token::LParen:
+                Advance();
+                if (!Or()) return false;
+                if (tok_.kind != Token::RParen) return Fail("expected ')'");
+                Advance();
+                return true;
+            case Token::Ident: {
+                const std::string name = tok_.text;
+                Advance();
+                if (name == "true" || name == "false") {
+                    Constant(name == "true");
+                    return true;
+                }
+                if (name == "running") {
+                    if (tok_.kind != Token::LParen) return Fail("expected '(' after running");
+                    Advance();
+                    if (tok_.kind != Token::String) return Fail("expected a quoted exe name");
+                    const std::string exe = tok_.text;
+                    Advance();
+                    if (tok_.kind != Token::RParen) return Fail("expected ')'");
+                    Advance();
+                    LoadFact(Fact::Running, exe);
+                    return true;
+                }
+                Fact kind;
+                if (!NamedFact(name, kind)) return Fail("unknown fact '" + name + "'");
+                LoadFact(kind);
+                return true;
+            }
+            default:
+                return Fail("expected a value");
+            }
+        }
+
+        RuleSet&    set_;
+        Lexer       lex_;
+        Token       tok_;
+        int         depth_ = 0;
+        size_t      maxDepth_ = 0;
+        uint64_t    deps_ = 0;
+        std::string error_;
+    };
+
+    RuleSet RuleSet::Compile(const std::string& source, std::vector<std::string>& errors) {
+        RuleSet set;
+        std::istringstream in(source);
+        int lineNo = 0;
+        for (std::string line; std::getline(in, line);) {
+            ++lineNo;
+            // Comments run to the end of the line unless inside quotes.
+            bool quoted = false;
+            for (size_t i = 0; i < line.size(); ++i) {
+                if (line[i] == '"') quoted = !quoted;
+                else if (line[i] == '#' && !quoted) { line.resize(i); break; }
+            }
+            if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+            std::string error;
+            if (!Parser(set, line).Rule(lineNo, error))
+                errors.push_back("line " + std::to_string(lineNo) + ": " + error);
+        }
+        return set;
+    }
+
+    // ------------------------------------------------------------
+    // Evaluation
+    // ------------------------------------------------------------
+
+    void RuleSet::Set(size_t factId, double value) {
+        if (values_[factId] == value) return;
+        values_[factId] = value;
+        dirty_ |= 1ull << std::min<size_t>(factId, 63);
+    }
+
+    RuleSet::Decision RuleSet::Evaluate(uint64_t nowMs) {
+        Decision d;
+        lastEvaluated_ = 0;
+        for (auto& rule : rules_) {
+            if (!rule.evaluated || rule.timerPending || (rule.deps & dirty_)) {
+                rule.result = Run(rule, nowMs);
+                rule.evaluated = true;
+                ++lastEvaluated_;
+            }
+            if (d.allow && rule.result == rule.deny) {
+                d.allow = false;
+                d.line = rule.line;
+            }
+        }
+        dirty_ = 0;
+        return d;
+    }
+
+    bool RuleSet::Run(Rule& rule, uint64_t nowMs) {
+        double stack[MaxStack];
+        size_t sp = 0;
+        rule.timerPending = false;
+
+        for (uint32_t pc = rule.begin; pc < rule.end; ++pc) {
+            const Instr in = code_[pc];
+            switch (in.op) {
+            case Op::Const: stack[sp++] = consts_[in.arg]; break;
+            case Op::Load:  stack[sp++] = values_[in.arg]; break;
+            case Op::Not:   stack[sp - 1] = stack[sp - 1] == 0; break;
+            case Op::And:   --sp; stack[sp - 1] = stack[sp - 1] != 0 && stack[sp] != 0; break;
+            case Op::Or:    --sp; stack[sp - 1] = stack[sp - 1] != 0 || stack[sp] != 0; break;
+            case Op::Lt:    --sp; stack[sp - 1] = stack[sp - 1] < stack[sp]; break;
+            case Op::Le:    --sp; stack[sp - 1] = stack[sp - 1] <= stack[sp]; break;
+            case Op::Gt:    --sp; stack[sp - 1] = stack[sp - 1] > stack[sp]; break;
+            case Op::Ge:    --sp; stack[sp - 1] = stack[sp - 1] >= stack[sp]; break;
+            case Op::Eq:    --sp; stack[sp - 1] = stack[sp - 1] == stack[sp]; break;
+            case Op::Ne:    --sp; stack[sp - 1] = stack[sp - 1] != stack[sp]; break;
+            case Op::Between: {
+                // Half-open; a range like 22:00..06:00 wraps past midnight.
+                sp -= 2;
+                const double v = stack[sp - 1], lo = stack[sp], hi = stack[sp + 1];
+                stack[sp - 1] = lo <= hi ? (v >= lo && v < hi) : (v >= lo || v < hi);
+            } break;
+            case Op::Sustain: {
+                Timer& t = timers_[in.arg];
+                if (stack[sp - 1] == 0) {
+                    t.holding = false;
+                    break;
+                }
+                if (!t.holding) {
+                    t.holding = true;
+                    t.since = nowMs;
+                }
+                const bool held = nowMs - t.since >= t.durationMs;
+                rule.timerPending |= !held;
+                stack[sp - 1] = held;
+            } break;
+            }
+        }
+        return sp && stack[0] != 0;
+    }
+
+} // namespace Rules
@@ -0,0 +1,107 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ============================================================
+// BOOST RULES
+// ============================================================
+//
+// Conditions that gate Game Mode beyond "the foreground exe is listed".
+// One rule per line:
+//
+//     allow when ac_power and free_ram < 4gb
+//     allow when running("obs64.exe") or game == "cs2.exe"
+//     deny  when time between 09:00 and 18:00
+//     allow when game_cpu > 50 for 5s
+//
+// Starting a boost needs every `allow` rule to hold and no `deny` rule to
+// hold; a session under way runs until the game leaves the foreground.
+// Rules compile once to stack bytecode. The engine caches fact values and
+// only re-runs rules whose facts changed since the previous tick.
+
+namespace Rules {
+
+    enum class Fact : uint8_t {
+        AcPower,        // 1 on mains power
+        Battery,        // percent, 100 without a battery
+        FreeRam,        // MB available
+        Time,           // local minutes since midnight
+        Weekday,        // 0 = Sunday
+        GameCpu,        // percent of machine capacity used by the candidate game
+        Running,        // running("x.exe"): 1 while such a process exists
+        Game,           // game == "x.exe": 1 when x.exe is the candidate game
+        Count
+    };
+
+    struct FactKey {
+        Fact        kind;
+        std::string arg;    // lower-case exe for Running/Game
+    };
+
+    class RuleSet {
+    public:
+        struct Decision {
+            bool allow = true;
+            int  line = 0;      // rule that blocked, 0 when allowed
+        };
+
+        // Bad lines are skipped and described ("line N: ...") in `errors`.
+        static RuleSet Compile(const std::string& source, std::vector<std::string>& errors);
+
+        bool   Empty() const { return rules_.empty(); }
+        size_t Size() const { return rules_.size(); }
+
+        // Fact ids are indices into Facts().
+        const std::vector<FactKey>& Facts() const { return facts_; }
+        bool Uses(Fact kind) const { return (kinds_ >> static_cast<int>(kind)) & 1; }
+        void Set(size_t factId, double value);
+
+        Decision Evaluate(uint64_t nowMs);
+
+        // Rules actually re-run by the last Evaluate().
+        size_t LastEvaluated() const { return lastEvaluated_; }
+
+    private:
+        enum class Op : uint8_t {
+            Const, Load, Not, And, Or, Lt, Le, Gt, Ge, Eq, Ne, Between, Sustain
+        };
+        struct Instr {
+            Op       op;
+            uint16_t arg;   // constant, fact or timer index
+        };
+        struct Rule {
+            bool     deny = false;
+            int      line = 0;
+            uint32_t begin = 0, end = 0;
+            uint64_t deps = 0;      // fact bits; bit 63 stands for ids >= 63
+            bool     evaluated = false;
+            bool     timerPending = false;
+            bool     result = false;
+        };
+        struct Timer {
+            double   durationMs = 0;
+            uint64_t since = 0;
+            bool     holding = false;
+        };
+
+        static constexpr size_t MaxStack = 32;
+
+        bool Run(Rule& rule, uint64_t nowMs);
+
+        friend class Parser;
+
+        std::vector<Rule>    rules_;
+        std::vector<Instr>   code_;
+        std::vector<double>  consts_;
+        std::vector<Timer>   timers_;
+        std::vector<FactKey> facts_;
+        std::vector<double>  values_;
+        uint32_t             kinds_ = 0;
+        uint64_t             dirty_ = ~0ull;
+        size_t               lastEvaluated_ = 0;
+    };
+
+} // namespace Rules
@@ -0,0 +1,335 @@
+﻿#define _CRT_SECURE_NO_WARNINGS
+#define NOMINMAX
+
+// winsock2.h has to precede windows.h.
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+
+#include "Telemetry.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+
+#pragma comment(lib, "ws2_32.lib")
+
+namespace Telemetry {
+
+    // ------------------------------------------------------------
+    // Histogram
+    // ------------------------------------------------------------
+
+    Histogram::Histogram(std::initializer_list<double> bounds) {
+        for (double b : bounds) {
+            if (count_ == MaxBounds) break;
+            bounds_[count_++] = b;
+        }
+    }
+
+    void Histogram::Observe(double seconds) {
+        size_t i = 0;
+        while (i < count_ && seconds > bounds_[i]) ++i;
+        buckets_[i].fetch_add(1, std::memory_order_relaxed);
+        total_.fetch_add(1, std::memory_order_relaxed);
+        if (seconds > 0)
+            sumNs_.fetch_add(static_cast<uint64_t>(seconds * 1e9), std::memory_order_relaxed);
+    }
+
+    // ------------------------------------------------------------
+    // Exposition
+    // ------------------------------------------------------------
+
+    const char* ActionName(Action a) {
+        switch (a) {
+        case Action::Kill:          return "kill";
+        case Action::Relaunch:      return "relaunch";
+        case Action::Priority:      return "priority";
+        case Action::CpuSteering:   return "cpu_steering";
+        case Action::NumaPlacement: return "numa_placement";
+        case Action::Throttle:      return "throttle";
+        case Action::Trim:          return "trim";
+        case Action::Headroom:      return "headroom";
+        case Action::PowerQos:      return "power_qos";
+        default:                    return "unknown";
+        }
+    }
+
+    const char* OutcomeName(Outcome o) {
+        switch (o) {
+        case Outcome::Ok:      return "ok";
+        case Outcome::Failed:  return "failed";
+        case Outcome::Skipped: return "skipped";
+        default:               return "unknown";
+        }
+    }
+
+    namespace {
+
+        constexpr DWORD ClientTimeoutMs = 2000;     // per recv() and send()
+
+        // OpenMetrics wants canonical floats ("1.0", not "1") in labels.
+        std::string Number(double v) {
+            char buf[32];
+            snprintf(buf, sizeof(buf), "%.9g", v);
+            std::string s = buf;
+            if (s.find_first_of(".eEn") == std::string::npos) s += ".0";
+            return s;
+        }
+
+        void Type(std::string& out, const char* name, const char* type, const char* help) {
+            out += "# TYPE "; out += name; out += ' '; out += type; out += '\n';
+            out += "# HELP "; out += name; out += ' '; out += help; out += '\n';
+        }
+
+        void Sample(std::string& out, const char* name, const char* labels, uint64_t v) {
+            char buf[160];
+            snprintf(buf, sizeof(buf), "%s%s %" PRIu64 "\n", name, labels, v);
+            out += buf;
+        }
+
+        void Sample(std::string& out, const char* name, const char* labels, double v) {
+            out += name; out += labels; out += ' '; out += Number(v); out += '\n';
+        }
+
+        void Emit(std::string& out, const char* name, const char* help, const Histogram& h) {
+            Type(out, name, "histogram", help);
+            const std::string bucket = std::string(name) + "_bucket";
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i < h.BoundCount(); ++i) {
+                cumulative += h.Bucket(i);
+                const std::string le = "{le=\"" + Number(h.Bound(i)) + "\"}";
+                Sample(out, bucket.c_str(), le.c_str(), cumulative);
+            }
+            cumulative += h.Bucket(h.BoundCount());
+            Sample(out, bucket.c_str(), "{le=\"+Inf\"}", cumulative);
+            Sample(out, (std::string(name) + "_sum").c_str(), "", h.Sum());
+            Sample(out, (std::string(name) + "_count").c_str(), "", cumulative);
+        }
+
+    } // namespace
+
+    std::string Render(const Registry& reg) {
+        std::string out;
+        out.reserve(4096);
+
+        Type(out, "booster_transitions", "counter", "Game Mode transitions.");
+        Sample(out, "booster_transitions_total", "{direction=\"enter\"}", reg.transitionsEnter.Value());
+        Sample(out, "booster_transitions_total", "{direction=\"exit\"}", reg.transitionsExit.Value());
+
+        Type(out, "booster_actions", "counter", "Boost actions by outcome.");
+        for (size_t a = 0; a < static_cast<size_t>(Action::Count); ++a) {
+            for (size_t o = 0; o < static_cast<size_t>(Outcome::Count); ++o) {
+                char labels[96];
+                snprintf(labels, sizeof(labels), "{action=\"%s\",outcome=\"%s\"}",
+                    ActionName(static_cast<Action>(a)), OutcomeName(static_cast<Outcome>(o)));
+                Sample(out, "booster_actions_total", labels,
+                    reg.Actions(static_cast<Action>(a), static_cast<Outcome>(o)));
+            }
+        }
+
+        Type(out, "booster_processes_killed", "counter", "Background processes terminated.");
+        Sample(out, "booster_processes_killed_total", "", reg.processesKilled.Value());
+        Type(out, "booster_processes_relaunched", "counter", "Terminated processes relaunched on exit.");
+        Sample(out, "booster_processes_relaunched_total", "", reg.processesRelaunched.Value());
+        Type(out, "booster_monitor_ticks", "counter", "Monitor loop iterations.");
+        Sample(out, "booster_monitor_ticks_total", "", reg.monitorTicks.Value());
+
+        Type(out, "booster_game_mode_active", "gauge", "1 while Game Mode is active.");
+        Sample(out, "booster_game_mode_active", "", reg.gameModeActive.Value());
+        Type(out, "booster_games_monitored", "gauge", "Entries in the game list.");
+        Sample(out, "booster_games_monitored", "", reg.gamesMonitored.Value());
+        Type(out, "booster_processes_steered", "gauge", "Processes currently moved off the game's cores.");
+        Sample(out, "booster_processes_steered", "", reg.processesSteered.Value());
+        Type(out, "booster_game_cpu_share", "gauge", "Game CPU time over machine capacity, 0..1.");
+        Sample(out, "booster_game_cpu_share", "", reg.gameCpuShare.Value());
+        Type(out, "booster_detect_confidence", "gauge", "Detector confidence that the foreground process is a game.");
+        Sample(out, "booster_detect_confidence", "", reg.detectConfidence.Value());
+        Type(out, "booster_self_cpu_seconds", "counter", "CPU time used by the booster itself.");
+        Sample(out, "booster_self_cpu_seconds_total", "", reg.selfCpuSeconds.Value());
+        Type(out, "booster_self_cpu_share", "gauge", "The booster's CPU time over machine capacity, 0..1.");
+        Sample(out, "booster_self_cpu_share", "", reg.selfCpuShare.Value());
+        Type(out, "booster_self_resident_bytes", "gauge", "The booster's working set.");
+        Sample(out, "booster_self_resident_bytes", "", reg.selfResidentBytes.Value());
+        Type(out, "booster_pressure", "gauge", "Contention for each resource during a session, 0..1.");
+        Sample(out, "booster_pressure", "{resource=\"cpu\"}", reg.pressureCpu.Value());
+        Sample(out, "booster_pressure", "{resource=\"memory\"}", reg.pressureMemory.Value());
+        Sample(out, "booster_pressure", "{resource=\"io\"}", reg.pressureIo.Value());
+        Type(out, "booster_escalation_level", "gauge", "Escalation steps taken beyond the initial boost.");
+        Sample(out, "booster_escalation_level", "", reg.escalationLevel.Value());
+        Type(out, "booster_recovery_seconds", "gauge", "Time startup took to undo a crashed session.");
+        Sample(out, "booster_recovery_seconds", "", reg.recoverySeconds.Value());
+        Type(out, "booster_headroom_free_bytes", "gauge", "Free memory left ahead of the game at activation.");
+        Sample(out, "booster_headroom_free_bytes", "", reg.headroomFreeBytes.Value());
+        Type(out, "booster_headroom_target_bytes", "gauge", "Free memory activation aimed for.");
+        Sample(out, "booster_headroom_target_bytes", "", reg.headroomTargetBytes.Value());
+        Type(out, "booster_game_load_hard_faults", "gauge", "Hard page faults the game took while loading.");
+        Sample(out, "booster_game_load_hard_faults", "", reg.gameLoadHardFaults.Value());
+        Type(out, "booster_idle_residency", "gauge", "Share of processor time in each idle state, 0..1.");
+        for (size_t m = 0; m < 2; ++m) {
+            for (size_t c = 0; c < 3; ++c) {
+                char labels[48];
+                snprintf(labels, sizeof(labels), "{session=\"%s\",state=\"c%zu\"}",
+                    m ? "boosted" : "idle", c + 1);
+                Sample(out, "booster_idle_residency", labels, reg.idleResidency[m][c].Value());
+            }
+        }
+
+        Emit(out, "booster_monitor_tick_seconds", "Monitor tick cost.", reg.tickSeconds);
+        Emit(out, "booster_enter_seconds", "Game Mode activation latency.", reg.enterSeconds);
+        Emit(out, "booster_exit_seconds", "Game Mode restoration latency.", reg.exitSeconds);
+
+        out += "# EOF\n";
+        return out;
+    }
+
+    bool WriteTextfile(const Registry& reg, const std::string& path) {
+        const std::string tmp = path + ".tmp";
+        {
+            std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+            if (!file) return false;
+            file << Render(reg);
+            if (!file) return false;
+        }
+        return MoveFileExA(tmp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != FALSE;
+    }
+
+    // ------------------------------------------------------------
+    // Exporter
+    // ------------------------------------------------------------
+
+    Exporter::~Exporter() {
+        Stop();
+    }
+
+    bool Exporter::Start(const Options& opts) {
+        if (running_) return true;
+        opts_ = opts;
+        running_ = true;
+
+        if (opts_.port) {
+            WSADATA wsa;
+            if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+                running_ = false;
+                return false;
+            }
+            SOCKET s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(opts_.port);
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            if (s == INVALID_SOCKET
+                || bind(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+                || listen(s, SOMAXCONN) != 0) {
+                if (s != INVALID_SOCKET) closesocket(s);
+                WSACleanup();
+                running_ = false;
+                return false;
+            }
+            listener_ = static_cast<uintptr_t>(s);
+            http_ = std::thread([this] { ServeLoop(); });
+        }
+        if (!opts_.textfile.empty()) {
+            wakeEvent_ = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+            textfile_ = std::thread([this] { TextfileLoop(); });
+        }
+        return true;
+    }
+
+    void Exporter::Stop() {
+        if (!running_) return;
+        running_ = false;
+        if (http_.joinable()) {
+            // Closing the listener fails the pending accept(); shutting the
+            // client down ends a recv() or send() in progress.
+            closesocket(static_cast<SOCKET>(listener_));
+            {
+                std::lock_guard lock(clientMutex_);
+                if (client_ != ~static_cast<uintptr_t>(0))
+                    shutdown(static_cast<SOCKET>(client_), SD_BOTH);
+            }
+            http_.join();
+            WSACleanup();
+        }
+        if (textfile_.joinable()) {
+            SetEvent(wakeEvent_);
+            textfile_.join();
+            CloseHandle(wakeEvent_);
+            wakeEvent_ = nullptr;
+        }
+    }
+
+    void Exporter::ServeLoop() {
+        const SOCKET listener = static_cast<SOCKET>(listener_);
+        char req[2048];
+        DWORD backoffMs = 0;
+        while (running_) {
+            SOCKET c = accept(listener, nullptr, nullptr);
+            if (c == INVALID_SOCKET) {
+                // Out of sockets or memory will not clear by retrying at once.
+                if (!running_) break;
+                backoffMs = std::min<DWORD>(backoffMs ? backoffMs * 2 : 10, 1000);
+                Sleep(backoffMs);
+                continue;
+            }
+            backoffMs = 0;
+            // A client that connects and goes quiet must not hold the loop.
+            const DWORD timeoutMs = ClientTimeoutMs;
+            setsockopt(c, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeoutMs), sizeof(timeoutMs));
+            setsockopt(c, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeoutMs), sizeof(timeoutMs));
+            {
+                std::lock_guard lock(clientMutex_);
+                if (!running_) {
+                    closesocket(c);
+                    break;
+                }
+                client_ = static_cast<uintptr_t>(c);
+            }
+
+            // Only the request line matters; stop at the end of headers.
+            int len = 0;
+            while (len < static_cast<int>(sizeof(req)) - 1) {
+                const int n = recv(c, req + len, static_cast<int>(sizeof(req)) - 1 - len, 0);
+                if (n <= 0) break;
+                len += n;
+                req[len] = 0;
+                if (strstr(req, "\r\n\r\n")) break;
+            }
+            req[len] = 0;
+
+            std::string resp;
+            if (strncmp(req, "GET /metrics", 12) == 0
+                && (req[12] == ' ' || req[12] == '?')) {
+                const std::string body = Render(reg_);
+                resp = "HTTP/1.1 200 OK\r\n"
+                    "Content-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"
+                    "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                    "Connection: close\r\n\r\n" + body;
+            }
+            else {
+                resp = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+            }
+            for (size_t sent = 0; sent < resp.size();) {
+                const int n = send(c, resp.data() + sent,
+                    static_cast<int>(resp.size() - sent), 0);
+                if (n <= 0) break;
+                sent += n;
+            }
+            shutdown(c, SD_SEND);
+            {
+                std::lock_guard lock(clientMutex_);
+                client_ = ~static_cast<uintptr_t>(0);
+            }
+            closesocket(c);
+        }
+    }
+
+    void Exporter::TextfileLoop() {
+        do {
+            WriteTextfile(reg_, opts_.textfile);
+        } while (WaitForSingleObject(wakeEvent_, opts_.textfileIntervalMs) == WAIT_TIMEOUT);
+        WriteTextfile(reg_, opts_.textfile);
+    }
+
+} // namespace Telemetry
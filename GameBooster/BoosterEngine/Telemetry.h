@@ -0,0 +1,146 @@
+﻿#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// ============================================================
+// TELEMETRY
+// ============================================================
+//
+// Counters, gauges and histograms the engine updates on its hot paths.
+// Updates are single relaxed atomic operations; readers (the exporter)
+// may see a histogram mid-update, which OpenMetrics scrapes tolerate.
+
+namespace Telemetry {
+
+    class Counter {
+    public:
+        void Add(uint64_t n = 1) { v_.fetch_add(n, std::memory_order_relaxed); }
+        uint64_t Value() const { return v_.load(std::memory_order_relaxed); }
+    private:
+        std::atomic<uint64_t> v_{ 0 };
+    };
+
+    class Gauge {
+    public:
+        void Set(double v) {
+            uint64_t bits;
+            std::memcpy(&bits, &v, sizeof(bits));
+            bits_.store(bits, std::memory_order_relaxed);
+        }
+        double Value() const {
+            const uint64_t bits = bits_.load(std::memory_order_relaxed);
+            double v;
+            std::memcpy(&v, &bits, sizeof(v));
+            return v;
+        }
+    private:
+        std::atomic<uint64_t> bits_{ 0 };
+    };
+
+    class Histogram {
+    public:
+        static constexpr size_t MaxBounds = 16;
+
+        // Upper bounds in seconds, ascending; +Inf is implicit.
+        Histogram(std::initializer_list<double> bounds);
+
+        void Observe(double seconds);
+
+        size_t BoundCount() const { return count_; }
+        double Bound(size_t i) const { return bounds_[i]; }
+        uint64_t Bucket(size_t i) const { return buckets_[i].load(std::memory_order_relaxed); }
+        uint64_t Count() const { return total_.load(std::memory_order_relaxed); }
+        double Sum() const { return sumNs_.load(std::memory_order_relaxed) / 1e9; }
+
+    private:
+        std::array<double, MaxBounds> bounds_{};
+        size_t count_ = 0;
+        std::array<std::atomic<uint64_t>, MaxBounds + 1> buckets_{};
+        std::atomic<uint64_t> total_{ 0 };
+        std::atomic<uint64_t> sumNs_{ 0 };
+    };
+
+    enum class Action : uint8_t {
+        Kill, Relaunch, Priority, CpuSteering, NumaPlacement, Throttle, Trim, Headroom, PowerQos, Count
+    };
+    enum class Outcome : uint8_t { Ok, Failed, Skipped, Count };
+
+    const char* ActionName(Action a);
+    const char* OutcomeName(Outcome o);
+
+    // Everything the booster exports. One instance per engine.
+    struct Registry {
+        Counter transitionsEnter, transitionsExit;
+        Counter processesKilled, processesRelaunched;
+        Counter monitorTicks;
+        Gauge   gameModeActive, gamesMonitored, processesSteered;
+        Gauge   gameCpuShare;
+        Gauge   detectConfidence;
+        Gauge   selfCpuSeconds, selfCpuShare, selfResidentBytes;
+        Gauge   pressureCpu, pressureMemory, pressureIo, escalationLevel;
+        Gauge   recoverySeconds;
+        Gauge   headroomFreeBytes, headroomTargetBytes, gameLoadHardFaults;
+        Gauge   idleResidency[2][3];    // [outside, during the last session][C1..C3]
+
+        Histogram tickSeconds{ 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25 };
+        Histogram enterSeconds{ 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10 };
+        Histogram exitSeconds{ 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30 };
+
+        void Record(Action a, Outcome o) {
+            actions_[static_cast<size_t>(a)][static_cast<size_t>(o)].Add();
+        }
+        uint64_t Actions(Action a, Outcome o) const {
+            return actions_[static_cast<size_t>(a)][static_cast<size_t>(o)].Value();
+        }
+
+    private:
+        std::array<std::array<Counter, static_cast<size_t>(Outcome::Count)>,
+            static_cast<size_t>(Action::Count)> actions_;
+    };
+
+    // OpenMetrics text exposition, terminated by "# EOF".
+    std::string Render(const Registry& reg);
+
+    // Writes atomically (temp file + rename) for textfile collectors.
+    bool WriteTextfile(const Registry& reg, const std::string& path);
+
+    // Serves GET /metrics on 127.0.0.1 and/or refreshes a textfile.
+    class Exporter {
+    public:
+        struct Options {
+            uint16_t    port = 0;           // 0 disables the HTTP listener
+            std::string textfile;           // empty disables the textfile
+            uint32_t    textfileIntervalMs = 15000;
+        };
+
+        explicit Exporter(const Registry& reg) : reg_(reg) {}
+        ~Exporter();
+
+        Exporter(const Exporter&) = delete;
+        Exporter& operator=(const Exporter&) = delete;
+
+        bool Start(const Options& opts);
+        void Stop();
+
+    private:
+        void ServeLoop();
+        void TextfileLoop();
+
+        const Registry&   reg_;
+        Options           opts_;
+        std::atomic<bool> running_{ false };
+        uintptr_t         listener_ = ~static_cast<uintptr_t>(0);
+        std::mutex        clientMutex_;
+        uintptr_t         client_ = ~static_cast<uintptr_t>(0);   // being served
+        void*             wakeEvent_ = nullptr;
+        std::thread       http_, textfile_;
+    };
+
+} // namespace Telemetry
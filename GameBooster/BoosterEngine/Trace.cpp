@@ -0,0 +1,242 @@
+﻿#define _CRT_SECURE_NO_WARNINGS
+#define NOMINMAX
+
+#include "Trace.h"
+
+#include <windows.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Trace {
+
+    namespace {
+
+        struct Event {
+            const char* name;
+            const char* category;
+            uint64_t    tsNs;
+            char        phase;
+            char        arg[MaxArg];
+        };
+
+        // Slot sequence: odd while the owner is writing event i (2i + 1),
+        // 2i + 2 once it is complete.
+        struct Slot {
+            std::atomic<uint64_t> seq{ 0 };
+            Event                 event{};
+        };
+
+        // tid, name, start and free belong to whoever holds RegistryMutex();
+        // the slots to the owning thread.
+        struct Buffer {
+            DWORD                 tid = 0;
+            char                  name[32]{};
+            uint64_t              start = 0;    // first event of the current owner
+            bool                  free = false; // owner has exited
+            std::atomic<uint64_t> head{ 0 };
+            std::array<Slot, BufferEvents> slots;
+        };
+
+        // Buffers are never freed, so a flush can still read a thread that
+        // has exited; its buffer goes to the next thread that starts
+        // tracing. There are as many as threads ever tracing at once, not
+        // as many as ever traced (a client connection each, in the daemon).
+        std::mutex& RegistryMutex() {
+            static auto* m = new std::mutex;
+            return *m;
+        }
+
+        std::vector<Buffer*>& Registry() {
+            static auto* v = new std::vector<Buffer*>;
+            return *v;
+        }
+
+        thread_local Buffer* t_buffer = nullptr;
+
+        // Hands the thread's buffer back when the thread exits. Kept apart
+        // from t_buffer, which must stay usable by later destructors.
+        struct Release {
+            bool armed = false;
+            ~Release() {
+                if (!armed || !t_buffer) return;
+                std::lock_guard lock(RegistryMutex());
+                t_buffer->free = true;
+                t_buffer = nullptr;
+            }
+        };
+        thread_local Release t_release;
+
+        const std::chrono::steady_clock::time_point g_epoch = std::chrono::steady_clock::now();
+
+        Buffer& Local() {
+            if (!t_buffer) {
+                std::lock_guard lock(RegistryMutex());
+                auto& registry = Registry();
+                const auto it = std::find_if(registry.begin(), registry.end(),
+                    [](const Buffer* b) { return b->free; });
+                Buffer* b = it != registry.end() ? *it : registry.emplace_back(new Buffer);
+                b->tid = GetCurrentThreadId();
+                b->name[0] = 0;
+                b->start = b->head.load(std::memory_order_relaxed);
+                b->free = false;
+                t_buffer = b;
+                t_release.armed = true;
+            }
+            return *t_buffer;
+        }
+
+        void Record(char phase, const char* name, const char* category, const char* arg) {
+            Buffer& b = Local();
+            const uint64_t i = b.head.load(std::memory_order_relaxed);
+            Slot& slot = b.slots[i % BufferEvents];
+
+            slot.seq.store(2 * i + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.event.name = name;
+            slot.event.category = category;
+            slot.event.tsNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - g_epoch).count());
+            slot.event.phase = phase;
+            if (arg) {
+                strncpy(slot.event.arg, arg, MaxArg - 1);
+                slot.event.arg[MaxArg - 1] = 0;
+            }
+            else {
+                slot.event.arg[0] = 0;
+            }
+            slot.seq.store(2 * i + 2, std::memory_order_release);
+            b.head.store(i + 1, std::memory_order_release);
+        }
+
+        // Events of one buffer from `start` on that were stable while being
+        // copied.
+        std::vector<Event> Snapshot(const Buffer& b, uint64_t start) {
+            std::vector<Event> out;
+            const uint64_t head = b.head.load(std::memory_order_acquire);
+            const uint64_t first = std::max(start, head > BufferEvents ? head - BufferEvents : 0);
+            out.reserve(static_cast<size_t>(head - first));
+            for (uint64_t i = first; i < head; ++i) {
+                const Slot& slot = b.slots[i % BufferEvents];
+                if (slot.seq.load(std::memory_order_acquire) != 2 * i + 2) continue;
+                Event e;
+                std::memcpy(&e, &slot.event, sizeof(e));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.seq.load(std::memory_order_relaxed) != 2 * i + 2) continue;
+                out.push_back(e);
+            }
+            return out;
+        }
+
+        void Escaped(std::string& out, const char* s) {
+            for (; *s; ++s) {
+                const unsigned char c = static_cast<unsigned char>(*s);
+                if (c == '"' || c == '\\') { out += '\\'; out += *s; }
+                else if (c < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                }
+                else out += *s;
+            }
+        }
+
+    } // namespace
+
+    void Begin(const char* name, const char* category, const char* arg) {
+        Record('B', name, category, arg);
+    }
+
+    void End(const char* name, const char* category) {
+        Record('E', name, category, nullptr);
+    }
+
+    void NameThread(const char* name) {
+        Buffer& b = Local();
+        std::lock_guard lock(RegistryMutex());
+        strncpy(b.name, name, sizeof(b.name) - 1);
+    }
+
+    std::string ChromeJson() {
+        // Owners as of now; a thread taking over a buffer during the read
+        // may show its first events under the previous owner.
+        struct Owner {
+            const Buffer* buffer;
+            DWORD         tid;
+            std::string   name;
+            uint64_t      start;
+        };
+        std::vector<Owner> owners;
+        {
+            std::lock_guard lock(RegistryMutex());
+            for (const Buffer* b : Registry())
+                owners.push_back({ b, b->tid, b->name, b->start });
+        }
+        const DWORD pid = GetCurrentProcessId();
+
+        std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        char line[160];
+        snprintf(line, sizeof(line),
+            "{\"ph\":\"M\",\"pid\":%lu,\"name\":\"process_name\",\"args\":{\"name\":\"GameBooster\"}}",
+            static_cast<unsigned long>(pid));
+        out += line;
+
+        for (const Owner& o : owners) {
+            if (!o.name.empty()) {
+                snprintf(line, sizeof(line),
+                    ",\n{\"ph\":\"M\",\"pid\":%lu,\"tid\":%lu,\"name\":\"thread_name\",\"args\":{\"name\":\"",
+                    static_cast<unsigned long>(pid), static_cast<unsigned long>(o.tid));
+                out += line;
+                Escaped(out, o.name.c_str());
+                out += "\"}}";
+            }
+
+            // The ring may have dropped the begin of the oldest spans;
+            // their ends would close unrelated spans in the viewer.
+            int depth = 0;
+            for (const Event& e : Snapshot(*o.buffer, o.start)) {
+                if (e.phase == 'E') {
+                    if (depth == 0) continue;
+                    --depth;
+                }
+                else {
+                    ++depth;
+                }
+                snprintf(line, sizeof(line),
+                    ",\n{\"ph\":\"%c\",\"pid\":%lu,\"tid\":%lu,\"ts\":%.3f,\"cat\":\"",
+                    e.phase, static_cast<unsigned long>(pid), static_cast<unsigned long>(o.tid),
+                    e.tsNs / 1000.0);
+                out += line;
+                Escaped(out, e.category);
+                out += "\",\"name\":\"";
+                Escaped(out, e.name);
+                out += '"';
+                if (e.arg[0]) {
+                    out += ",\"args\":{\"target\":\"";
+                    Escaped(out, e.arg);
+                    out += "\"}";
+                }
+                out += '}';
+            }
+        }
+        out += "\n]}\n";
+        return out;
+    }
+
+    bool WriteChromeJson(const std::string& path) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        file << ChromeJson();
+        return static_cast<bool>(file);
+    }
+
+} // namespace Trace
@@ -0,0 +1,47 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <string>
+
+// ============================================================
+// TRACE RECORDER
+// ============================================================
+//
+// Begin/end spans recorded into per-thread ring buffers. Recording is
+// lock-free: each thread only ever writes its own buffer, and readers
+// validate every slot with a sequence number instead of stopping the
+// writer. The newest `BufferEvents` events per thread are kept, and an
+// exited thread's events until another thread takes over its buffer.
+
+namespace Trace {
+
+    constexpr size_t BufferEvents = 4096;
+    constexpr size_t MaxArg = 48;
+
+    // `name` and `category` must outlive the process (string literals);
+    // `arg` is copied and truncated to MaxArg - 1 characters.
+    void Begin(const char* name, const char* category, const char* arg = nullptr);
+    void End(const char* name, const char* category);
+
+    // Labels the calling thread in the trace viewer.
+    void NameThread(const char* name);
+
+    class Scope {
+    public:
+        Scope(const char* name, const char* category, const char* arg = nullptr)
+            : name_(name), category_(category) { Begin(name, category, arg); }
+        ~Scope() { End(name_, category_); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* name_;
+        const char* category_;
+    };
+
+    // Chrome trace event format; opens in chrome://tracing and Perfetto.
+    std::string ChromeJson();
+    bool WriteChromeJson(const std::string& path);
+
+} // namespace Trace
@@ -0,0 +1,264 @@
+﻿#define NOMINMAX
+
+#include "CpuSteering.h"
+#include "Test.h"
+
+#include <algorithm>
+
+using CpuSteering::ProcessInfo;
+
+namespace {
+
+    // A hybrid part: six hyper-threaded P-cores (processors 0-11) and
+    // eight E-cores (12-19).
+    constexpr DWORD_PTR PCores = 0x00FFF;
+    constexpr DWORD_PTR ECores = 0xFF000;
+    constexpr DWORD_PTR AllCores = PCores | ECores;
+
+    struct FakeProcess {
+        ProcessInfo info;
+        DWORD_PTR   mask = AllCores;
+        bool        locked = false;     // SetAffinity refused, as for protected processes
+    };
+
+    // A process table in memory. Processes are matched by pid and start
+    // time, as the real backend does.
+    class FakeBackend final : public CpuSteering::Backend {
+    public:
+        std::vector<FakeProcess> procs;
+        int reads = 0, sets = 0;
+
+        FakeProcess& Add(DWORD pid, const char* exe, DWORD_PTR mask = AllCores, ULONGLONG start = 1) {
+            procs.push_back({ { pid, start, exe }, mask });
+            return procs.back();
+        }
+
+        void Remove(DWORD pid) {
+            procs.erase(std::remove_if(procs.begin(), procs.end(),
+                [pid](const FakeProcess& p) { return p.info.pid == pid; }), procs.end());
+        }
+
+        DWORD_PTR MaskOf(DWORD pid) const {
+            for (const auto& p : procs)
+                if (p.info.pid == pid) return p.mask;
+            return 0;
+        }
+
+        DWORD_PTR SystemMask() override { return AllCores; }
+
+        void Enumerate(std::vector<ProcessInfo>& out) override {
+            out.clear();
+            for (const auto& p : procs) out.push_back(p.info);
+        }
+
+        bool GetAffinity(const ProcessInfo& p, DWORD_PTR& mask) override {
+            ++reads;
+            const FakeProcess* f = Find(p);
+            if (!f) return false;
+            mask = f->mask;
+            return true;
+        }
+
+        bool SetAffinity(const ProcessInfo& p, DWORD_PTR mask) override {
+            FakeProcess* f = Find(p);
+            if (!f || f->locked) return false;
+            f->mask = mask;
+            ++sets;
+            return true;
+        }
+
+    private:
+        FakeProcess* Find(const ProcessInfo& p) {
+            for (auto& f : procs)
+                if (f.info.pid == p.pid && f.info.startTime == p.startTime) return &f;
+            return nullptr;
+        }
+    };
+
+    // Where Steer() should leave a background process that had `original`.
+    DWORD_PTR Steered(DWORD_PTR original, const CpuSteering::Steering& s) {
+        if (!(original & s.GameMask())) return original;
+        const DWORD_PTR kept = original & s.BackgroundMask();
+        return kept ? kept : s.BackgroundMask();
+    }
+
+    // A desktop on the hybrid part, with processes already confined to
+    // one core type by their owners.
+    void Populate(FakeBackend& b) {
+        b.Add(4, "System");
+        b.Add(100, "Game.exe");
+        b.Add(200, "service.exe");
+        b.Add(300, "indexer.exe", ECores);
+        b.Add(400, "encoder.exe", PCores);
+        b.Add(500, "dwm.exe");
+        b.Add(600, "pinned.exe", 0x80000);     // the last E-core only
+    }
+
+} // namespace
+
+TEST_CASE(ReserveMaskTakesTheHighestAvailableProcessors) {
+    CHECK(CpuSteering::ReserveMask(AllCores, 4) == 0xF0000);
+    CHECK(CpuSteering::ReserveMask(AllCores, 0) == 0);
+    CHECK(CpuSteering::ReserveMask(AllCores, 64) == AllCores);
+    // Parked processors are skipped, not counted.
+    CHECK(CpuSteering::ReserveMask(0xB6, 3) == 0xB0);
+    CHECK(CpuSteering::CountBits(PCores) == 12);
+    CHECK(CpuSteering::CountBits(ECores) == 8);
+}
+
+TEST_CASE(SteeringSplitsTheHybridLayout) {
+    FakeBackend b;
+    Populate(b);
+    CpuSteering::Steering s(b);
+    CHECK(s.Apply("game.exe"));
+    CHECK(s.Active());
+
+    // Half the processors by default, disjoint from the rest.
+    CHECK(CpuSteering::CountBits(s.GameMask()) == 10);
+    CHECK((s.GameMask() & s.BackgroundMask()) == 0);
+    CHECK((s.GameMask() | s.BackgroundMask()) == AllCores);
+
+    CHECK(b.MaskOf(100) == s.GameMask());
+    CHECK(b.MaskOf(200) == Steered(AllCores, s));
+    CHECK(b.MaskOf(300) == Steered(ECores, s));
+    CHECK(b.MaskOf(400) == Steered(PCores, s));
+    CHECK(b.MaskOf(600) == Steered(0x80000, s));
+    CHECK((b.MaskOf(600) & s.GameMask()) == 0);
+    // Exempt by name, and the system process by pid.
+    CHECK(b.MaskOf(500) == AllCores);
+    CHECK(b.MaskOf(4) == AllCores);
+    CHECK(s.JournalSize() == 5);
+}
+
+TEST_CASE(SteeringHonoursReservedCoresAndMinimumBackground) {
+    FakeBackend b;
+    Populate(b);
+    CpuSteering::Options opts;
+    opts.reservedCores = 19;
+    opts.minBackgroundCores = 4;
+    CpuSteering::Steering s(b, opts);
+    CHECK(s.Apply("game.exe"));
+    CHECK(CpuSteering::CountBits(s.GameMask()) == 16);
+    CHECK(CpuSteering::CountBits(s.BackgroundMask()) == 4);
+
+    // Nothing left for the background: no steering at all.
+    FakeBackend small;
+    small.Add(100, "game.exe");
+    CpuSteering::Options tight;
+    tight.minBackgroundCores = 20;
+    CpuSteering::Steering none(small, tight);
+    CHECK(!none.Apply("game.exe"));
+    CHECK(!none.Active());
+    CHECK(small.sets == 0);
+}
+
+TEST_CASE(SteeringRefreshTakesOnlyNewProcesses) {
+    FakeBackend b;
+    Populate(b);
+    CpuSteering::Steering s(b);
+    s.Apply("game.exe");
+    const int sets = b.sets;
+    const size_t journaled = s.JournalSize();
+
+    // Nothing new: nothing opened, not even the processes left alone, and
+    // nothing touched, even a process that widened itself.
+    const int reads = b.reads;
+    b.procs[2].mask = AllCores;
+    s.Refresh();
+    s.Refresh();
+    CHECK(b.reads == reads);
+    CHECK(b.sets == sets);
+    CHECK(b.MaskOf(200) == AllCores);
+
+    // A late process, and a new one reusing an old pid.
+    b.Add(700, "updater.exe", ECores);
+    b.Remove(400);
+    b.Add(400, "encoder.exe", AllCores, 2);
+    s.Refresh();
+    CHECK(b.MaskOf(700) == Steered(ECores, s));
+    CHECK(b.MaskOf(400) == Steered(AllCores, s));
+    CHECK(s.JournalSize() == journaled + 2);
+    CHECK(b.reads == reads + 2);
+
+    // The next session looks at everything again.
+    s.Restore();
+    const int before = b.reads;
+    s.Apply("game.exe");
+    CHECK(b.reads > before);
+}
+
+TEST_CASE(SteeringRetriesChangesItsObserverVetoed) {
+    FakeBackend b;
+    Populate(b);
+    CpuSteering::Steering s(b);
+    bool writable = false;
+    s.SetObserver([&](const CpuSteering::JournalEntry&, bool) { return writable; });
+    s.Apply("game.exe");
+    CHECK(b.sets == 0);
+    CHECK(s.JournalSize() == 0);
+
+    writable = true;
+    s.Refresh();
+    CHECK(b.sets > 0);
+    CHECK(b.MaskOf(100) == s.GameMask());
+}
+
+TEST_CASE(SteeringRestorePutsBackEveryOriginalMask) {
+    FakeBackend b;
+    Populate(b);
+    b.Add(800, "odd.exe", 0x5A5A5);
+    CpuSteering::Steering s(b);
+    s.Apply("game.exe");
+    b.Add(900, "late.exe", PCores | 0x10000);
+    s.Refresh();
+
+    // One process exits mid-session; the rest must still come back.
+    b.Remove(200);
+    s.Restore();
+    CHECK(!s.Active());
+    CHECK(s.JournalSize() == 0);
+    CHECK(b.MaskOf(100) == AllCores);
+    CHECK(b.MaskOf(300) == ECores);
+    CHECK(b.MaskOf(400) == PCores);
+    CHECK(b.MaskOf(600) == 0x80000);
+    CHECK(b.MaskOf(800) == 0x5A5A5);
+    CHECK(b.MaskOf(900) == (PCores | 0x10000));
+
+    // A second restore has nothing left to do.
+    const int sets = b.sets;
+    s.Restore();
+    CHECK(b.sets == sets);
+}
+
+TEST_CASE(SteeringReportsRefusedChanges) {
+    FakeBackend b;
+    Populate(b);
+    b.Add(1000, "protected.exe").locked = true;
+    CpuSteering::Steering s(b);
+    int attempts = 0, failures = 0;
+    s.SetObserver([&](const CpuSteering::JournalEntry& e, bool failed) {
+        ++attempts;
+        if (!failed) return true;
+        ++failures;
+        CHECK(e.proc.pid == 1000);
+        CHECK(e.original == AllCores);
+        return true;
+        });
+    s.Apply("game.exe");
+    CHECK(failures == 1);
+    CHECK(attempts == static_cast<int>(s.JournalSize()) + 2);
+    CHECK(b.MaskOf(1000) == AllCores);
+
+    // Never journaled, never retried, never restored.
+    const int before = attempts;
+    s.Refresh();
+    s.Refresh();
+    CHECK(attempts == before);
+    CHECK(failures == 1);
+    s.Restore();
+    CHECK(b.MaskOf(1000) == AllCores);
+
+    // The next session asks again.
+    s.Apply("game.exe");
+    CHECK(failures == 2);
+}
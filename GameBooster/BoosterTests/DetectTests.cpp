@@ -0,0 +1,105 @@
+﻿#define NOMINMAX
+
+#include "Detect.h"
+#include "Test.h"
+
+namespace {
+
+    // Every signal a game gives: scores about 0.98.
+    Detect::Sample Game(uint32_t pid = 100, uint64_t startTime = 1) {
+        Detect::Sample s;
+        s.exe = "game.exe";
+        s.pid = pid;
+        s.startTime = startTime;
+        s.threads = 40;
+        s.cpuCores = 1.5;
+        s.hotThreads = 1;
+        s.graphics = true;
+        s.audio = true;
+        s.runtime = true;
+        s.fullscreen = true;
+        return s;
+    }
+
+    // The same process between scenes: graphics mapped, nothing else.
+    Detect::Sample Idle(uint32_t pid = 100, uint64_t startTime = 1) {
+        Detect::Sample s;
+        s.exe = "game.exe";
+        s.pid = pid;
+        s.startTime = startTime;
+        s.threads = 40;
+        s.graphics = true;
+        return s;
+    }
+
+    Detect::Options TestOptions() {
+        Detect::Options opts;
+        opts.enabled = true;
+        return opts;
+    }
+
+} // namespace
+
+TEST_CASE(SamplesScoreAsExpected) {
+    CHECK(Detect::Score(Game()) > 0.9);
+    CHECK(Detect::Score(Idle()) < 0.2);
+    Detect::Sample shell = Game();
+    shell.childShell = true;
+    // A shell child outweighs any one signal.
+    CHECK(Detect::Score(shell) < TestOptions().threshold);
+}
+
+TEST_CASE(DetectorWaitsForASustainedScore) {
+    Detect::Detector detector(TestOptions());
+    CHECK(!detector.Observe(Game()).game);
+    CHECK(!detector.Observe(Game()).game);
+    CHECK(detector.Observe(Game()).game);
+}
+
+TEST_CASE(DetectorRestartsTheStreakOnALowScore) {
+    Detect::Detector detector(TestOptions());
+    detector.Observe(Game());
+    detector.Observe(Game());
+    CHECK(!detector.Observe(Idle()).game);
+    // The average has to climb back over the threshold before it counts.
+    int ticks = 1;
+    while (!detector.Observe(Game()).game && ticks < 10) ++ticks;
+    CHECK(ticks > 3);
+    CHECK(ticks < 10);
+}
+
+TEST_CASE(DetectorKeepsADeclaredInstance) {
+    Detect::Detector detector(TestOptions());
+    for (int i = 0; i < 3; ++i) detector.Observe(Game());
+
+    // Alt-tab away and back: a quiet sample is still the same game.
+    CHECK(!detector.Observe(Idle(200)).game);
+    CHECK(detector.Observe(Idle()).game);
+    CHECK(detector.Observe(Idle()).game);
+
+    // A relaunch is a new instance and earns its streak again.
+    CHECK(!detector.Observe(Game(100, 2)).game);
+    CHECK(!detector.Observe(Idle(100, 2)).game);
+}
+
+TEST_CASE(DetectorMemoryOverridesTheScore) {
+    Detect::Detector detector(TestOptions());
+    detector.Learn("game.exe", Detect::Verdict::Deny);
+    for (int i = 0; i < 5; ++i) CHECK(!detector.Observe(Game()).game);
+
+    detector.Learn("game.exe", Detect::Verdict::Allow);
+    const Detect::Decision d = detector.Observe(Idle(300));
+    CHECK(d.game);
+    CHECK(d.confidence == 1.0);
+
+    // Forgetting hands the decision back to the score.
+    detector.Learn("game.exe", Detect::Verdict::Unknown);
+    CHECK(!detector.Observe(Idle(300)).game);
+}
+
+TEST_CASE(DetectorNeverTakesBrowsersOrTheShell) {
+    Detect::Detector detector(TestOptions());
+    Detect::Sample s = Game();
+    s.exe = "chrome.exe";
+    for (int i = 0; i < 5; ++i) CHECK(!detector.Observe(s).game);
+}
@@ -0,0 +1,160 @@
+﻿#define NOMINMAX
+
+#include "Discovery.h"
+#include "Test.h"
+
+using Discovery::LauncherInstall;
+
+namespace {
+
+    constexpr uint64_t MB = 1 << 20;
+
+    const LauncherInstall* FindDir(const std::vector<LauncherInstall>& v, const std::string& dir) {
+        for (const auto& li : v)
+            if (li.dir == dir) return &li;
+        return nullptr;
+    }
+
+} // namespace
+
+// ------------------------------------------------------------
+// Steam
+// ------------------------------------------------------------
+
+TEST_CASE(LibraryFoldersCurrentLayout) {
+    const auto paths = Discovery::ParseLibraryFolders(Test::ReadFixture("steam/libraryfolders.vdf"));
+    // Per-library "apps" maps have numeric keys too; none of them is a path.
+    CHECK(paths == std::vector<std::string>({ "C:\\Program Files (x86)\\Steam", "D:\\SteamLibrary" }));
+}
+
+TEST_CASE(LibraryFoldersLegacyLayout) {
+    const auto paths = Discovery::ParseLibraryFolders(
+        Test::ReadFixture("steam/libraryfolders_legacy.vdf"));
+    CHECK(paths == std::vector<std::string>({ "D:\\SteamLibrary", "E:\\Games\\Steam" }));
+}
+
+TEST_CASE(LibraryFoldersEmptyOrMissing) {
+    CHECK(Discovery::ParseLibraryFolders("").empty());
+    CHECK(Discovery::ParseLibraryFolders("\"libraryfolders\"\n{\n}\n").empty());
+}
+
+TEST_CASE(AppManifestNamesTheInstall) {
+    std::string title, dir;
+    CHECK(Discovery::ParseAppManifest(Test::ReadFixture("steam/appmanifest_1091500.acf"), title, dir));
+    CHECK(title == "Cyberpunk 2077");
+    CHECK(dir == "Cyberpunk 2077");
+}
+
+TEST_CASE(AppManifestWithoutNameUsesInstallDir) {
+    std::string title, dir;
+    CHECK(Discovery::ParseAppManifest(Test::ReadFixture("steam/appmanifest_1245620.acf"), title, dir));
+    CHECK(dir == "ELDEN RING");
+    CHECK(title == "ELDEN RING");
+}
+
+TEST_CASE(AppManifestStillDownloadingIsSkipped) {
+    std::string title = "unchanged", dir;
+    CHECK(!Discovery::ParseAppManifest(Test::ReadFixture("steam/appmanifest_2357570.acf"), title, dir));
+    CHECK(title == "unchanged");
+    CHECK(dir.empty());
+}
+
+// ------------------------------------------------------------
+// Epic and Heroic
+// ------------------------------------------------------------
+
+TEST_CASE(EpicManifestNamesTheInstall) {
+    const auto v = Discovery::ParseEpicManifest(
+        Test::ReadFixture("epic/4fe75bbc5a674f4f9b356b5c90567da5.item"));
+    CHECK(v.size() == 1);
+    if (v.empty()) return;
+    CHECK(v[0].dir == "C:\\Program Files\\Epic Games\\Fortnite");
+    CHECK(v[0].title == "Fortnite");
+    CHECK(v[0].executable == "FortniteGame/Binaries/Win64/FortniteClient-Win64-Shipping.exe");
+}
+
+TEST_CASE(EpicManifestDecodesEscapes) {
+    const auto v = Discovery::ParseEpicManifest(
+        Test::ReadFixture("epic/9a7c2e4f1b3d4c5e8f60718293a4b5c6.item"));
+    CHECK(v.size() == 1);
+    if (v.empty()) return;
+    CHECK(v[0].title == "Assassin\xE2\x80\x99s Creed\xC2\xAE Valhalla");
+    CHECK(v[0].dir == "D:\\Epic Games\\ACValhalla");
+    CHECK(v[0].executable == "ACValhalla.exe");
+}
+
+TEST_CASE(HeroicLegendaryLayout) {
+    const auto v = Discovery::ParseHeroicInstalled(
+        Test::ReadFixture("heroic/legendary_installed.json"));
+    // prereq_info is an object with a path of its own, but no install_path.
+    CHECK(v.size() == 2);
+    const LauncherInstall* fn = FindDir(v, "D:\\Games\\Heroic\\Fortnite");
+    CHECK(fn && fn->title == "Fortnite");
+    CHECK(fn && fn->executable == "FortniteGame/Binaries/Win64/FortniteLauncher.exe");
+    const LauncherInstall* rl = FindDir(v, "D:\\Games\\Heroic\\rocketleague");
+    CHECK(rl && rl->title == "Rocket League\xC2\xAE");
+    CHECK(rl && rl->executable == "Binaries/Win64/RocketLeague.exe");
+}
+
+TEST_CASE(HeroicGogLayout) {
+    const auto v = Discovery::ParseHeroicInstalled(Test::ReadFixture("heroic/gog_installed.json"));
+    // The second entry has no install path: an interrupted install.
+    CHECK(v.size() == 1);
+    if (v.empty()) return;
+    CHECK(v[0].dir == "D:\\Games\\Heroic\\The Witcher 3 Wild Hunt GOTY");
+    CHECK(v[0].title.empty());
+    CHECK(v[0].executable.empty());
+}
+
+TEST_CASE(ForEachObjectReportsInnermostFirst) {
+    std::vector<std::string> seen;
+    Discovery::ForEachObject(
+        "// comment\n\"Outer\" { \"Name\" \"a\" \"Inner\" { \"Name\" \"b\" \"n\" 42 } }",
+        [&](const Discovery::Fields& f) {
+            const auto name = f.find("name");
+            seen.push_back(name == f.end() ? "?" : name->second);
+            if (name != f.end() && name->second == "b") CHECK(f.at("n") == "42");
+            });
+    CHECK(seen == std::vector<std::string>({ "b", "a" }));
+}
+
+// ------------------------------------------------------------
+// Executable scoring
+// ------------------------------------------------------------
+
+TEST_CASE(ScoreRulesOutHelpers) {
+    const char* const helpers[] = {
+        "unins000.exe", "_CommonRedist\\vcredist_x64.exe", "DirectX\\DXSETUP.exe",
+        "UnityCrashHandler64.exe", "EasyAntiCheat\\EasyAntiCheat_EOS_Setup.exe",
+        "bin\\x64\\CrashReporter\\CrashReporter.exe", "Engine\\Binaries\\Win64\\EpicWebHelper.exe",
+        "Installers\\Setup.exe",
+    };
+    for (const char* exe : helpers)
+        CHECK(Discovery::ScoreExecutable(exe, 50 * MB, "Cyberpunk 2077") < 0);
+}
+
+TEST_CASE(ScorePrefersTheGameBinary) {
+    // The REDengine case: the game sits two levels down beside a launcher.
+    CHECK(Discovery::ScoreExecutable("bin\\x64\\Cyberpunk2077.exe", 60 * MB, "Cyberpunk 2077")
+        > Discovery::ScoreExecutable("REDprelauncher.exe", 2 * MB, "Cyberpunk 2077"));
+    // Unreal: the -Shipping binary wins over the thin root stub.
+    CHECK(Discovery::ScoreExecutable("FortniteGame\\Binaries\\Win64\\FortniteClient-Win64-Shipping.exe",
+        120 * MB, "Fortnite")
+        > Discovery::ScoreExecutable("FortniteGame\\Binaries\\Win64\\FortniteLauncher.exe", 4 * MB, "Fortnite"));
+    // A name that matches the folder beats an unrelated tool at the same depth.
+    CHECK(Discovery::ScoreExecutable("bin\\x64\\witcher3.exe", 50 * MB, "The Witcher 3 Wild Hunt GOTY")
+        > Discovery::ScoreExecutable("bin\\x64\\modkit.exe", 50 * MB, "The Witcher 3 Wild Hunt GOTY"));
+}
+
+TEST_CASE(ScoreWeighsDepthAndSize) {
+    CHECK(Discovery::ScoreExecutable("Game.exe", 10 * MB, "Other")
+        > Discovery::ScoreExecutable("old\\Game.exe", 10 * MB, "Other"));
+    CHECK(Discovery::ScoreExecutable("Game.exe", 64 * MB, "Other")
+        > Discovery::ScoreExecutable("Game.exe", 1 * MB, "Other"));
+    // The size bonus is capped, so a huge binary cannot outrank a name match.
+    CHECK(Discovery::ScoreExecutable("Game.exe", 1024 * MB, "Other")
+        == Discovery::ScoreExecutable("Game.exe", 100 * 1024 * MB, "Other"));
+    // Allowed executables never score below zero, however deep.
+    CHECK(Discovery::ScoreExecutable("a\\b\\c\\d\\e\\f\\g\\h\\i\\j\\k\\l\\m\\n\\o\\p\\q\\r\\s\\t\\u\\tool.exe",
+        0, "Other") == 0);
+}
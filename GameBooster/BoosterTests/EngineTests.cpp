@@ -0,0 +1,454 @@
+﻿#define NOMINMAX
+
+#include "Engine.h"
+#include "Test.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <memory>
+
+using Booster::ProcessInfo;
+
+namespace {
+
+    constexpr DWORD_PTR AllCores = 0xFFFFF;     // 6 P-cores with SMT, 8 E-cores
+
+    struct FakeProcess {
+        ProcessInfo info;
+        DWORD       priority = NORMAL_PRIORITY_CLASS;
+        DWORD_PTR   mask = AllCores;
+        std::string image;
+    };
+
+    // Hands the engine whatever reading the test last scripted.
+    class ScriptedSource final : public Pressure::Source {
+    public:
+        Pressure::Reading next;
+
+        bool Read(Pressure::Reading& out) override {
+            out = next;
+            return true;
+        }
+    };
+
+    // An OS made of a process table. Counts every call, so a test can
+    // tell whether the engine touched it at all.
+    class FakePlatform final : public Booster::Platform {
+    public:
+        std::vector<FakeProcess> procs;
+        std::vector<std::string> launched;
+        std::string foreground;
+        ScriptedSource pressure;
+        std::map<DWORD, uint64_t> cpuPerTick;   // 100 ns units each QueryUsage
+        uint64_t usageTicks = 0;
+        PowerQos::IdleLimit idleLimit{ 0, 0, "{plan}" };
+        int idleLimitWrites = 0;
+        int calls = 0;
+
+        void Add(DWORD pid, const char* exe, DWORD priority = NORMAL_PRIORITY_CLASS,
+            const std::string& image = {})
+        {
+            procs.push_back({ { pid, 1, exe }, priority, AllCores, image });
+        }
+
+        const FakeProcess* Get(DWORD pid) const {
+            for (const auto& p : procs)
+                if (p.info.pid == pid) return &p;
+            return nullptr;
+        }
+
+        DWORD_PTR SystemMask() override { ++calls; return AllCores; }
+
+        void Enumerate(std::vector<ProcessInfo>& out) override {
+            ++calls;
+            out.clear();
+            for (const auto& p : procs) out.push_back(p.info);
+        }
+
+        bool GetAffinity(const ProcessInfo& p, DWORD_PTR& mask) override {
+            ++calls;
+            const FakeProcess* f = Find(p);
+            if (f) mask = f->mask;
+            return f != nullptr;
+        }
+
+        bool SetAffinity(const ProcessInfo& p, DWORD_PTR mask) override {
+            ++calls;
+            FakeProcess* f = Find(p);
+            if (f) f->mask = mask;
+            return f != nullptr;
+        }
+
+        std::string ForegroundProcess() override { ++calls; return foreground; }
+
+        bool Terminate(const ProcessInfo& p, std::string& imagePath, uint32_t& error) override {
+            ++calls;
+            FakeProcess* f = Find(p);
+            if (!f) {
+                error = ERROR_ACCESS_DENIED;
+                return false;
+            }
+            imagePath = f->image;
+            procs.erase(procs.begin() + (f - procs.data()));
+            return true;
+        }
+
+        bool GetPriority(const ProcessInfo& p, DWORD& priorityClass) override {
+            ++calls;
+            const FakeProcess* f = Find(p);
+            if (f) priorityClass = f->priority;
+            return f != nullptr;
+        }
+
+        bool SetPriority(const ProcessInfo& p, DWORD priorityClass) override {
+            ++calls;
+            FakeProcess* f = Find(p);
+            if (f) f->priority = priorityClass;
+            return f != nullptr;
+        }
+
+        bool Launch(const std::string& command, uint32_t&) override {
+            ++calls;
+            launched.push_back(command);
+            return true;
+        }
+
+        Pressure::Source* PressureSource() override { ++calls; return &pressure; }
+
+        void QueryUsage(std::vector<Pressure::Usage>& out) override {
+            ++calls;
+            ++usageTicks;
+            out.clear();
+            for (const auto& p : procs) {
+                Pressure::Usage u;
+                u.proc = p.info;
+                const auto busy = cpuPerTick.find(p.info.pid);
+                if (busy != cpuPerTick.end()) u.cpuTime = busy->second * usageTicks;
+                out.push_back(u);
+            }
+        }
+
+        bool GetIdleStateLimit(PowerQos::IdleLimit& out) override {
+            ++calls;
+            out = idleLimit;
+            return true;
+        }
+
+        bool SetIdleStateLimit(const PowerQos::IdleLimit& limit) override {
+            ++calls;
+            ++idleLimitWrites;
+            idleLimit = limit;
+            return true;
+        }
+
+        ULONGLONG CpuTime(const ProcessInfo&) override { ++calls; return 0; }
+        void Sleep(DWORD) override { ++calls; }
+
+    private:
+        FakeProcess* Find(const ProcessInfo& p) {
+            for (auto& f : procs)
+                if (f.info.pid == p.pid && f.info.startTime == p.startTime) return &f;
+            return nullptr;
+        }
+    };
+
+    Booster::EngineOptions TestOptions() {
+        Booster::EngineOptions opts;
+        opts.numaPlacement = false;
+        opts.settleMs = 0;
+        opts.relaunchGapMs = 0;
+        return opts;
+    }
+
+    void Populate(FakePlatform& os) {
+        os.Add(100, "Game.exe");
+        os.Add(200, "explorer.exe", NORMAL_PRIORITY_CLASS, "C:\\Windows\\explorer.exe");
+        os.Add(300, "svchost.exe");
+        os.Add(301, "svchost.exe", ABOVE_NORMAL_PRIORITY_CLASS);
+        os.Add(400, "chat.exe", BELOW_NORMAL_PRIORITY_CLASS);
+    }
+
+    // What a crash in the middle of `game.exe`'s session leaves behind: the
+    // OS as boosted and a copy of the journal (in `file`) at that moment.
+    FakePlatform CrashDuringSession(const Booster::EngineOptions& opts, const std::string& file) {
+        FakePlatform os;
+        Populate(os);
+        Booster::Engine engine(opts, os);
+        engine.ForceEnter("game.exe");
+        std::ifstream in(opts.journalFile, std::ios::binary);
+        std::ofstream out(file, std::ios::binary);
+        out << in.rdbuf();
+        // Taken before the engine's destructor restores `os`.
+        FakePlatform crashed = os;
+        return crashed;
+    }
+
+    bool IsActive(Booster::Engine& engine) {
+        Booster::StatusInfo st;
+        return engine.GetStatus(st) && st.active;
+    }
+
+} // namespace
+
+TEST_CASE(EnginesAreCheapToCreate) {
+    FakePlatform os;
+    Populate(os);
+    for (int i = 0; i < 1000; ++i) {
+        auto engine = std::make_unique<Booster::Engine>(TestOptions(), os);
+        CHECK(!IsActive(*engine));
+    }
+    // Construction and destruction alone never reach the OS.
+    CHECK(os.calls == 0);
+}
+
+TEST_CASE(ForcedSessionBoostsAndRestores) {
+    FakePlatform os;
+    Populate(os);
+    Booster::Engine engine(TestOptions(), os);
+
+    CHECK(engine.ForceEnter("game.exe"));
+    CHECK(IsActive(engine));
+    CHECK(os.Get(100)->priority == HIGH_PRIORITY_CLASS);
+    CHECK(os.Get(300)->priority == IDLE_PRIORITY_CLASS);
+    CHECK(os.Get(301)->priority == IDLE_PRIORITY_CLASS);
+    CHECK(os.Get(400)->priority == BELOW_NORMAL_PRIORITY_CLASS);
+    CHECK(os.Get(200) == nullptr);
+    CHECK(engine.Metrics().processesKilled.Value() == 1);
+
+    const DWORD_PTR game = os.Get(100)->mask;
+    CHECK(CpuSteering::CountBits(game) == 10);
+    CHECK((os.Get(400)->mask & game) == 0);
+    CHECK((os.Get(300)->mask & game) == 0);
+
+    CHECK(engine.ForceExit());
+    CHECK(!IsActive(engine));
+    CHECK(os.Get(100)->priority == NORMAL_PRIORITY_CLASS);
+    CHECK(os.Get(300)->priority == NORMAL_PRIORITY_CLASS);
+    CHECK(os.Get(301)->priority == ABOVE_NORMAL_PRIORITY_CLASS);
+    for (DWORD pid : { 100, 300, 301, 400 })
+        CHECK(os.Get(pid)->mask == AllCores);
+    // The shell is started by name, not by the path it ran from.
+    CHECK(os.launched == std::vector<std::string>{ "explorer.exe" });
+    CHECK(!engine.ForceExit());
+}
+
+TEST_CASE(KilledProcessesRelaunchFromTheirImage) {
+    FakePlatform os;
+    Populate(os);
+    os.Add(500, "SearchHost.exe", NORMAL_PRIORITY_CLASS, "C:\\Windows\\SystemApps\\SearchHost.exe");
+    Booster::EngineOptions opts = TestOptions();
+    opts.killList = { "searchhost.exe" };
+    Booster::Engine engine(opts, os);
+
+    engine.ForceEnter("game.exe");
+    CHECK(os.Get(500) == nullptr);
+    CHECK(os.Get(200) != nullptr);
+    engine.ForceExit();
+    CHECK(os.launched == std::vector<std::string>{ "C:\\Windows\\SystemApps\\SearchHost.exe" });
+}
+
+TEST_CASE(ProcessesGoneBeforeExitAreSkipped) {
+    FakePlatform os;
+    Populate(os);
+    Booster::Engine engine(TestOptions(), os);
+    engine.ForceEnter("game.exe");
+
+    // The game quits first; a new process takes its pid.
+    os.procs.erase(os.procs.begin());
+    os.Add(100, "other.exe", IDLE_PRIORITY_CLASS);
+    os.procs.back().info.startTime = 2;
+    engine.ForceExit();
+    CHECK(os.Get(100)->priority == IDLE_PRIORITY_CLASS);
+    CHECK(os.Get(100)->mask == AllCores);
+    CHECK(os.Get(300)->priority == NORMAL_PRIORITY_CLASS);
+}
+
+TEST_CASE(DestroyingAnActiveEngineRestores) {
+    FakePlatform os;
+    Populate(os);
+    {
+        Booster::Engine engine(TestOptions(), os);
+        engine.ForceEnter("game.exe");
+        CHECK(os.Get(100)->priority == HIGH_PRIORITY_CLASS);
+    }
+    CHECK(os.Get(100)->priority == NORMAL_PRIORITY_CLASS);
+    CHECK(os.Get(300)->priority == NORMAL_PRIORITY_CLASS);
+    CHECK(os.Get(100)->mask == AllCores);
+}
+
+TEST_CASE(IdleStatesAreLeftAloneByDefault) {
+    FakePlatform os;
+    Populate(os);
+    Booster::Engine engine(TestOptions(), os);
+    engine.ForceEnter("game.exe");
+    engine.ForceExit();
+    CHECK(os.idleLimitWrites == 0);
+}
+
+TEST_CASE(IdleStateCapHoldsOnlyTheAcSetting) {
+    FakePlatform os;
+    Populate(os);
+    os.idleLimit.dc = 3;
+    Booster::EngineOptions opts = TestOptions();
+    opts.powerQos.idleStateLimit = 1;
+    Booster::Engine engine(opts, os);
+
+    engine.ForceEnter("game.exe");
+    CHECK(os.idleLimit.ac == 1);
+    CHECK(os.idleLimit.dc == 3);
+    engine.ForceExit();
+    CHECK(os.idleLimit.ac == 0);
+    CHECK(os.idleLimit.dc == 3);
+    CHECK(os.idleLimit.scheme == "{plan}");
+}
+
+TEST_CASE(CrashedSessionIsUndoneOnNextStart) {
+    Test::TempFile live("engine-live.bin"), left("engine-crashed.bin");
+    Booster::EngineOptions opts = TestOptions();
+    opts.journalFile = live.Path();
+    FakePlatform os = CrashDuringSession(opts, left.Path());
+    CHECK(os.Get(100)->priority == HIGH_PRIORITY_CLASS);
+    CHECK(os.Get(200) == nullptr);
+    {
+        // Torn mid-write, as a crash may leave it.
+        std::ofstream out(left.Path(), std::ios::binary | std::ios::app);
+        out << "partial record";
+    }
+
+    opts.journalFile = left.Path();
+    Booster::Engine engine(opts, os);
+    CHECK(engine.Recover() > 0);
+    CHECK(os.Get(100)->priority == NORMAL_PRIORITY_CLASS);
+    CHECK(os.Get(300)->priority == NORMAL_PRIORITY_CLASS);
+    CHECK(os.Get(301)->priority == ABOVE_NORMAL_PRIORITY_CLASS);
+    for (DWORD pid : { 100, 300, 301, 400 })
+        CHECK(os.Get(pid)->mask == AllCores);
+    CHECK(os.launched == std::vector<std::string>{ "explorer.exe" });
+
+    // Replayed once: the journal is empty now.
+    CHECK(engine.Recover() == 0);
+    Booster::Engine again(opts, os);
+    CHECK(again.Recover() == 0);
+    CHECK(os.launched.size() == 1);
+}
+
+TEST_CASE(CrashReplaySkipsProcessesAlreadyBack) {
+    Test::TempFile live("engine-live.bin"), left("engine-crashed.bin");
+    Booster::EngineOptions opts = TestOptions();
+    opts.journalFile = live.Path();
+    FakePlatform os = CrashDuringSession(opts, left.Path());
+    // Windows restarted the shell on its own before the booster came back.
+    os.Add(210, "explorer.exe");
+    os.procs.back().info.startTime = 2;
+
+    opts.journalFile = left.Path();
+    Booster::Engine engine(opts, os);
+    CHECK(engine.Recover() > 0);
+    CHECK(os.launched.empty());
+    CHECK(os.Get(100)->priority == NORMAL_PRIORITY_CLASS);
+}
+
+TEST_CASE(RulesGateEnteringButNotStaying) {
+    Test::TempFile rules("engine-rules.txt");
+    {
+        std::ofstream out(rules.Path());
+        out << "allow when running(\"obs64.exe\")\n";
+    }
+    FakePlatform os;
+    Populate(os);
+    Booster::EngineOptions opts = TestOptions();
+    opts.rulesFile = rules.Path();
+    Booster::Engine engine(opts, os);
+    CHECK(engine.LoadRules().empty());
+    engine.AddGame("game.exe");
+    os.foreground = "Game.exe";
+
+    engine.Tick();
+    CHECK(!IsActive(engine));
+    os.Add(500, "obs64.exe");
+    engine.Tick();
+    CHECK(IsActive(engine));
+
+    // The rule failing mid-session does not end it.
+    os.procs.pop_back();
+    engine.Tick();
+    engine.Tick();
+    CHECK(IsActive(engine));
+
+    os.foreground = "explorer.exe";
+    engine.Tick();
+    CHECK(!IsActive(engine));
+    os.foreground = "Game.exe";
+    engine.Tick();
+    CHECK(!IsActive(engine));
+}
+
+TEST_CASE(PressureStepsUpOnlyAfterRaiseTicks) {
+    FakePlatform os;
+    Populate(os);
+    os.cpuPerTick = { { 100, 5000000 }, { 400, 2000000 }, { 300, 9000000 } };
+    Booster::Engine engine(TestOptions(), os);
+    engine.ForceEnter("game.exe");
+    const auto level = [&] { return engine.Metrics().escalationLevel.Value(); };
+
+    os.pressure.next.cpu = 0.9;
+    engine.Tick();
+    engine.Tick();
+    CHECK(level() == 0);
+    CHECK(os.Get(400)->priority == BELOW_NORMAL_PRIORITY_CLASS);
+    engine.Tick();
+    CHECK(level() == 1);
+    // The busiest process neither the game nor already idled.
+    CHECK(os.Get(400)->priority == IDLE_PRIORITY_CLASS);
+    CHECK(os.Get(100)->priority == HIGH_PRIORITY_CLASS);
+}
+
+TEST_CASE(PressureHoldsInsideTheBand) {
+    FakePlatform os;
+    Populate(os);
+    os.cpuPerTick = { { 400, 2000000 } };
+    Booster::Engine engine(TestOptions(), os);
+    engine.ForceEnter("game.exe");
+
+    // Between the thresholds nothing moves, however long it lasts.
+    os.pressure.next.cpu = 0.6;
+    for (int i = 0; i < 30; ++i) engine.Tick();
+    CHECK(engine.Metrics().escalationLevel.Value() == 0);
+
+    // A tick in the band restarts the run above it.
+    for (double cpu : { 0.9, 0.9, 0.6, 0.9, 0.9 }) {
+        os.pressure.next.cpu = cpu;
+        engine.Tick();
+    }
+    CHECK(engine.Metrics().escalationLevel.Value() == 0);
+    CHECK(os.Get(400)->priority == BELOW_NORMAL_PRIORITY_CLASS);
+}
+
+TEST_CASE(PressureStepsDownAndRestoresTheOffender) {
+    FakePlatform os;
+    Populate(os);
+    os.cpuPerTick = { { 400, 2000000 } };
+    Booster::EngineOptions opts = TestOptions();
+    opts.pressure.lowerTicks = 5;
+    Booster::Engine engine(opts, os);
+    engine.ForceEnter("game.exe");
+    os.pressure.next.cpu = 0.9;
+    for (int i = 0; i < 3; ++i) engine.Tick();
+    CHECK(os.Get(400)->priority == IDLE_PRIORITY_CLASS);
+
+    os.pressure.next.cpu = 0.1;
+    for (int i = 0; i < 4; ++i) engine.Tick();
+    CHECK(engine.Metrics().escalationLevel.Value() == 1);
+    CHECK(os.Get(400)->priority == IDLE_PRIORITY_CLASS);
+    engine.Tick();
+    CHECK(engine.Metrics().escalationLevel.Value() == 0);
+    CHECK(os.Get(400)->priority == BELOW_NORMAL_PRIORITY_CLASS);
+
+    // Its journal entry went with it: exit leaves a later change alone.
+    for (auto& p : os.procs)
+        if (p.info.pid == 400) p.priority = ABOVE_NORMAL_PRIORITY_CLASS;
+    engine.ForceExit();
+    CHECK(os.Get(400)->priority == ABOVE_NORMAL_PRIORITY_CLASS);
+    CHECK(os.Get(100)->priority == NORMAL_PRIORITY_CLASS);
+}
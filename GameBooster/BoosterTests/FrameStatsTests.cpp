@@ -0,0 +1,58 @@
+﻿#define NOMINMAX
+
+#include "FrameStats.h"
+#include "Test.h"
+
+#include <cmath>
+
+TEST_CASE(FrameSummaryPercentilesAndStutters) {
+    std::vector<double> frames(1000, 16.0);
+    frames[10] = 40.0;
+    frames[20] = 33.0;
+    const FrameStats::Summary s = FrameStats::Summarize(frames, 16.0);
+    CHECK(s.frames == 1000);
+    CHECK(s.p50Ms == 16.0);
+    CHECK(s.p99Ms == 16.0);
+    CHECK(s.p999Ms == 33.0);
+    CHECK(s.maxMs == 40.0);
+    CHECK(s.stutters == 2);
+}
+
+TEST_CASE(RunComparisonOfIdenticalSidesFindsNothing) {
+    const FrameStats::Comparison c = FrameStats::Compare({ 17, 18, 19 }, { 19, 18, 17 });
+    CHECK(c.difference == 0);
+    CHECK(c.p == 1);
+    CHECK(c.runsA == 3);
+    CHECK(c.runsB == 3);
+}
+
+TEST_CASE(RunComparisonIsExactOverRelabellings) {
+    // Every boosted run beat every unboosted one: only that split and its
+    // mirror image are as extreme, out of C(10, 5) = 252.
+    const FrameStats::Comparison c = FrameStats::Compare(
+        { 16.1, 16.3, 16.2, 16.0, 16.4 }, { 18.0, 18.4, 17.9, 18.2, 18.1 });
+    CHECK(c.difference < -1.8);
+    CHECK(std::fabs(c.p - 2.0 / 252) < 1e-12);
+
+    // Three runs a side can never get below 2 / 20.
+    const FrameStats::Comparison few = FrameStats::Compare({ 1, 2, 3 }, { 10, 11, 12 });
+    CHECK(std::fabs(few.p - 0.1) < 1e-12);
+}
+
+TEST_CASE(RunComparisonOfOverlappingSidesIsNotSignificant) {
+    const FrameStats::Comparison c = FrameStats::Compare(
+        { 16.0, 18.0, 16.5, 17.8, 16.9 }, { 17.0, 16.2, 18.1, 16.8, 17.5 });
+    CHECK(c.p > 0.5);
+}
+
+TEST_CASE(RunComparisonSamplesLargeRunCounts) {
+    std::vector<double> a, b;
+    for (int i = 0; i < 20; ++i) {
+        a.push_back(16 + (i % 5) * 0.1);
+        b.push_back(17 + (i % 5) * 0.1);
+    }
+    const FrameStats::Comparison c = FrameStats::Compare(a, b);
+    CHECK(c.runsA == 20);
+    CHECK(c.p < 0.001);
+    CHECK(c.p > 0);
+}
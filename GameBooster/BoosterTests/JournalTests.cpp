@@ -0,0 +1,91 @@
+﻿#define NOMINMAX
+
+#include "Journal.h"
+#include "Test.h"
+
+#include <fstream>
+
+namespace {
+
+    Journal::Entry Priority(DWORD pid, DWORD original) {
+        return Journal::Entry::Make(Journal::Kind::Priority, { pid, 1, "game.exe" }, original);
+    }
+
+    Journal::Entry Affinity(DWORD pid, DWORD_PTR original) {
+        return Journal::Entry::Make(Journal::Kind::Affinity, { pid, 1, "chat.exe" }, original);
+    }
+
+} // namespace
+
+TEST_CASE(JournalWorksInMemoryWithoutAFile) {
+    Journal::Log log;
+    CHECK(log.Record(Priority(100, NORMAL_PRIORITY_CLASS)));
+    CHECK(log.Pending().size() == 1);
+    log.Drop(Priority(100, NORMAL_PRIORITY_CLASS));
+    CHECK(log.Pending().empty());
+}
+
+TEST_CASE(JournalKeepsPendingChangesAcrossReopen) {
+    Test::TempFile file("journal-reopen.bin");
+    {
+        Journal::Log log;
+        CHECK(log.Open(file.Path()));
+        CHECK(log.Pending().empty());
+        CHECK(log.Record(Priority(100, NORMAL_PRIORITY_CLASS)));
+        CHECK(log.Record(Affinity(400, 0xFF)));
+        CHECK(log.Update(Priority(100, BELOW_NORMAL_PRIORITY_CLASS)));
+        log.Drop(Affinity(400, 0xFF));
+        log.Sync();
+    }
+    Journal::Log log;
+    CHECK(log.Open(file.Path()));
+    CHECK(log.Pending().size() == 1);
+    if (log.Pending().size() == 1) {
+        CHECK(log.Pending()[0].Type() == Journal::Kind::Priority);
+        CHECK(log.Pending()[0].value == BELOW_NORMAL_PRIORITY_CLASS);
+    }
+    log.Clear();
+    log.Close();
+    CHECK(log.Open(file.Path()));
+    CHECK(log.Pending().empty());
+}
+
+TEST_CASE(JournalIgnoresATornTailRecord) {
+    Test::TempFile file("journal-torn.bin");
+    {
+        Journal::Log log;
+        CHECK(log.Open(file.Path()));
+        log.Record(Priority(100, NORMAL_PRIORITY_CLASS));
+        log.Record(Affinity(400, 0xFF));
+    }
+    {
+        // The process died halfway through writing a third record.
+        const Journal::Entry torn = Affinity(401, 0xF0);
+        std::ofstream out(file.Path(), std::ios::binary | std::ios::app);
+        out.write(reinterpret_cast<const char*>(&torn), sizeof(torn) / 2);
+    }
+    {
+        Journal::Log log;
+        CHECK(log.Open(file.Path()));
+        CHECK(log.Pending().size() == 2);
+        // The next record replaces the torn one rather than following it.
+        CHECK(log.Record(Affinity(402, 0x0F)));
+    }
+    Journal::Log log;
+    CHECK(log.Open(file.Path()));
+    CHECK(log.Pending().size() == 3);
+    if (log.Pending().size() == 3) CHECK(log.Pending()[2].pid == 402);
+}
+
+TEST_CASE(JournalLeavesForeignFilesAlone) {
+    Test::TempFile file("journal-foreign.bin");
+    {
+        std::ofstream out(file.Path(), std::ios::binary);
+        out << "not a journal, though long enough to have held the header of one";
+    }
+    Journal::Log log;
+    CHECK(!log.Open(file.Path()));
+    CHECK(!log.IsOpen());
+    std::ifstream in(file.Path(), std::ios::binary | std::ios::ate);
+    CHECK(in.tellg() == 64);
+}
@@ -0,0 +1,91 @@
+﻿#define NOMINMAX
+
+#include "Test.h"
+
+#include <windows.h>
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace Test {
+
+    namespace {
+        std::string g_fixtures;
+        const Case* g_current = nullptr;
+        int         g_failures = 0;
+    }
+
+    std::vector<Case>& Registry() {
+        static std::vector<Case> cases;
+        return cases;
+    }
+
+    void Fail(const char* file, int line, const std::string& what) {
+        const char* slash = std::strrchr(file, '\\');
+        if (!slash) slash = std::strrchr(file, '/');
+        fprintf(stderr, "  %s(%d): %s: CHECK(%s) failed\n",
+            slash ? slash + 1 : file, line, g_current ? g_current->name : "?", what.c_str());
+        ++g_failures;
+    }
+
+    std::string ReadFixture(const std::string& relative) {
+        std::ifstream file(g_fixtures + relative, std::ios::binary);
+        if (!file) {
+            Fail(__FILE__, __LINE__, "fixture " + relative + " exists");
+            return {};
+        }
+        std::ostringstream text;
+        text << file.rdbuf();
+        return text.str();
+    }
+
+    TempFile::TempFile(const std::string& name) {
+        std::error_code ec;
+        path_ = (std::filesystem::temp_directory_path(ec) / ("BoosterTests-" + name)).string();
+        std::filesystem::remove(path_, ec);
+    }
+
+    TempFile::~TempFile() {
+        std::error_code ec;
+        std::filesystem::remove(path_, ec);
+    }
+
+} // namespace Test
+
+// BoosterTests [--fixtures <dir>] [name filter]
+// Fixtures default to the copy placed beside the executable at build time.
+int main(int argc, char** argv) {
+    const char* filter = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--fixtures") == 0 && i + 1 < argc) Test::g_fixtures = argv[++i];
+        else filter = argv[i];
+    }
+    if (Test::g_fixtures.empty()) {
+        char self[MAX_PATH];
+        if (GetModuleFileNameA(nullptr, self, MAX_PATH)) {
+            Test::g_fixtures = self;
+            Test::g_fixtures.erase(Test::g_fixtures.find_last_of("\\/") + 1);
+        }
+        Test::g_fixtures += "fixtures";
+    }
+    const char last = Test::g_fixtures.back();
+    if (last != '\\' && last != '/') Test::g_fixtures += '\\';
+
+    int run = 0, failed = 0;
+    for (const Test::Case& c : Test::Registry()) {
+        if (filter && !std::strstr(c.name, filter)) continue;
+        Test::g_current = &c;
+        const int before = Test::g_failures;
+        c.run();
+        ++run;
+        if (Test::g_failures != before) {
+            ++failed;
+            fprintf(stderr, "FAIL %s\n", c.name);
+        }
+    }
+    printf("%d of %d cases passed\n", run - failed, run);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,147 @@
+﻿#define NOMINMAX
+
+#include "Rules.h"
+#include "Test.h"
+
+namespace {
+
+    Rules::RuleSet Compile(const std::string& source) {
+        std::vector<std::string> errors;
+        Rules::RuleSet set = Rules::RuleSet::Compile(source, errors);
+        CHECK(errors.empty());
+        return set;
+    }
+
+    size_t FactId(const Rules::RuleSet& set, Rules::Fact kind, const std::string& arg = {}) {
+        const auto& facts = set.Facts();
+        for (size_t i = 0; i < facts.size(); ++i)
+            if (facts[i].kind == kind && facts[i].arg == arg) return i;
+        Test::Fail(__FILE__, __LINE__, "fact is used");
+        return 0;
+    }
+
+} // namespace
+
+TEST_CASE(RulesReportCompileErrorsByLine) {
+    const std::string source =
+        "# comments and blank lines are skipped\n"
+        "\n"
+        "allow when ac_power\n"
+        "allow when frame_rate > 60\n"
+        "deny when running(\"obs64.exe\"\n"
+        "allow if ac_power\n"
+        "deny when game == \"cs2.exe\n"
+        "allow when free_ram > 4tb\n"
+        "allow when battery > 20 for\n"
+        "deny when time between 09:00 and 18:00   # office hours\n";
+    std::vector<std::string> errors;
+    const Rules::RuleSet set = Rules::RuleSet::Compile(source, errors);
+    CHECK(set.Size() == 2);
+    CHECK(errors.size() == 6);
+    if (errors.size() == 6) {
+        CHECK(errors[0] == "line 4: unknown fact 'frame_rate'");
+        CHECK(errors[1] == "line 5: expected ')'");
+        CHECK(errors[2] == "line 6: expected 'when'");
+        CHECK(errors[3] == "line 7: unterminated string");
+        CHECK(errors[4] == "line 8: unknown unit 'tb'");
+        CHECK(errors[5] == "line 9: expected a duration after 'for'");
+    }
+    // A dropped line leaves nothing behind.
+    CHECK(set.Facts().size() == 2);
+    CHECK(!set.Uses(Rules::Fact::Running));
+}
+
+TEST_CASE(RulesUnitsAndDecisions) {
+    Rules::RuleSet set = Compile(
+        "allow when ac_power and free_ram >= 4gb\n"
+        "deny when running(\"OBS64.exe\")\n");
+    const size_t ac = FactId(set, Rules::Fact::AcPower);
+    const size_t ram = FactId(set, Rules::Fact::FreeRam);
+    const size_t obs = FactId(set, Rules::Fact::Running, "obs64.exe");
+
+    set.Set(ac, 1);
+    set.Set(ram, 4096);
+    CHECK(set.Evaluate(0).allow);
+    set.Set(ram, 4095);
+    Rules::RuleSet::Decision d = set.Evaluate(0);
+    CHECK(!d.allow);
+    CHECK(d.line == 1);
+    set.Set(ram, 8192);
+    set.Set(obs, 1);
+    d = set.Evaluate(0);
+    CHECK(!d.allow);
+    CHECK(d.line == 2);
+}
+
+TEST_CASE(RulesTimeRangesWrapPastMidnight) {
+    Rules::RuleSet set = Compile("deny when time between 22:00 and 06:30\n");
+    const size_t time = FactId(set, Rules::Fact::Time);
+    auto allowedAt = [&](int hour, int minute) {
+        set.Set(time, hour * 60 + minute);
+        return set.Evaluate(0).allow;
+    };
+    CHECK(allowedAt(21, 59));
+    CHECK(!allowedAt(22, 0));
+    CHECK(!allowedAt(23, 59));
+    CHECK(!allowedAt(0, 0));
+    CHECK(!allowedAt(6, 29));
+    // Half-open: the end minute is outside.
+    CHECK(allowedAt(6, 30));
+    CHECK(allowedAt(12, 0));
+}
+
+TEST_CASE(RulesSustainNeedsTheWholeDuration) {
+    Rules::RuleSet set = Compile("allow when game_cpu > 50 for 5s\n");
+    const size_t cpu = FactId(set, Rules::Fact::GameCpu);
+
+    set.Set(cpu, 80);
+    CHECK(!set.Evaluate(1000).allow);
+    // Re-run while the timer runs, though the fact has not changed.
+    CHECK(!set.Evaluate(5999).allow);
+    CHECK(set.LastEvaluated() == 1);
+    CHECK(set.Evaluate(6000).allow);
+
+    // One dip restarts the clock.
+    set.Set(cpu, 20);
+    CHECK(!set.Evaluate(7000).allow);
+    set.Set(cpu, 90);
+    CHECK(!set.Evaluate(8000).allow);
+    CHECK(!set.Evaluate(12999).allow);
+    CHECK(set.Evaluate(13000).allow);
+}
+
+TEST_CASE(RulesRerunOnlyWhenTheirFactsChange) {
+    Rules::RuleSet set = Compile(
+        "allow when ac_power\n"
+        "allow when battery > 20\n"
+        "deny when running(\"obs64.exe\") or weekday == 0\n");
+    const size_t ac = FactId(set, Rules::Fact::AcPower);
+    const size_t battery = FactId(set, Rules::Fact::Battery);
+    const size_t obs = FactId(set, Rules::Fact::Running, "obs64.exe");
+    const size_t weekday = FactId(set, Rules::Fact::Weekday);
+
+    set.Set(ac, 1);
+    set.Set(battery, 90);
+    set.Set(weekday, 3);
+    CHECK(set.Evaluate(0).allow);
+    CHECK(set.LastEvaluated() == 3);
+
+    CHECK(set.Evaluate(100).allow);
+    CHECK(set.LastEvaluated() == 0);
+
+    // Setting a fact to the value it had is not a change.
+    set.Set(battery, 90);
+    set.Evaluate(200);
+    CHECK(set.LastEvaluated() == 0);
+
+    set.Set(battery, 10);
+    const Rules::RuleSet::Decision d = set.Evaluate(300);
+    CHECK(set.LastEvaluated() == 1);
+    CHECK(!d.allow);
+    CHECK(d.line == 2);
+
+    set.Set(obs, 1);
+    set.Set(battery, 50);
+    CHECK(!set.Evaluate(400).allow);
+    CHECK(set.LastEvaluated() == 2);
+}
@@ -0,0 +1,263 @@
+﻿#define NOMINMAX
+
+#include "Scene.h"
+#include "Test.h"
+
+#include <cmath>
+
+using Scene::Rect;
+
+namespace {
+
+    bool Covers(const Rect& outer, const Rect& inner) {
+        return outer.X <= inner.X && outer.Y <= inner.Y
+            && outer.Right() >= inner.Right() && outer.Bottom() >= inner.Bottom();
+    }
+
+    bool CoveredBy(const std::vector<Rect>& rects, const Rect& r) {
+        for (const auto& o : rects)
+            if (Covers(o, r)) return true;
+        return false;
+    }
+
+    bool Whole(float v) { return std::floor(v) == v; }
+
+    // What Diff() promises of any result: whole pixels, no overlaps.
+    void CheckWellFormed(const std::vector<Rect>& rects) {
+        for (size_t i = 0; i < rects.size(); ++i) {
+            const Rect& r = rects[i];
+            CHECK(!r.Empty());
+            CHECK(Whole(r.X) && Whole(r.Y) && Whole(r.Width) && Whole(r.Height));
+            for (size_t j = i + 1; j < rects.size(); ++j)
+                CHECK(!r.Intersects(rects[j]));
+        }
+    }
+
+    Scene::Metrics Computed(int w = Layout::InitialW, int h = Layout::InitialH) {
+        Scene::Metrics m;
+        m.Compute(w, h);
+        return m;
+    }
+
+    Scene::State Idle(const Scene::Metrics& m) {
+        Scene::State s;
+        s.width = m.width;
+        s.height = m.height;
+        s.gameCount = 8;
+        s.status = "Ready - Monitoring for games";
+        return s;
+    }
+
+} // namespace
+
+// ------------------------------------------------------------
+// Metrics
+// ------------------------------------------------------------
+
+TEST_CASE(MetricsStackTheControlsTopToBottom) {
+    const Scene::Metrics m = Computed();
+    const float right = static_cast<float>(Layout::InitialW - Layout::Padding);
+
+    CHECK(m.x == Layout::Padding);
+    CHECK(m.contentWidth == Layout::InitialW - 2 * Layout::Padding);
+    CHECK(m.titleY < m.subtitleY && m.subtitleY < m.lineY && m.lineY < m.addLabelY);
+    CHECK(m.addLabelY < m.inputRect.Y);
+    CHECK(m.inputRect.Right() + Layout::GapSm == m.addBtnRect.X);
+    CHECK(m.addBtnRect.Right() == right);
+    CHECK(m.inputRect.Bottom() < m.listLabelY && m.listLabelY < m.listRect.Y);
+    CHECK(m.listRect.Bottom() + Layout::Gap == m.removeBtnRect.Y);
+    CHECK(m.removeBtnRect.Bottom() + Layout::Gap == m.statusRect.Y);
+    CHECK(m.statusRect.Right() == right);
+    // The status bar sits on the bottom padding; the list takes the rest.
+    CHECK(m.statusRect.Bottom() == Layout::InitialH - Layout::Padding);
+    CHECK(m.listRect.Height > 0);
+}
+
+TEST_CASE(MetricsGrowTheListWithTheWindow) {
+    const Scene::Metrics small = Computed(Layout::MinWindowW, Layout::MinWindowH);
+    const Scene::Metrics tall = Computed(Layout::MinWindowW, Layout::MinWindowH + 200);
+    CHECK(tall.listRect.Height == small.listRect.Height + 200);
+    CHECK(tall.listRect.Y == small.listRect.Y);
+    CHECK(tall.statusRect.Y == small.statusRect.Y + 200);
+
+    // Too short for any list: it collapses instead of going negative.
+    const Scene::Metrics squashed = Computed(Layout::MinWindowW, 200);
+    CHECK(squashed.listRect.Height == 0);
+    CHECK(squashed.VisibleListHeight() <= 0);
+}
+
+TEST_CASE(MetricsHitTestButtonsAndItems) {
+    const Scene::Metrics m = Computed();
+    auto centre = [](const Rect& r, int& x, int& y) {
+        x = static_cast<int>(r.X + r.Width / 2);
+        y = static_cast<int>(r.Y + r.Height / 2);
+        };
+    int x, y;
+    centre(m.addBtnRect, x, y);
+    CHECK(m.HitTestButton(x, y) == ID_BTN_ADD);
+    centre(m.removeBtnRect, x, y);
+    CHECK(m.HitTestButton(x, y) == ID_BTN_REMOVE);
+    centre(m.statusRect, x, y);
+    CHECK(m.HitTestButton(x, y) == -1);
+
+    centre(m.ItemRect(2, 0), x, y);
+    CHECK(m.HitTestItem(x, y, 8, 0) == 2);
+    CHECK(m.HitTestItem(x, y, 2, 0) == -1);       // past the last game
+    CHECK(m.HitTestItem(x, y, 8, Layout::ItemH) == 3);
+    CHECK(m.HitTestItem(x, static_cast<int>(m.listRect.Y) - 5, 8, 0) == -1);
+}
+
+TEST_CASE(MetricsScrollOnlyWhenTheListOverflows) {
+    const Scene::Metrics m = Computed();
+    const int visible = m.VisibleListHeight();
+    const int fits = visible / Layout::ItemH;
+    CHECK(m.MaxScroll(0) == 0);
+    CHECK(m.MaxScroll(fits) == 0);
+    CHECK(m.MaxScroll(fits + 3) == (fits + 3) * Layout::ItemH - visible);
+}
+
+TEST_CASE(MetricsPlaceTheEditInsideTheInputBox) {
+    const Scene::Metrics m = Computed();
+    int ex, ey, ew, eh;
+    m.GetEditPosition(ex, ey, ew, eh);
+    CHECK(Covers(m.inputRect, { static_cast<float>(ex), static_cast<float>(ey),
+        static_cast<float>(ew), static_cast<float>(eh) }));
+    CHECK(ew > 0 && eh > 0);
+}
+
+// ------------------------------------------------------------
+// Diff
+// ------------------------------------------------------------
+
+TEST_CASE(DiffOfEqualStatesIsEmpty) {
+    const Scene::Metrics m = Computed();
+    const Scene::State s = Idle(m);
+    CHECK(Scene::Diff(s, s, m).empty());
+}
+
+TEST_CASE(DiffOfAResizeIsTheWholeWindow) {
+    const Scene::Metrics before = Computed();
+    const Scene::Metrics after = Computed(600, 700);
+    Scene::State a = Idle(before), b = Idle(after);
+    b.addHover = 1.f;
+    const auto d = Scene::Diff(a, b, after);
+    CHECK(d.size() == 1);
+    CHECK(!d.empty() && Covers(d[0], { 0.f, 0.f, 600.f, 700.f }));
+}
+
+TEST_CASE(DiffOfAButtonHoverIsThatButton) {
+    const Scene::Metrics m = Computed();
+    Scene::State a = Idle(m), b = a;
+    b.addHover = 0.4f;
+    const auto d = Scene::Diff(a, b, m);
+    CheckWellFormed(d);
+    CHECK(d.size() == 1);
+    CHECK(CoveredBy(d, m.addBtnRect));
+    CHECK(!d.empty() && !d[0].Intersects(m.listRect));
+    CHECK(!d.empty() && !d[0].Intersects(m.inputRect));
+}
+
+TEST_CASE(DiffOfAHoverMoveIsBothRows) {
+    const Scene::Metrics m = Computed();
+    Scene::State a = Idle(m), b = a;
+    a.hoveredItem = 0;
+    b.hoveredItem = 3;
+    const auto d = Scene::Diff(a, b, m);
+    CheckWellFormed(d);
+    CHECK(d.size() == 2);
+    CHECK(CoveredBy(d, m.ItemRect(0, 0).Intersect(m.ListClip())));
+    CHECK(CoveredBy(d, m.ItemRect(3, 0).Intersect(m.ListClip())));
+    for (const auto& r : d) CHECK(Covers(m.listRect, r));
+
+    // Off the end of the list there is nothing to repaint.
+    a.hoveredItem = b.hoveredItem = -1;
+    b.hoveredItem = 20;
+    CHECK(Scene::Diff(a, b, m).empty());
+}
+
+TEST_CASE(DiffOfASelectionAlsoRepaintsRemove) {
+    const Scene::Metrics m = Computed();
+    Scene::State a = Idle(m), b = a;
+    b.selectedItem = 2;
+    const auto d = Scene::Diff(a, b, m);
+    CheckWellFormed(d);
+    CHECK(CoveredBy(d, m.ItemRect(2, 0).Intersect(m.ListClip())));
+    CHECK(CoveredBy(d, m.removeBtnRect));
+
+    // Moving an existing selection leaves the button alone.
+    a.selectedItem = 1;
+    const auto moved = Scene::Diff(a, b, m);
+    for (const auto& r : moved) CHECK(!r.Intersects(m.removeBtnRect));
+}
+
+TEST_CASE(DiffOfAListChangeIsTheListAndItsLabel) {
+    const Scene::Metrics m = Computed();
+    Scene::State a = Idle(m), b = a;
+    b.listRevision = 1;
+    b.gameCount = 9;
+    const auto d = Scene::Diff(a, b, m);
+    CheckWellFormed(d);
+    CHECK(CoveredBy(d, m.ListLabelRow()));
+    CHECK(CoveredBy(d, m.listRect));
+    for (const auto& r : d) CHECK(!r.Intersects(m.statusRect));
+
+    // Scrolling repaints the list, not its label.
+    Scene::State c = a;
+    c.scrollY = 30;
+    const auto s = Scene::Diff(a, c, m);
+    CHECK(s.size() == 1);
+    CHECK(CoveredBy(s, m.listRect));
+    CHECK(!s.empty() && !s[0].Intersects(m.AddLabelRow()));
+}
+
+TEST_CASE(DiffOfThePulseIsOnlyTheDot) {
+    const Scene::Metrics m = Computed();
+    Scene::State a = Idle(m), b = a;
+    a.active = b.active = true;
+    a.pulse = 0.2f;
+    b.pulse = 0.6f;
+    const auto d = Scene::Diff(a, b, m);
+    CHECK(d.size() == 1);
+    if (d.empty()) return;
+    CHECK(Covers(d[0], m.StatusDotRect()));
+    CHECK(Covers(m.statusRect, d[0]));
+    // Far smaller than the bar: the animation must stay cheap.
+    CHECK(d[0].Width * d[0].Height * 10 < m.statusRect.Width * m.statusRect.Height);
+
+    // A status change takes the whole bar, dot included.
+    b.status = "Game Mode Active - game.exe";
+    const auto s = Scene::Diff(a, b, m);
+    CHECK(s.size() == 1);
+    CHECK(CoveredBy(s, m.statusRect));
+}
+
+// ------------------------------------------------------------
+// Coalesce
+// ------------------------------------------------------------
+
+TEST_CASE(CoalesceMergesChainsAndDropsEmpties) {
+    std::vector<Rect> rects{
+        { 0, 0, 10, 10 },
+        { 50, 50, 10, 10 },
+        { 8, 8, 10, 10 },       // overlaps the first
+        { 16, 16, 10, 10 },     // overlaps only the third
+        { 5, 5, 0, 10 },        // empty
+    };
+    Scene::Coalesce(rects);
+    CHECK(rects.size() == 2);
+    CHECK(CoveredBy(rects, { 0, 0, 26, 26 }));
+    CHECK(CoveredBy(rects, { 50, 50, 10, 10 }));
+    CheckWellFormed(rects);
+}
+
+TEST_CASE(CoalesceKeepsTouchingRectsApart) {
+    // Edge-adjacent rows share no pixel; merging them would only grow the
+    // bounding box over whatever lies beside them.
+    std::vector<Rect> rects{ { 0, 0, 10, 10 }, { 10, 0, 10, 10 }, { 0, 10, 10, 10 } };
+    Scene::Coalesce(rects);
+    CHECK(rects.size() == 3);
+
+    std::vector<Rect> none;
+    Scene::Coalesce(none);
+    CHECK(none.empty());
+}
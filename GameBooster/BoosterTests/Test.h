@@ -0,0 +1,57 @@
+﻿#pragma once
+
+#include <string>
+#include <vector>
+
+// ============================================================
+// TEST HARNESS
+// ============================================================
+//
+// Just enough to register cases and count failures; Main.cpp runs them.
+// A failed CHECK reports and the case carries on, so one run shows every
+// broken expectation. No case touches the real OS: engines run against
+// fakes, parsers against the files under fixtures\.
+
+namespace Test {
+
+    struct Case {
+        const char* name;
+        void (*run)();
+    };
+
+    std::vector<Case>& Registry();
+
+    struct Register {
+        Register(const char* name, void (*run)()) { Registry().push_back({ name, run }); }
+    };
+
+    void Fail(const char* file, int line, const std::string& what);
+
+    // Contents of fixtures\<relative>; a missing file fails the case.
+    std::string ReadFixture(const std::string& relative);
+
+    // A path in the temp directory, free on construction and removed again
+    // on destruction.
+    class TempFile {
+    public:
+        explicit TempFile(const std::string& name);
+        ~TempFile();
+
+        TempFile(const TempFile&) = delete;
+        TempFile& operator=(const TempFile&) = delete;
+
+        const std::string& Path() const { return path_; }
+
+    private:
+        std::string path_;
+    };
+
+} // namespace Test
+
+#define TEST_CASE(name) \
+    static void name(); \
+    static const Test::Register name##Registered(#name, name); \
+    static void name()
+
+#define CHECK(expr) \
+    do { if (!(expr)) Test::Fail(__FILE__, __LINE__, #expr); } while (0)
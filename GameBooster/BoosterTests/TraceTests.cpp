@@ -0,0 +1,44 @@
+﻿#define NOMINMAX
+
+#include "Trace.h"
+#include "Test.h"
+
+#include <string>
+#include <thread>
+
+namespace {
+
+    size_t Count(const std::string& text, const std::string& what) {
+        size_t n = 0;
+        for (size_t at = text.find(what); at != std::string::npos; at = text.find(what, at + 1)) ++n;
+        return n;
+    }
+
+} // namespace
+
+TEST_CASE(TraceRecordsSpansAsChromeJson) {
+    std::thread([] {
+        Trace::NameThread("trace-json");
+        Trace::Scope span("Outer", "test", "with \"quotes\"");
+        Trace::Scope inner("Inner", "test");
+        }).join();
+    const std::string json = Trace::ChromeJson();
+    CHECK(Count(json, "\"name\":\"trace-json\"") == 1);
+    CHECK(Count(json, "\"name\":\"Outer\"") == 2);
+    CHECK(Count(json, "\"name\":\"Inner\"") == 2);
+    CHECK(json.find("with \\\"quotes\\\"") != std::string::npos);
+}
+
+TEST_CASE(TraceReusesBuffersOfExitedThreads) {
+    // One client connection after another, as the daemon serves them.
+    for (int i = 0; i < 50; ++i) {
+        std::thread([] {
+            Trace::NameThread("trace-reuse");
+            Trace::Scope span("Client", "test");
+            }).join();
+    }
+    const std::string json = Trace::ChromeJson();
+    // Each thread took over the last one's buffer, and its events with it.
+    CHECK(Count(json, "\"name\":\"trace-reuse\"") == 1);
+    CHECK(Count(json, "\"name\":\"Client\"") == 2);
+}
@@ -0,0 +1,310 @@
+﻿#define NOMINMAX
+#define _CRT_SECURE_NO_WARNINGS
+#include "BoostBench.h"
+
+#include <windows.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+#include "Engine.h"
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+namespace BoostBench {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        double MsSince(Clock::time_point t0, Clock::time_point t1) {
+            return std::chrono::duration<double, std::milli>(t1 - t0).count();
+        }
+
+        // ------------------------------------------------------------
+        // Work kernels
+        // ------------------------------------------------------------
+
+        uint64_t CpuWork(uint64_t iterations, uint64_t seed) {
+            uint64_t h = seed;
+            for (uint64_t i = 0; i < iterations; ++i) {
+                h = h * 6364136223846793005ull + 1442695040888963407ull;
+                h ^= h >> 29;
+            }
+            return h;
+        }
+
+        // Random cache-line read-modify-writes over `lines` lines.
+        uint64_t MemoryWork(std::vector<uint64_t>& buf, uint64_t touches, uint64_t seed) {
+            const uint64_t lines = buf.size() / 8;
+            uint64_t h = seed, sum = 0;
+            for (uint64_t i = 0; i < touches; ++i) {
+                h = h * 6364136223846793005ull + 1442695040888963407ull;
+                uint64_t& cell = buf[((h >> 17) % lines) * 8];
+                sum += cell++;
+            }
+            return sum;
+        }
+
+        std::vector<uint64_t> MakeBuffer(uint32_t megabytes) {
+            const size_t n = std::max<size_t>(megabytes, 1) * (1u << 20) / sizeof(uint64_t);
+            return std::vector<uint64_t>(n, 1);
+        }
+
+        volatile uint64_t g_sink;
+
+        // ------------------------------------------------------------
+        // Frame pacing
+        // ------------------------------------------------------------
+
+        class FrameTimer {
+        public:
+            FrameTimer() {
+                timer_ = CreateWaitableTimerExW(nullptr, nullptr,
+                    CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+                // Pre-1803 Windows: coarse timer, topped up by spinning.
+                if (!timer_) timer_ = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+            }
+            ~FrameTimer() { if (timer_) CloseHandle(timer_); }
+
+            void WaitUntil(Clock::time_point deadline) {
+                const auto remaining = deadline - Clock::now();
+                const auto ticks = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count() / 100;
+                if (timer_ && ticks > 0) {
+                    LARGE_INTEGER due;
+                    due.QuadPart = -ticks;
+                    if (SetWaitableTimer(timer_, &due, 0, nullptr, nullptr, FALSE))
+                        WaitForSingleObject(timer_, INFINITE);
+                }
+                while (Clock::now() < deadline) YieldProcessor();
+            }
+
+        private:
+            HANDLE timer_ = nullptr;
+        };
+
+        // ------------------------------------------------------------
+        // Child processes
+        // ------------------------------------------------------------
+
+        struct Child {
+            HANDLE process = nullptr;
+            HANDLE thread = nullptr;
+
+            ~Child() {
+                if (thread) CloseHandle(thread);
+                if (process) CloseHandle(process);
+            }
+        };
+
+        bool Spawn(const std::string& exe, const std::string& args, HANDLE job, Child& child) {
+            std::string cmd = "\"" + exe + "\" " + args;
+            STARTUPINFOA si{ sizeof(si) };
+            PROCESS_INFORMATION pi{};
+            if (!CreateProcessA(exe.c_str(), &cmd[0], nullptr, nullptr, FALSE,
+                CREATE_SUSPENDED, nullptr, nullptr, &si, &pi))
+                return false;
+            child.process = pi.hProcess;
+            child.thread = pi.hThread;
+            AssignProcessToJobObject(job, pi.hProcess);
+            return true;
+        }
+
+        std::vector<double> ReadFrames(const std::string& path, uint32_t warmupMs) {
+            std::vector<double> frames;
+            std::ifstream in(path, std::ios::binary);
+            double ms, elapsed = 0;
+            while (in.read(reinterpret_cast<char*>(&ms), sizeof(ms))) {
+                elapsed += ms;
+                if (elapsed > warmupMs) frames.push_back(ms);
+            }
+            return frames;
+        }
+
+        std::string LastErrorText(const char* what) {
+            char buf[128];
+            snprintf(buf, sizeof(buf), "%s failed (error %lu)", what, GetLastError());
+            return buf;
+        }
+
+    } // namespace
+
+    Calibration Calibrate(const Workload& w) {
+        // Best of a few passes, split evenly between CPU and memory work.
+        constexpr uint64_t probe = 1u << 20;
+        std::vector<uint64_t> buf = MakeBuffer(w.memoryMb);
+        g_sink = MemoryWork(buf, probe, 1);
+        double cpuMs = 1e9, memMs = 1e9;
+        for (int pass = 0; pass < 3; ++pass) {
+            auto t0 = Clock::now();
+            g_sink = CpuWork(probe, pass);
+            auto t1 = Clock::now();
+            g_sink = MemoryWork(buf, probe, pass);
+            auto t2 = Clock::now();
+            cpuMs = std::min(cpuMs, MsSince(t0, t1));
+            memMs = std::min(memMs, MsSince(t1, t2));
+        }
+        Calibration c;
+        c.cpuIterations = static_cast<uint64_t>(probe * (w.workMs / 2) / std::max(cpuMs, 1e-3));
+        c.memoryTouches = static_cast<uint64_t>(probe * (w.workMs / 2) / std::max(memMs, 1e-3));
+        return c;
+    }
+
+    int RunGame(const Workload& w, const Calibration& c, const std::string& outFile) {
+        std::vector<uint64_t> buf = MakeBuffer(w.memoryMb);
+        std::vector<double> frames;
+        frames.reserve(static_cast<size_t>(w.seconds * 1000 / w.frameMs) + 16);
+
+        FrameTimer timer;
+        const auto frame = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double, std::milli>(w.frameMs));
+        const auto start = Clock::now();
+        const auto end = start + std::chrono::seconds(w.seconds);
+        auto present = start, next = start + frame;
+        for (uint64_t n = 0; present < end; ++n) {
+            g_sink = CpuWork(c.cpuIterations, n);
+            g_sink = MemoryWork(buf, c.memoryTouches, n);
+            timer.WaitUntil(next);
+            const auto now = Clock::now();
+            frames.push_back(MsSince(present, now));
+            present = now;
+            // A late frame does not earn a burst of catch-up frames.
+            next = std::max(next + frame, now);
+        }
+
+        std::ofstream out(outFile, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(frames.data()), frames.size() * sizeof(double));
+        return out ? 0 : 1;
+    }
+
+    int RunLoad(uint32_t threads) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<std::thread> workers;
+        for (uint32_t t = 0; t < threads; ++t)
+            workers.emplace_back([t] {
+                std::vector<uint64_t> buf = MakeBuffer(16);
+                for (uint64_t n = t;; ++n) {
+                    g_sink = CpuWork(1u << 16, n);
+                    g_sink = MemoryWork(buf, 1u << 12, n);
+                }
+                });
+        for (auto& w : workers) w.join();
+        return 0;
+    }
+
+    bool Execute(const Options& opts, Report& report,
+        const std::function<void(const RunResult&)>& progress) {
+        char self[MAX_PATH], temp[MAX_PATH];
+        if (!GetModuleFileNameA(nullptr, self, MAX_PATH) || !GetTempPathA(MAX_PATH, temp)) {
+            report.error = LastErrorText("Locating executable");
+            return false;
+        }
+        // The game needs a name of its own so boosting it touches nothing else.
+        const std::string gamePath = std::string(temp) + GameExe;
+        if (!CopyFileA(self, gamePath.c_str(), FALSE)) {
+            report.error = LastErrorText("Copying benchmark game");
+            return false;
+        }
+
+        // Children die with us, even if we are killed mid-run.
+        HANDLE job = CreateJobObjectA(nullptr, nullptr);
+        if (!job) {
+            report.error = LastErrorText("CreateJobObject");
+            return false;
+        }
+        JOBOBJECT_EXTENDED_LIMIT_INFORMATION limits{};
+        limits.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
+        SetInformationJobObject(job, JobObjectExtendedLimitInformation, &limits, sizeof(limits));
+
+        Booster::EngineOptions engineOpts;
+        if (!opts.killProcesses) engineOpts.killList.clear();
+        Booster::Engine engine(engineOpts);
+
+        const Calibration cal = Calibrate(opts.workload);
+        const Workload& w = opts.workload;
+        std::vector<double> sides[2];
+
+        for (uint32_t i = 0; i < opts.runs && report.error.empty(); ++i) {
+            RunResult run;
+            run.index = i;
+            run.boosted = (i % 2) == 1;
+
+            char outFile[MAX_PATH];
+            if (!GetTempFileNameA(temp, "gbb", 0, outFile)) {
+                report.error = LastErrorText("GetTempFileName");
+                break;
+            }
+
+            char args[256];
+            snprintf(args, sizeof(args), "--synthetic-load %u", opts.loadThreads);
+            Child load;
+            if (!Spawn(self, args, job, load)) {
+                report.error = LastErrorText("Starting load");
+                break;
+            }
+            ResumeThread(load.thread);
+
+            snprintf(args, sizeof(args),
+                "--synthetic-game --frame-ms %.4f --seconds %u --memory-mb %u "
+                "--cpu-iters %llu --mem-touches %llu --out",
+                w.frameMs, w.seconds, w.memoryMb,
+                static_cast<unsigned long long>(cal.cpuIterations),
+                static_cast<unsigned long long>(cal.memoryTouches));
+            Child game;
+            if (!Spawn(gamePath, std::string(args) + " \"" + outFile + "\"", job, game)) {
+                report.error = LastErrorText("Starting game");
+                TerminateProcess(load.process, 0);
+                break;
+            }
+            // Boost while suspended so the first frame already sees it.
+            if (run.boosted) engine.ForceEnter(GameExe);
+            ResumeThread(game.thread);
+
+            const DWORD limit = (w.seconds + 30) * 1000;
+            DWORD exitCode = 1;
+            if (WaitForSingleObject(game.process, limit) != WAIT_OBJECT_0) {
+                TerminateProcess(game.process, 1);
+                report.error = "Benchmark game did not finish";
+            }
+            else {
+                GetExitCodeProcess(game.process, &exitCode);
+            }
+            if (run.boosted) engine.ForceExit();
+            TerminateProcess(load.process, 0);
+            WaitForSingleObject(load.process, 5000);
+
+            std::vector<double> frames = ReadFrames(outFile, opts.warmupMs);
+            DeleteFileA(outFile);
+            if (report.error.empty() && (exitCode != 0 || frames.empty()))
+                report.error = "Benchmark game produced no frames";
+            if (!report.error.empty()) break;
+
+            run.summary = FrameStats::Summarize(frames, w.frameMs);
+            auto& side = sides[run.boosted];
+            side.insert(side.end(), frames.begin(), frames.end());
+            report.runs.push_back(run);
+            if (progress) progress(run);
+        }
+
+        CloseHandle(job);
+        DeleteFileA(gamePath.c_str());
+        if (!report.error.empty()) return false;
+
+        report.unboosted = FrameStats::Summarize(sides[0], w.frameMs);
+        report.boosted = FrameStats::Summarize(sides[1], w.frameMs);
+        std::vector<double> means[2], p99s[2];
+        for (const auto& r : report.runs) {
+            means[r.boosted].push_back(r.summary.meanMs);
+            p99s[r.boosted].push_back(r.summary.p99Ms);
+        }
+        report.mean = FrameStats::Compare(means[1], means[0]);
+        report.p99 = FrameStats::Compare(p99s[1], p99s[0]);
+        return true;
+    }
+
+} // namespace BoostBench
@@ -0,0 +1,69 @@
+﻿#pragma once
+
+#include "FrameStats.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// ============================================================
+// BOOST A/B BENCHMARK
+// ============================================================
+//
+// Measures what Game Mode buys on this machine. A synthetic game (a copy
+// of this exe under its own name) renders fixed-cost frames at a target
+// frame time while load processes saturate every core. Runs alternate
+// between unboosted and boosted through Engine::ForceEnter. Each run's mean
+// and p99 frame time are compared between the two sides, run for run.
+
+namespace BoostBench {
+
+    constexpr const char* GameExe = "BoostBenchGame.exe";
+
+    struct Workload {
+        double   frameMs = 1000.0 / 60;
+        double   workMs = 8;        // CPU + memory work per frame on an idle machine
+        uint32_t memoryMb = 64;     // working set walked by the memory half
+        uint32_t seconds = 10;
+    };
+
+    // Per-frame work, fixed across runs so that only scheduling differs.
+    struct Calibration {
+        uint64_t cpuIterations = 0;
+        uint64_t memoryTouches = 0;
+    };
+
+    struct Options {
+        Workload workload;
+        uint32_t runs = 10;         // alternating, unboosted first
+        uint32_t loadThreads = 0;   // 0: one per logical processor
+        uint32_t warmupMs = 1000;   // discarded at the start of each run
+        bool     killProcesses = false;     // also run the engine's kill list
+    };
+
+    struct RunResult {
+        uint32_t index = 0;
+        bool     boosted = false;
+        FrameStats::Summary summary;
+    };
+
+    struct Report {
+        std::vector<RunResult> runs;
+        FrameStats::Summary    unboosted, boosted;     // all frames of a side
+        // Per-run statistics, boosted against unboosted.
+        FrameStats::Comparison mean, p99;
+        std::string            error;
+    };
+
+    Calibration Calibrate(const Workload& w);
+
+    // Child-process bodies, dispatched from WinMain. The game writes its
+    // frame times to `outFile` as raw doubles; the load runs until killed.
+    int RunGame(const Workload& w, const Calibration& c, const std::string& outFile);
+    int RunLoad(uint32_t threads);
+
+    bool Execute(const Options& opts, Report& report,
+        const std::function<void(const RunResult&)>& progress = {});
+
+} // namespace BoostBench
@@ -5,23 +5,42 @@
 #include <windowsx.h>
 #include <objidl.h>
 #include <gdiplus.h>
-#include <tlhelp32.h>
-#include <psapi.h>
 #include <shellapi.h>
 #include <commctrl.h>
 #include <dwmapi.h>
+#include <tlhelp32.h>
 
 #include <algorithm>
 #include <atomic>
+#include <cctype>
+#include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <iterator>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <string>
-#include <thread>
+#include <tuple>
 #include <vector>
 
+#include "BoostBench.h"
+#include "BoosterApi.h"
+#include "Detect.h"
+#include "Discovery.h"
+#include "Engine.h"
+#include "GameIndex.h"
+#include "Headroom.h"
+#include "Ipc.h"
+#include "PowerQos.h"
+#include "Pressure.h"
+#include "ProcessScan.h"
+#include "ProcessUtil.h"
+#include "Scene.h"
+
 #pragma comment(linker,"\"/manifestdependency:type='win32' name='Microsoft.Windows.Common-Controls' version='6.0.0.0' processorArchitecture='*' publicKeyToken='6595b64144ccf1df' language='*'\"")
 #pragma comment(lib, "psapi.lib")
 #pragma comment(lib, "shell32.lib")
@@ -78,37 +97,33 @@ namespace Theme {
     constexpr COLORREF EditBg = RGB(24, 24, 32);
 }
 
-namespace Layout {
-    constexpr int MinWindowW = 420, MinWindowH = 480;
-    constexpr int InitialW = 480, InitialH = 580;
-    constexpr int Padding = 24;
-    constexpr int RadiusLg = 12, RadiusSm = 8, RadiusXs = 6;
-    constexpr int ControlH = 44, ItemH = 52;
-    constexpr int Gap = 16, GapSm = 12, GapXs = 8;
-    constexpr int AddBtnW = 100, RemoveBtnW = 140;
-    constexpr float ListPadX = 14.f, ListPadY = 8.f;
-    constexpr float EditInset = 12.f;
-
-    // Typography
-    constexpr int FontSizeTitle = 24;
-    constexpr int FontSizeBody = 13;
-    constexpr int FontSizeLabel = 11;
-    constexpr int FontSizeStatus = 12;
-}
-
-enum ControlID { ID_INPUT = 100, ID_BTN_ADD, ID_BTN_REMOVE, ID_TRAY = 1000 };
-
 constexpr UINT     WM_TRAYICON = WM_USER + 1;
+constexpr UINT     WM_ENGINE_CHANGED = WM_USER + 2;
 constexpr UINT_PTR TIMER_ANIM = 1;
+constexpr UINT_PTR TIMER_SYNC = 2;
 constexpr float    ANIM_SPEED = 0.12f;
 
 static const char* const CONFIG_FILE = "games.txt";
+static const char* const RULES_FILE = "rules.txt";
+static const char* const HISTORY_FILE = "history.bin";
+static const char* const JOURNAL_FILE = "journal.bin";
+static const char* const DISCOVERY_INDEX = "discovery.idx";
+static const char* const DETECT_MEMORY = "detect.txt";
 static UINT WM_TASKBARCREATED = 0;
 
 // ============================================================
 // UTILITY FUNCTIONS
 // ============================================================
 
+static Booster::EngineOptions DefaultEngineOptions() {
+    Booster::EngineOptions opts;
+    opts.configFile = CONFIG_FILE;
+    opts.rulesFile = RULES_FILE;
+    opts.historyFile = HISTORY_FILE;
+    opts.journalFile = JOURNAL_FILE;
+    return opts;
+}
+
 static float Lerp(float a, float b, float t) {
     return a + (b - a) * t;
 }
@@ -132,130 +147,150 @@ static Color ApplyPressEffect(const Color& c, float press) {
         static_cast<BYTE>(c.GetB() * factor));
 }
 
-static std::string ToLower(std::string s) {
-    std::transform(s.begin(), s.end(), s.begin(),
-        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
-    return s;
-}
-
 static std::wstring ToWide(const std::string& s) {
     return { s.begin(), s.end() };
 }
 
+static RectF ToRectF(const Scene::Rect& r) {
+    return { r.X, r.Y, r.Width, r.Height };
+}
+
 // ============================================================
-// RAII DOUBLE BUFFER
+// BACK BUFFER
 // ============================================================
 
-class DoubleBuffer {
+// Lives as long as the window keeps its size, so a paint only redraws the
+// regions that changed and an exposure is a plain blit.
+class BackBuffer {
 public:
-    DoubleBuffer(HDC target, int w, int h)
-        : target_(target), w_(w), h_(h)
-    {
+    BackBuffer() = default;
+    ~BackBuffer() { Release(); }
+
+    BackBuffer(const BackBuffer&) = delete;
+    BackBuffer& operator=(const BackBuffer&) = delete;
+
+    // True when the contents were (re)allocated and must be redrawn whole.
+    bool Ensure(HDC target, int w, int h) {
+        if (memDC_ && w == w_ && h == h_) return false;
+        Release();
         memDC_ = CreateCompatibleDC(target);
-        bitmap_ = CreateCompatibleBitmap(target, w, h);
+        bitmap_ = CreateCompatibleBitmap(target, std::max(w, 1), std::max(h, 1));
         old_ = static_cast<HBITMAP>(SelectObject(memDC_, bitmap_));
+        w_ = w;
+        h_ = h;
+        return true;
+    }
+
+    void Present(HDC target, const RECT& r) const {
+        BitBlt(target, r.left, r.top, r.right - r.left, r.bottom - r.top,
+            memDC_, r.left, r.top, SRCCOPY);
     }
 
-    ~DoubleBuffer() {
-        BitBlt(target_, 0, 0, w_, h_, memDC_, 0, 0, SRCCOPY);
+    void Release() {
+        if (!memDC_) return;
         SelectObject(memDC_, old_);
         DeleteObject(bitmap_);
         DeleteDC(memDC_);
+        memDC_ = nullptr;
+        w_ = h_ = 0;
     }
 
-    DoubleBuffer(const DoubleBuffer&) = delete;
-    DoubleBuffer& operator=(const DoubleBuffer&) = delete;
-
     HDC GetDC() const { return memDC_; }
 
 private:
-    HDC target_, memDC_;
-    HBITMAP bitmap_, old_;
-    int w_, h_;
+    HDC     memDC_ = nullptr;
+    HBITMAP bitmap_ = nullptr, old_ = nullptr;
+    int     w_ = 0, h_ = 0;
 };
 
 // ============================================================
-// LAYOUT METRICS
+// RESOURCE CACHE
 // ============================================================
 
-struct Metrics {
-    float x = 0.f, contentWidth = 0.f;
-    float titleY = 0.f, subtitleY = 0.f, lineY = 0.f, addLabelY = 0.f;
-    RectF inputRect, addBtnRect;
-    float listLabelY = 0.f;
-    RectF listRect, removeBtnRect, statusRect;
-
-    void Compute(int w, int h) {
-        x = static_cast<float>(Layout::Padding);
-        contentWidth = static_cast<float>(w - Layout::Padding * 2);
-        float y = x;
-
-        titleY = y;  y += Layout::FontSizeTitle + Layout::GapXs;
-        subtitleY = y;  y += Layout::FontSizeBody + Layout::GapSm;
-        lineY = y;  y += Layout::Gap + Layout::GapXs;
-        addLabelY = y;  y += Layout::FontSizeLabel + Layout::GapXs;
-
-        const float inputW = contentWidth - Layout::AddBtnW - Layout::GapSm;
-        inputRect = { x, y, inputW, static_cast<float>(Layout::ControlH) };
-        addBtnRect = { x + inputW + Layout::GapSm, y,
-                       static_cast<float>(Layout::AddBtnW),
-                       static_cast<float>(Layout::ControlH) };
-        y += Layout::ControlH + Layout::Gap;
-
-        listLabelY = y;  y += Layout::FontSizeLabel + Layout::GapSm;
-
-        // Space below list: Gap + remove button + Gap + status bar + padding
-        const float spaceBelow = Layout::Gap * 2.f + Layout::ControlH * 2.f + Layout::Padding;
-        float listH = static_cast<float>(h) - y - spaceBelow;
-
-        if (listH < 0.f) listH = 0.f;
-        listRect = { x, y, contentWidth, listH };
-        y += listH + Layout::Gap;
-
-        removeBtnRect = { x, y, static_cast<float>(Layout::RemoveBtnW),
-                          static_cast<float>(Layout::ControlH) };
-        y += Layout::ControlH + Layout::Gap;
-        statusRect = { x, y, contentWidth, static_cast<float>(Layout::ControlH) };
+// GDI+ objects the painters would otherwise build on every draw call.
+// Round-rect paths are cached at the origin by size and translated into place.
+class Resources {
+public:
+    Gdiplus::Font* Font(int px, int style) {
+        auto& f = fonts_[{ px, style }];
+        if (!f) {
+            if (!family_) family_ = std::make_unique<FontFamily>(L"Segoe UI");
+            f = std::make_unique<Gdiplus::Font>(family_.get(), static_cast<REAL>(px), style, UnitPixel);
+        }
+        return f.get();
     }
 
-    void GetEditPosition(int& ex, int& ey, int& ew, int& eh) const {
-        ex = static_cast<int>(inputRect.X + Layout::EditInset);
-        ey = static_cast<int>(inputRect.Y + Layout::EditInset);
-        ew = static_cast<int>(inputRect.Width - Layout::EditInset * 2);
-        eh = static_cast<int>(Layout::ControlH - Layout::EditInset * 2);
+    SolidBrush* Brush(const Color& c) {
+        // Animated colours pass through here too; keep the set bounded.
+        if (brushes_.size() > 64) brushes_.clear();
+        auto& b = brushes_[c.GetValue()];
+        if (!b) b = std::make_unique<SolidBrush>(c);
+        return b.get();
     }
 
-    int VisibleListHeight() const {
-        return static_cast<int>(listRect.Height - Layout::ListPadY * 2);
+    Pen* Stroke(const Color& c, float width = 1.f) {
+        if (pens_.size() > 64) pens_.clear();
+        auto& p = pens_[{ c.GetValue(), static_cast<int>(width * 4) }];
+        if (!p) p = std::make_unique<Pen>(c, width);
+        return p.get();
     }
 
-    int MaxScroll(int count) const {
-        int total = count * Layout::ItemH;
-        int visible = VisibleListHeight();
-        return (total > visible) ? total - visible : 0;
+    const StringFormat* Centered() {
+        if (!centered_) {
+            centered_ = std::make_unique<StringFormat>();
+            centered_->SetAlignment(StringAlignmentCenter);
+            centered_->SetLineAlignment(StringAlignmentCenter);
+        }
+        return centered_.get();
     }
 
-    int HitTestButton(int mx, int my) const {
-        auto contains = [mx, my](const RectF& r) {
-            return mx >= r.X && mx <= r.X + r.Width
-                && my >= r.Y && my <= r.Y + r.Height;
-            };
-        if (contains(addBtnRect))    return ID_BTN_ADD;
-        if (contains(removeBtnRect)) return ID_BTN_REMOVE;
-        return -1;
+    const StringFormat* LeftCentered() {
+        if (!leftCentered_) {
+            leftCentered_ = std::make_unique<StringFormat>();
+            leftCentered_->SetAlignment(StringAlignmentNear);
+            leftCentered_->SetLineAlignment(StringAlignmentCenter);
+            leftCentered_->SetTrimming(StringTrimmingEllipsisCharacter);
+        }
+        return leftCentered_.get();
     }
 
-    int HitTestItem(int mx, int my, int count, int scrollY) const {
-        const float lx = listRect.X + Layout::ListPadX;
-        const float ly = listRect.Y + Layout::ListPadY;
-        const float lw = listRect.Width - Layout::ListPadX * 2;
-        const float lh = listRect.Height - Layout::ListPadY * 2;
+    GraphicsPath* RoundRect(float w, float h, float radius) {
+        // Keyed by size, so a resize drag mints a new one per frame.
+        if (paths_.size() > 64) paths_.clear();
+        auto& path = paths_[{ static_cast<int>(w * 4), static_cast<int>(h * 4),
+                              static_cast<int>(radius * 4) }];
+        if (!path) {
+            path = std::make_unique<GraphicsPath>();
+            float d = radius * 2;
+            if (d > w) d = w;
+            if (d > h) d = h;
+            path->AddArc(0.f, 0.f, d, d, 180, 90);
+            path->AddArc(w - d, 0.f, d, d, 270, 90);
+            path->AddArc(w - d, h - d, d, d, 0, 90);
+            path->AddArc(0.f, h - d, d, d, 90, 90);
+            path->CloseFigure();
+        }
+        return path.get();
+    }
 
-        if (mx < lx || mx > lx + lw || my < ly || my > ly + lh)
-            return -1;
-        const int idx = static_cast<int>((my - ly + scrollY) / Layout::ItemH);
-        return (idx >= 0 && idx < count) ? idx : -1;
+    // Must run before GdiplusShutdown.
+    void Release() {
+        paths_.clear();
+        pens_.clear();
+        brushes_.clear();
+        fonts_.clear();
+        family_.reset();
+        centered_.reset();
+        leftCentered_.reset();
     }
+
+private:
+    std::unique_ptr<FontFamily> family_;
+    std::map<std::pair<int, int>, std::unique_ptr<Gdiplus::Font>> fonts_;
+    std::map<ARGB, std::unique_ptr<SolidBrush>> brushes_;
+    std::map<std::pair<ARGB, int>, std::unique_ptr<Pen>> pens_;
+    std::map<std::tuple<int, int, int>, std::unique_ptr<GraphicsPath>> paths_;
+    std::unique_ptr<StringFormat> centered_, leftCentered_;
 };
 
 // ============================================================
@@ -271,86 +306,236 @@ struct App {
     HFONT    hFont = nullptr;
     HBRUSH   hEditBrush = nullptr;
     NOTIFYICONDATAA trayIcon{};
-    Metrics  metrics;
+    Scene::Metrics metrics;
+    BackBuffer     backBuffer;
+    Resources      res;
+    Scene::State   shown;      // as of the last invalidation
+    std::vector<Scene::Rect> pending;   // stale in the back buffer
 
     std::map<int, ButtonAnim> buttonAnims;
     float pulsePhase = 0.f, pulseValue = 0.f;
-    int   hoveredItem = -1, selectedItem = -1, scrollY = 0;
+    int   hoveredItem = -1, scrollY = 0;      // hoveredItem is a view row
     bool  inputFocused = false;
     int   hoveredButton = -1, pressedButton = -1;
-
-    std::vector<std::string>           games;
+    bool  inTray = false;
+
+    // The list is virtualized: only the rows on screen are ever resolved.
+    GameIndex::Index                   games;          // mirror of the engine's list
+    GameIndex::View                    view;           // rows matching the input box
+    std::string                        selectedGame;   // by name; always a row of `view`
+    uint32_t                           gamesRevision = 0;
+    uint64_t                           listRevision = 0;   // bumped when the rows change
     mutable std::mutex                 gamesMutex;
-    std::atomic<bool>                  running{ true };
-    std::atomic<bool>                  gameModeActive{ false };
-    std::string                        activeGameName;
-    std::map<std::string, std::string> killedProcesses;
-    std::string                        statusText = "Ready - Monitoring for games";
-    mutable std::mutex                 statusMutex;
+    // Status is read lock-free: straight from the hosted engine's channel,
+    // or from `mirror`, which Sync fills when talking to a daemon.
+    Events::Channel                    mirror;
+    const Events::Channel*             channel = &mirror;
+
+    // Either we host the engine (and serve the control pipe for tooling)
+    // or a daemon already does and we are just another client.
+    std::unique_ptr<Booster::Engine>   engine;
+    std::unique_ptr<Ipc::Server>       server;
+    std::unique_ptr<Ipc::Client>       remote;
+    std::unique_ptr<Telemetry::Exporter> exporter;
+    Booster::Control*                  control = nullptr;
+    bool                               clientMode = false;
+
+    Scene::State Capture() const {
+        Scene::State s;
+        s.width = metrics.width;
+        s.height = metrics.height;
+        s.inputFocused = inputFocused;
+        if (auto it = buttonAnims.find(ID_BTN_ADD); it != buttonAnims.end()) {
+            s.addHover = it->second.hover;
+            s.addPress = it->second.press;
+        }
+        if (auto it = buttonAnims.find(ID_BTN_REMOVE); it != buttonAnims.end()) {
+            s.removeHover = it->second.hover;
+            s.removePress = it->second.press;
+        }
+        {
+            std::lock_guard lock(gamesMutex);
+            s.listRevision = listRevision;
+            s.gameCount = static_cast<int>(view.Size(games));
+            s.selectedItem = SelectedRowLocked();
+        }
+        s.hoveredItem = hoveredItem;
+        s.scrollY = scrollY;
+        s.pulse = pulseValue;
+        const Events::Snapshot st = Status();
+        s.active = st.active;
+        s.status = st.text;
+        return s;
+    }
 
-    const std::vector<std::string> processKillList{
-        "explorer.exe", "SearchHost.exe"
-    };
+    // Invalidates only what changed since the last call.
+    void RequestRedraw() {
+        if (!hWnd) return;
+        const Scene::State now = Capture();
+        for (const auto& r : Scene::Diff(shown, now, metrics)) {
+            const RECT rc{ static_cast<LONG>(r.X), static_cast<LONG>(r.Y),
+                           static_cast<LONG>(r.Right()), static_cast<LONG>(r.Bottom()) };
+            InvalidateRect(hWnd, &rc, FALSE);
+            pending.push_back(r);
+        }
+        // Hidden windows get no WM_PAINT; keep the backlog from growing.
+        Scene::Coalesce(pending);
+        shown = now;
+    }
 
-    void RequestRedraw() const {
-        if (hWnd) InvalidateRect(hWnd, nullptr, FALSE);
+    Events::Snapshot Status() const {
+        Events::Snapshot s;
+        channel->Read(s);
+        return s;
     }
 
-    void SetStatus(const std::string& s) {
-        { std::lock_guard lock(statusMutex); statusText = s; }
-        RequestRedraw();
+    void ConnectEngine(const Telemetry::Exporter::Options& metricsOpts,
+        const Booster::EngineOptions& engineOpts) {
+        remote = Ipc::Client::Connect(500);
+        if (remote) {
+            clientMode = true;
+            control = remote.get();
+            return;
+        }
+        engine = std::make_unique<Booster::Engine>(engineOpts);
+        engine->LoadGames();
+        // Errors show in the status bar.
+        engine->LoadRules();
+        engine->SetOnChange([this] {
+            if (hWnd) PostMessage(hWnd, WM_ENGINE_CHANGED, 0, 0);
+            });
+        server = std::make_unique<Ipc::Server>(*engine);
+        server->Start();
+        if (metricsOpts.port || !metricsOpts.textfile.empty()) {
+            exporter = std::make_unique<Telemetry::Exporter>(engine->Metrics());
+            exporter->Start(metricsOpts);
+        }
+        engine->Start();
+        control = engine.get();
+        channel = &engine->Channel();
     }
 
-    std::string GetStatus() const {
-        std::lock_guard lock(statusMutex);
-        return statusText;
+    void DisconnectEngine() {
+        control = nullptr;
+        channel = &mirror;
+        exporter.reset();
+        server.reset();
+        engine.reset();
+        remote.reset();
     }
 
-    void LoadGames() {
-        std::lock_guard lock(gamesMutex);
-        games.clear();
-        std::ifstream file(CONFIG_FILE);
-        for (std::string line; std::getline(file, line);)
-            if (!line.empty()) games.push_back(line);
+    // Mirrors a daemon's status into `mirror`.
+    bool PullRemoteStatus() {
+        Booster::StatusInfo st;
+        bool ok = remote && remote->GetStatus(st);
+        if (!ok) {
+            remote = Ipc::Client::Connect();
+            control = remote.get();
+            gamesRevision = 0;
+            ok = remote && remote->GetStatus(st);
+        }
+        mirror.Update([&](Events::Snapshot& s) {
+            s.active = ok && st.active;
+            s.forced = ok && st.forced;
+            s.revision = st.revision;
+            Events::Copy(s.game, st.game);
+            Events::Copy(s.text, ok ? st.text : "Booster service unavailable");
+            });
+        return ok;
     }
 
-    void SaveGames() const {
-        std::vector<std::string> snapshot;
-        { std::lock_guard lock(gamesMutex); snapshot = games; }
-        std::ofstream file(CONFIG_FILE);
-        for (const auto& game : snapshot) file << game << '\n';
+    // Pulls status and, when its revision moved, the game list.
+    void Sync() {
+        if (clientMode && !PullRemoteStatus()) {
+            RequestRedraw();
+            return;
+        }
+        if (!control) return;
+
+        const Events::Snapshot st = Status();
+        if (st.revision != gamesRevision) {
+            std::vector<std::string> list;
+            if (control->ListGames(list)) {
+                {
+                    std::lock_guard lock(gamesMutex);
+                    games.Assign(std::move(list));
+                    gamesRevision = st.revision;
+                    if (view.Update(games, view.Query())) ++listRevision;
+                    if (SelectedRowLocked() < 0) selectedGame.clear();
+                }
+                ClampScroll();
+            }
+        }
+        RequestRedraw();
     }
 
     bool AddGame(const std::string& input) {
-        const std::string name = ToLower(input);
-        if (name.empty()) return false;
-        std::lock_guard lock(gamesMutex);
-        if (std::any_of(games.begin(), games.end(),
-            [&](const auto& g) { return g == name; }))
-            return false;
-        games.push_back(name);
+        if (!control || !control->AddGame(input)) return false;
+        std::string name = input;
+        std::transform(name.begin(), name.end(), name.begin(),
+            [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        ApplyLocal(name, true);
         return true;
     }
 
     bool RemoveSelected() {
-        std::lock_guard lock(gamesMutex);
-        if (selectedItem < 0 || selectedItem >= static_cast<int>(games.size()))
-            return false;
-        games.erase(games.begin() + selectedItem);
-        selectedItem = -1;
+        const std::string name = selectedGame;
+        if (name.empty() || !control || !control->RemoveGame(name)) return false;
+        selectedGame.clear();
+        ApplyLocal(name, false);
         return true;
     }
 
-    void ClampScroll() {
-        int count;
-        { std::lock_guard lock(gamesMutex); count = static_cast<int>(games.size()); }
-        scrollY = std::clamp(scrollY, 0, metrics.MaxScroll(count));
+    // Makes a change the engine just accepted in the mirror too, so an add
+    // or remove costs one index update rather than a re-fetch of the list.
+    // The list is only fetched again if something else changed it as well.
+    void ApplyLocal(const std::string& name, bool added) {
+        if (clientMode && !PullRemoteStatus()) {
+            RequestRedraw();
+            return;
+        }
+        const Events::Snapshot st = Status();
+        bool current;
+        {
+            std::lock_guard lock(gamesMutex);
+            if (added) games.Insert(name);
+            else games.Erase(name);
+            current = st.revision == gamesRevision + 1;
+            if (current) gamesRevision = st.revision;
+            if (view.Update(games, view.Query())) ++listRevision;
+            if (SelectedRowLocked() < 0) selectedGame.clear();
+        }
+        ClampScroll();
+        if (current) RequestRedraw();
+        else Sync();
+    }
+
+    // Narrows the list to games containing `text`; typing on refines the
+    // previous matches.
+    void Filter(const std::string& text) {
+        {
+            std::lock_guard lock(gamesMutex);
+            if (!view.Update(games, text)) return;
+            ++listRevision;
+            if (SelectedRowLocked() < 0) selectedGame.clear();
+        }
+        scrollY = 0;
+        hoveredItem = -1;
+        ClampScroll();
+        RequestRedraw();
     }
 
-    bool IsGameInList(const std::string& name) const {
+    int SelectedRowLocked() const {
+        return selectedGame.empty() ? -1 : view.Find(games, selectedGame);
+    }
+
+    int RowCount() const {
         std::lock_guard lock(gamesMutex);
-        return std::any_of(games.begin(), games.end(),
-            [&](const auto& g) { return g == name; });
+        return static_cast<int>(view.Size(games));
+    }
+
+    void ClampScroll() {
+        scrollY = std::clamp(scrollY, 0, metrics.MaxScroll(RowCount()));
     }
 
     void CreateResources() {
@@ -363,6 +548,8 @@ struct App {
     void DestroyResources() {
         if (hFont) { DeleteObject(hFont); hFont = nullptr; }
         if (hEditBrush) { DeleteObject(hEditBrush); hEditBrush = nullptr; }
+        backBuffer.Release();
+        res.Release();
     }
 
     void AddTrayIcon() {
@@ -381,155 +568,60 @@ struct App {
         Shell_NotifyIconA(NIM_DELETE, &trayIcon);
     }
 
-    void UpdateLayout(int w, int h) {
-        metrics.Compute(w, h);
-        if (hInput) {
-            int ex, ey, ew, eh;
-            metrics.GetEditPosition(ex, ey, ew, eh);
-            SetWindowPos(hInput, nullptr, ex, ey, ew, eh, SWP_NOZORDER);
-        }
-        ClampScroll();
+    void StartTimers() {
+        SetTimer(hWnd, TIMER_ANIM, 16, nullptr);
+        if (clientMode) SetTimer(hWnd, TIMER_SYNC, 250, nullptr);
     }
-};
-
-static App g_app;
-
-// ============================================================
-// PROCESS UTILITIES
-// ============================================================
 
-namespace ProcessUtil {
-
-    void EnableDebugPrivilege() {
-        HANDLE tok;
-        if (!OpenProcessToken(GetCurrentProcess(),
-            TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &tok))
-            return;
-        LUID luid;
-        LookupPrivilegeValueA(nullptr, SE_DEBUG_NAME, &luid);
-        TOKEN_PRIVILEGES tp{};
-        tp.PrivilegeCount = 1;
-        tp.Privileges[0] = { luid, SE_PRIVILEGE_ENABLED };
-        AdjustTokenPrivileges(tok, FALSE, &tp, sizeof(tp), nullptr, nullptr);
-        CloseHandle(tok);
-    }
-
-    std::string GetForegroundProcessName() {
-        HWND fg = GetForegroundWindow();
-        if (!fg) return {};
-        DWORD pid = 0;
-        GetWindowThreadProcessId(fg, &pid);
-        HANDLE proc = OpenProcess(
-            PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, pid);
-        if (!proc) return {};
-        char path[MAX_PATH]{};
-        std::string name;
-        if (GetModuleFileNameExA(proc, nullptr, path, MAX_PATH)) {
-            name = path;
-            if (auto pos = name.find_last_of("\\/"); pos != std::string::npos)
-                name = name.substr(pos + 1);
-        }
-        CloseHandle(proc);
-        return name;
-    }
-
-    void SetPriorityByName(const std::string& name, DWORD priority) {
-        HANDLE snap = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-        if (snap == INVALID_HANDLE_VALUE) return;
-        PROCESSENTRY32 entry{ sizeof(entry) };
-        for (BOOL ok = Process32First(snap, &entry); ok;
-            ok = Process32Next(snap, &entry)) {
-            if (_stricmp(entry.szExeFile, name.c_str()) != 0) continue;
-            if (HANDLE h = OpenProcess(PROCESS_SET_INFORMATION, FALSE,
-                entry.th32ProcessID)) {
-                SetPriorityClass(h, priority);
-                CloseHandle(h);
-            }
-        }
-        CloseHandle(snap);
+    void StopTimers() {
+        KillTimer(hWnd, TIMER_ANIM);
+        KillTimer(hWnd, TIMER_SYNC);
     }
 
-} // namespace ProcessUtil
-
-// ============================================================
-// GAME MODE MANAGEMENT
-// ============================================================
-
-namespace GameMode {
-
-    void Enter(const std::string& gameName) {
-        if (g_app.gameModeActive) return;
-        g_app.SetStatus("Activating Game Mode...");
-
-        HANDLE snap = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-        if (snap != INVALID_HANDLE_VALUE) {
-            PROCESSENTRY32 entry{ sizeof(entry) };
-            for (BOOL ok = Process32First(snap, &entry); ok;
-                ok = Process32Next(snap, &entry)) {
-                for (const auto& target : g_app.processKillList) {
-                    if (_stricmp(entry.szExeFile, target.c_str()) != 0) continue;
-                    HANDLE proc = OpenProcess(
-                        PROCESS_TERMINATE | PROCESS_QUERY_INFORMATION | PROCESS_VM_READ,
-                        FALSE, entry.th32ProcessID);
-                    if (proc) {
-                        char path[MAX_PATH]{};
-                        g_app.killedProcesses[entry.szExeFile] =
-                            GetModuleFileNameExA(proc, nullptr, path, MAX_PATH)
-                            ? path : entry.szExeFile;
-                        TerminateProcess(proc, 0);
-                        CloseHandle(proc);
-                    }
-                    break;
-                }
-            }
-            CloseHandle(snap);
-        }
-
-        g_app.activeGameName = gameName;
-        ProcessUtil::SetPriorityByName(gameName, HIGH_PRIORITY_CLASS);
-        ProcessUtil::SetPriorityByName("svchost.exe", IDLE_PRIORITY_CLASS);
-        g_app.gameModeActive = true;
-        g_app.SetStatus("Game Mode Active - " + gameName);
+    // Hidden, the window should cost the game nothing: no timers, no
+    // render caches, and our pages handed back. The engine keeps running.
+    void HideToTray() {
+        if (inTray) return;
+        inTray = true;
+        ShowWindow(hWnd, SW_HIDE);
+        StopTimers();
+        backBuffer.Release();
+        res.Release();
+        pending.clear();
+        shown = {};
+        ProcessUtil::TrimSelf();
     }
 
-    void Exit() {
-        if (!g_app.gameModeActive) return;
-        g_app.SetStatus("Restoring Desktop...");
-
-        if (!g_app.activeGameName.empty())
-            ProcessUtil::SetPriorityByName(g_app.activeGameName, NORMAL_PRIORITY_CLASS);
-        ProcessUtil::SetPriorityByName("svchost.exe", NORMAL_PRIORITY_CLASS);
-
-        for (const auto& [name, path] : g_app.killedProcesses) {
-            const char* cmd = (ToLower(name) == "explorer.exe")
-                ? "explorer.exe" : path.c_str();
-            ShellExecuteA(nullptr, "open", cmd, nullptr, nullptr, SW_SHOWDEFAULT);
-            Sleep(200);
+    // Back to a fully painted window: the fresh back buffer forces a
+    // full repaint, done synchronously before we return.
+    void RestoreFromTray() {
+        if (!inTray) {
+            SetForegroundWindow(hWnd);
+            return;
         }
-
-        g_app.killedProcesses.clear();
-        g_app.activeGameName.clear();
-        g_app.gameModeActive = false;
-        Sleep(2000);
-        g_app.SetStatus("Ready - Monitoring for games");
+        inTray = false;
+        hoveredButton = pressedButton = hoveredItem = -1;
+        for (auto& [id, anim] : buttonAnims) anim = {};
+        Sync();
+        ShowWindow(hWnd, SW_SHOW);
+        ShowWindow(hWnd, SW_RESTORE);
+        UpdateWindow(hWnd);
+        StartTimers();
+        SetForegroundWindow(hWnd);
     }
 
-    void MonitorThreadFunc() {
-        ProcessUtil::EnableDebugPrivilege();
-        while (g_app.running) {
-            const std::string fg = ToLower(ProcessUtil::GetForegroundProcessName());
-            const bool isMonitored = g_app.IsGameInList(fg);
-
-            if (isMonitored && !g_app.gameModeActive)
-                Enter(fg);
-            else if (!isMonitored && g_app.gameModeActive)
-                Exit();
-
-            Sleep(1000);
+    void UpdateLayout(int w, int h) {
+        metrics.Compute(w, h);
+        if (hInput) {
+            int ex, ey, ew, eh;
+            metrics.GetEditPosition(ex, ey, ew, eh);
+            SetWindowPos(hInput, nullptr, ex, ey, ew, eh, SWP_NOZORDER);
         }
+        ClampScroll();
     }
+};
 
-} // namespace GameMode
+static App g_app;
 
 // ============================================================
 // DRAWING PRIMITIVES
@@ -537,38 +629,16 @@ namespace GameMode {
 
 namespace Draw {
 
-    std::unique_ptr<GraphicsPath> RoundRectPath(const RectF& r, float radius) {
-        auto path = std::make_unique<GraphicsPath>();
-        float d = radius * 2;
-        if (d > r.Width)  d = r.Width;
-        if (d > r.Height) d = r.Height;
-        path->AddArc(r.X, r.Y, d, d, 180, 90);
-        path->AddArc(r.X + r.Width - d, r.Y, d, d, 270, 90);
-        path->AddArc(r.X + r.Width - d, r.Y + r.Height - d, d, d, 0, 90);
-        path->AddArc(r.X, r.Y + r.Height - d, d, d, 90, 90);
-        path->CloseFigure();
-        return path;
-    }
-
     void FillRoundRect(Graphics& gfx, const RectF& r, float rad, const Brush* b) {
-        auto path = RoundRectPath(r, rad);
-        gfx.FillPath(b, path.get());
+        gfx.TranslateTransform(r.X, r.Y);
+        gfx.FillPath(b, g_app.res.RoundRect(r.Width, r.Height, rad));
+        gfx.ResetTransform();
     }
 
     void StrokeRoundRect(Graphics& gfx, const RectF& r, float rad, const Pen* p) {
-        auto path = RoundRectPath(r, rad);
-        gfx.DrawPath(p, path.get());
-    }
-
-    void SetupCentered(StringFormat& sf) {
-        sf.SetAlignment(StringAlignmentCenter);
-        sf.SetLineAlignment(StringAlignmentCenter);
-    }
-
-    void SetupLeftCentered(StringFormat& sf) {
-        sf.SetAlignment(StringAlignmentNear);
-        sf.SetLineAlignment(StringAlignmentCenter);
-        sf.SetTrimming(StringTrimmingEllipsisCharacter);
+        gfx.TranslateTransform(r.X, r.Y);
+        gfx.DrawPath(p, g_app.res.RoundRect(r.Width, r.Height, rad));
+        gfx.ResetTransform();
     }
 
 } // namespace Draw
@@ -582,6 +652,7 @@ namespace UI {
     void Button(Graphics& gfx, const RectF& rect, const wchar_t* text,
         bool primary, float hover, float press, bool enabled = true)
     {
+        Resources& res = g_app.res;
         const Color bgNormal = !enabled ? Theme::Disabled
             : primary ? Theme::BtnPrimary : Theme::BtnSecondary;
         const Color bgHover = !enabled ? Theme::Disabled
@@ -590,35 +661,30 @@ namespace UI {
         Color bg = LerpColor(bgNormal, bgHover, hover);
         bg = ApplyPressEffect(bg, press);
 
-        SolidBrush brush(bg);
-        Draw::FillRoundRect(gfx, rect, static_cast<float>(Layout::RadiusSm), &brush);
+        Draw::FillRoundRect(gfx, rect, static_cast<float>(Layout::RadiusSm), res.Brush(bg));
 
         if (!primary && enabled) {
-            Pen pen(Theme::Border);
             Draw::StrokeRoundRect(gfx, rect,
-                static_cast<float>(Layout::RadiusSm), &pen);
+                static_cast<float>(Layout::RadiusSm), res.Stroke(Theme::Border));
         }
 
-        FontFamily ff(L"Segoe UI");
-        Gdiplus::Font font(&ff, static_cast<REAL>(Layout::FontSizeBody), FontStyleBold, UnitPixel);
-        SolidBrush tb(enabled ? Theme::TextPrimary : Theme::TextDisabled);
-        StringFormat sf;
-        Draw::SetupCentered(sf);
-        gfx.DrawString(text, -1, &font, rect, &sf, &tb);
+        gfx.DrawString(text, -1, res.Font(Layout::FontSizeBody, FontStyleBold), rect,
+            res.Centered(), res.Brush(enabled ? Theme::TextPrimary : Theme::TextDisabled));
     }
 
     void GameItem(Graphics& gfx, const RectF& rect,
         const std::string& name, bool selected, bool hovered)
     {
+        Resources& res = g_app.res;
         if (selected) {
-            SolidBrush bg(Theme::AccentMuted);
-            Draw::FillRoundRect(gfx, rect, static_cast<float>(Layout::RadiusSm), &bg);
-            Pen border(Theme::Accent, 1.5f);
-            Draw::StrokeRoundRect(gfx, rect, static_cast<float>(Layout::RadiusSm), &border);
+            Draw::FillRoundRect(gfx, rect, static_cast<float>(Layout::RadiusSm),
+                res.Brush(Theme::AccentMuted));
+            Draw::StrokeRoundRect(gfx, rect, static_cast<float>(Layout::RadiusSm),
+                res.Stroke(Theme::Accent, 1.5f));
         }
         else if (hovered) {
-            SolidBrush bg(Theme::BgCardHover);
-            Draw::FillRoundRect(gfx, rect, static_cast<float>(Layout::RadiusSm), &bg);
+            Draw::FillRoundRect(gfx, rect, static_cast<float>(Layout::RadiusSm),
+                res.Brush(Theme::BgCardHover));
         }
 
         // Icon circle
@@ -626,60 +692,57 @@ namespace UI {
         const float ix = rect.X + 12, iy = rect.Y + (rect.Height - iconSz) / 2;
         const RectF iconR(ix, iy, iconSz, iconSz);
 
-        SolidBrush iconBg(selected ? Theme::Accent : Theme::BgSecondary);
-        Draw::FillRoundRect(gfx, iconR, static_cast<float>(Layout::RadiusSm), &iconBg);
+        Draw::FillRoundRect(gfx, iconR, static_cast<float>(Layout::RadiusSm),
+            res.Brush(selected ? Theme::Accent : Theme::BgSecondary));
 
-        FontFamily ff(L"Segoe UI");
-        Gdiplus::Font iconFont(&ff, static_cast<REAL>(Layout::FontSizeBody + 1), FontStyleBold, UnitPixel);
         const wchar_t letter[2] = {
             name.empty() ? L'G' : static_cast<wchar_t>(toupper(name[0])), 0
         };
-        SolidBrush letterBrush(selected ? Theme::TextPrimary : Theme::TextSecondary);
-        StringFormat cf;
-        Draw::SetupCentered(cf);
-        gfx.DrawString(letter, 1, &iconFont, iconR, &cf, &letterBrush);
+        gfx.DrawString(letter, 1, res.Font(Layout::FontSizeBody + 1, FontStyleBold), iconR,
+            res.Centered(), res.Brush(selected ? Theme::TextPrimary : Theme::TextSecondary));
 
         // Name text
         const float tx = ix + iconSz + 12;
         RectF textR(tx, rect.Y, rect.Width - tx + rect.X - 12, rect.Height);
-        Gdiplus::Font nameFont(&ff, static_cast<REAL>(Layout::FontSizeBody), FontStyleRegular, UnitPixel);
-        SolidBrush nameBrush(Theme::TextPrimary);
-        StringFormat tf;
-        Draw::SetupLeftCentered(tf);
-        gfx.DrawString(ToWide(name).c_str(), -1, &nameFont, textR, &tf, &nameBrush);
+        gfx.DrawString(ToWide(name).c_str(), -1, res.Font(Layout::FontSizeBody, FontStyleRegular),
+            textR, res.LeftCentered(), res.Brush(Theme::TextPrimary));
     }
 
     void StatusBar(Graphics& gfx, const RectF& rect, bool active,
-        float pulse, const std::string& text)
+        float pulse, const char* text)
     {
-        SolidBrush bg(Theme::BgCard);
-        Draw::FillRoundRect(gfx, rect, static_cast<float>(Layout::RadiusSm), &bg);
-        Pen border(Theme::Border);
-        Draw::StrokeRoundRect(gfx, rect, static_cast<float>(Layout::RadiusSm), &border);
+        Resources& res = g_app.res;
+        Draw::FillRoundRect(gfx, rect, static_cast<float>(Layout::RadiusSm),
+            res.Brush(Theme::BgCard));
+        Draw::StrokeRoundRect(gfx, rect, static_cast<float>(Layout::RadiusSm),
+            res.Stroke(Theme::Border));
 
-        constexpr float dotSz = 10.f;
+        constexpr float dotSz = Layout::StatusDot;
         const float dx = rect.X + 16, dy = rect.Y + (rect.Height - dotSz) / 2;
 
         if (active && pulse > 0) {
-            const float glow = dotSz + 8 * pulse;
-            SolidBrush gb(Color(static_cast<BYTE>(60 * pulse),
+            const float glow = dotSz + Layout::StatusGlow * pulse;
+            // Alpha in steps of 4, so the pulse reuses a handful of brushes.
+            const BYTE alpha = static_cast<BYTE>(static_cast<int>(60 * pulse) & ~3);
+            SolidBrush* gb = res.Brush(Color(alpha,
                 Theme::StatusActive.GetR(),
                 Theme::StatusActive.GetG(),
                 Theme::StatusActive.GetB()));
-            gfx.FillEllipse(&gb, RectF(dx - (glow - dotSz) / 2,
+            gfx.FillEllipse(gb, RectF(dx - (glow - dotSz) / 2,
                 dy - (glow - dotSz) / 2, glow, glow));
         }
 
-        SolidBrush dotBrush(active ? Theme::StatusActive : Theme::StatusReady);
-        gfx.FillEllipse(&dotBrush, RectF(dx, dy, dotSz, dotSz));
+        gfx.FillEllipse(res.Brush(active ? Theme::StatusActive : Theme::StatusReady),
+            RectF(dx, dy, dotSz, dotSz));
 
-        FontFamily ff(L"Segoe UI");
-        Gdiplus::Font font(&ff, static_cast<REAL>(Layout::FontSizeStatus), FontStyleRegular, UnitPixel);
         RectF tr(dx + dotSz + 12, rect.Y, rect.Width - dx - dotSz - 24, rect.Height);
-        SolidBrush tb(Theme::TextSecondary);
-        StringFormat sf;
-        Draw::SetupLeftCentered(sf);
-        gfx.DrawString(ToWide(text).c_str(), -1, &font, tr, &sf, &tb);
+        wchar_t wide[sizeof(Events::Snapshot::text)];
+        size_t n = 0;
+        for (; text[n] && n + 1 < std::size(wide); ++n)
+            wide[n] = static_cast<unsigned char>(text[n]);
+        wide[n] = 0;
+        gfx.DrawString(wide, static_cast<INT>(n), res.Font(Layout::FontSizeStatus, FontStyleRegular),
+            tr, res.LeftCentered(), res.Brush(Theme::TextSecondary));
     }
 
 } // namespace UI
@@ -688,20 +751,18 @@ namespace UI {
 // PAINT SECTIONS
 // ============================================================
 
+// Each section skips what lies outside `area`, the region being redrawn.
 namespace Painter {
 
-    void Header(Graphics& gfx, const Metrics& m) {
-        FontFamily ff(L"Segoe UI");
-
-        Gdiplus::Font titleFont(&ff, static_cast<REAL>(Layout::FontSizeTitle), FontStyleBold, UnitPixel);
-        SolidBrush titleBrush(Theme::TextPrimary);
-        gfx.DrawString(L"Game Booster", -1, &titleFont,
-            PointF(m.x, m.titleY), &titleBrush);
+    void Header(Graphics& gfx, const Scene::Metrics& m, const Scene::Rect& area) {
+        if (!area.Intersects(m.HeaderRect())) return;
+        Resources& res = g_app.res;
 
-        Gdiplus::Font subFont(&ff, static_cast<REAL>(Layout::FontSizeBody), FontStyleRegular, UnitPixel);
-        SolidBrush subBrush(Theme::TextSecondary);
-        gfx.DrawString(L"Optimize your system for gaming", -1, &subFont,
-            PointF(m.x, m.subtitleY), &subBrush);
+        gfx.DrawString(L"Game Booster", -1, res.Font(Layout::FontSizeTitle, FontStyleBold),
+            PointF(m.x, m.titleY), res.Brush(Theme::TextPrimary));
+        gfx.DrawString(L"Optimize your system for gaming", -1,
+            res.Font(Layout::FontSizeBody, FontStyleRegular),
+            PointF(m.x, m.subtitleY), res.Brush(Theme::TextSecondary));
 
         Color accentTransparent(0, Theme::Accent.GetR(), Theme::Accent.GetG(), Theme::Accent.GetB());
         LinearGradientBrush lb(PointF(m.x, m.lineY), PointF(m.x + 80, m.lineY),
@@ -712,90 +773,97 @@ namespace Painter {
         gfx.DrawLine(&lp, m.x, m.lineY, m.x + 80, m.lineY);
     }
 
-    void AddSection(Graphics& gfx, const Metrics& m) {
-        FontFamily ff(L"Segoe UI");
-        Gdiplus::Font labelFont(&ff, static_cast<REAL>(Layout::FontSizeLabel), FontStyleBold, UnitPixel);
-        SolidBrush labelBrush(Theme::TextMuted);
-        gfx.DrawString(L"ADD GAME", -1, &labelFont,
-            PointF(m.x, m.addLabelY), &labelBrush);
+    void AddSection(Graphics& gfx, const Scene::Metrics& m, const Scene::Rect& area) {
+        Resources& res = g_app.res;
+        if (area.Intersects(m.AddLabelRow()))
+            gfx.DrawString(L"ADD GAME", -1, res.Font(Layout::FontSizeLabel, FontStyleBold),
+                PointF(m.x, m.addLabelY), res.Brush(Theme::TextMuted));
 
         // Input field background
-        const Color inputBg = g_app.inputFocused ? Theme::BgInputFocus : Theme::BgInput;
-        SolidBrush ib(inputBg);
-        Draw::FillRoundRect(gfx, m.inputRect,
-            static_cast<float>(Layout::RadiusSm), &ib);
-
-        const Color borderCol = g_app.inputFocused ? Theme::BorderFocus : Theme::Border;
-        Pen bp(borderCol, g_app.inputFocused ? 2.f : 1.f);
-        Draw::StrokeRoundRect(gfx, m.inputRect,
-            static_cast<float>(Layout::RadiusSm), &bp);
-
-        // Placeholder text [REMOVED]
-
-        const auto& anim = g_app.buttonAnims[ID_BTN_ADD];
-        UI::Button(gfx, m.addBtnRect, L"+ Add", true, anim.hover, anim.press);
-    }
-
-    void GameList(Graphics& gfx, const Metrics& m) {
-        FontFamily ff(L"Segoe UI");
-        Gdiplus::Font labelFont(&ff, static_cast<REAL>(Layout::FontSizeLabel), FontStyleBold, UnitPixel);
-        SolidBrush labelBrush(Theme::TextMuted);
-        gfx.DrawString(L"MONITORED GAMES", -1, &labelFont,
-            PointF(m.x, m.listLabelY), &labelBrush);
-
-        std::lock_guard lock(g_app.gamesMutex);
-        const int count = static_cast<int>(g_app.games.size());
-
-        // Count badge
-        const std::wstring countStr = std::to_wstring(count);
-        RectF measureR;
-        gfx.MeasureString(countStr.c_str(), -1, &labelFont, PointF(0, 0), &measureR);
-        float badgeW = measureR.Width + 14;
-        if (badgeW < 22.f) badgeW = 22.f;
-        RectF badgeR(m.x + 130, m.listLabelY - 2, badgeW, 18);
-        SolidBrush badgeBg(Theme::AccentMuted);
-        Draw::FillRoundRect(gfx, badgeR, static_cast<float>(Layout::RadiusXs), &badgeBg);
-        SolidBrush badgeText(Theme::Accent);
-        StringFormat cf;
-        Draw::SetupCentered(cf);
-        gfx.DrawString(countStr.c_str(), -1, &labelFont, badgeR, &cf, &badgeText);
+        if (area.Intersects(m.inputRect.Inflated(2))) {
+            const RectF input = ToRectF(m.inputRect);
+            const Color inputBg = g_app.inputFocused ? Theme::BgInputFocus : Theme::BgInput;
+            Draw::FillRoundRect(gfx, input,
+                static_cast<float>(Layout::RadiusSm), res.Brush(inputBg));
+
+            const Color borderCol = g_app.inputFocused ? Theme::BorderFocus : Theme::Border;
+            Draw::StrokeRoundRect(gfx, input, static_cast<float>(Layout::RadiusSm),
+                res.Stroke(borderCol, g_app.inputFocused ? 2.f : 1.f));
+        }
+
+        if (area.Intersects(m.addBtnRect.Inflated(1))) {
+            const auto& anim = g_app.buttonAnims[ID_BTN_ADD];
+            UI::Button(gfx, ToRectF(m.addBtnRect), L"+ Add", true, anim.hover, anim.press);
+        }
+    }
+
+    void GameList(Graphics& gfx, const Scene::Metrics& m, const Scene::Rect& area) {
+        Resources& res = g_app.res;
+        Gdiplus::Font* labelFont = res.Font(Layout::FontSizeLabel, FontStyleBold);
+        const Scene::Rect clip = m.ListClip();
+        const Scene::Rect visible = clip.Intersect(area);
+
+        // Resolve just the rows in `visible`, then draw without the lock.
+        int count, selected;
+        bool filtered;
+        std::vector<std::pair<int, std::string>> rows;
+        {
+            std::lock_guard lock(g_app.gamesMutex);
+            count = static_cast<int>(g_app.view.Size(g_app.games));
+            selected = g_app.SelectedRowLocked();
+            filtered = g_app.view.Filtered();
+            const int first = std::max(0,
+                static_cast<int>((visible.Y - clip.Y + g_app.scrollY) / Layout::ItemH));
+            for (int i = first; i < count && !visible.Empty(); ++i) {
+                const Scene::Rect itemR = m.ItemRect(i, g_app.scrollY);
+                if (itemR.Y > visible.Bottom()) break;
+                if (itemR.Inflated(2).Intersects(visible))
+                    rows.emplace_back(i, g_app.view.Row(g_app.games, i));
+            }
+        }
+
+        if (area.Intersects(m.ListLabelRow())) {
+            gfx.DrawString(L"MONITORED GAMES", -1, labelFont,
+                PointF(m.x, m.listLabelY), res.Brush(Theme::TextMuted));
+
+            // Count badge: matches while filtering
+            const std::wstring countStr = std::to_wstring(count);
+            RectF measureR;
+            gfx.MeasureString(countStr.c_str(), -1, labelFont, PointF(0, 0), &measureR);
+            float badgeW = measureR.Width + 14;
+            if (badgeW < 22.f) badgeW = 22.f;
+            RectF badgeR(m.x + 130, m.listLabelY - 2, badgeW, 18);
+            Draw::FillRoundRect(gfx, badgeR, static_cast<float>(Layout::RadiusXs),
+                res.Brush(Theme::AccentMuted));
+            gfx.DrawString(countStr.c_str(), -1, labelFont, badgeR, res.Centered(),
+                res.Brush(Theme::Accent));
+        }
+
+        if (!area.Intersects(m.listRect.Inflated(1))) return;
 
         // List card background
-        SolidBrush cardBg(Theme::BgCard);
-        Draw::FillRoundRect(gfx, m.listRect,
-            static_cast<float>(Layout::RadiusLg), &cardBg);
-        Pen cardBorder(Theme::Border);
-        Draw::StrokeRoundRect(gfx, m.listRect,
-            static_cast<float>(Layout::RadiusLg), &cardBorder);
+        const RectF list = ToRectF(m.listRect);
+        Draw::FillRoundRect(gfx, list, static_cast<float>(Layout::RadiusLg),
+            res.Brush(Theme::BgCard));
+        Draw::StrokeRoundRect(gfx, list, static_cast<float>(Layout::RadiusLg),
+            res.Stroke(Theme::Border));
 
         // Empty state
-        if (g_app.games.empty()) {
-            Gdiplus::Font ef(&ff, static_cast<REAL>(Layout::FontSizeBody), FontStyleItalic, UnitPixel);
-            SolidBrush eb(Theme::TextMuted);
-            StringFormat esf;
-            Draw::SetupCentered(esf);
-            gfx.DrawString(L"No games added yet", -1, &ef, m.listRect, &esf, &eb);
+        if (count == 0) {
+            gfx.DrawString(filtered ? L"No matching games" : L"No games added yet", -1,
+                res.Font(Layout::FontSizeBody, FontStyleItalic), list, res.Centered(),
+                res.Brush(Theme::TextMuted));
             return;
         }
 
-        // Clipped item drawing
-        const RectF clip(m.listRect.X + Layout::ListPadX,
-            m.listRect.Y + Layout::ListPadY,
-            m.listRect.Width - Layout::ListPadX * 2,
-            m.listRect.Height - Layout::ListPadY * 2);
-        gfx.SetClip(clip);
-
-        float itemY = m.listRect.Y + Layout::ListPadY
-            - static_cast<float>(g_app.scrollY);
-        for (int i = 0; i < count; ++i, itemY += Layout::ItemH) {
-            if (itemY + Layout::ItemH < clip.Y)    continue;
-            if (itemY > clip.Y + clip.Height)      break;
-            RectF itemR(clip.X, itemY, clip.Width,
-                static_cast<float>(Layout::ItemH) - 4);
-            UI::GameItem(gfx, itemR, g_app.games[i],
-                g_app.selectedItem == i, g_app.hoveredItem == i);
-        }
-        gfx.ResetClip();
+        // Clipped item drawing, inside whatever clip the paint already set
+        Region outer;
+        gfx.GetClip(&outer);
+        gfx.SetClip(ToRectF(clip), CombineModeIntersect);
+        for (const auto& [i, name] : rows)
+            UI::GameItem(gfx, ToRectF(m.ItemRect(i, g_app.scrollY)), name,
+                selected == i, g_app.hoveredItem == i);
+        gfx.SetClip(&outer);
 
         // Scrollbar
         const int totalH = count * Layout::ItemH;
@@ -809,17 +877,20 @@ namespace Painter {
             const float barY = clip.Y + pos * (visibleH - barH);
             RectF barR(m.listRect.X + m.listRect.Width - Layout::ListPadX + 2,
                 barY, 4, barH);
-            SolidBrush sb(Theme::Scrollbar);
-            Draw::FillRoundRect(gfx, barR, 2, &sb);
+            Draw::FillRoundRect(gfx, barR, 2, res.Brush(Theme::Scrollbar));
         }
     }
 
-    void Footer(Graphics& gfx, const Metrics& m) {
-        const auto& anim = g_app.buttonAnims[ID_BTN_REMOVE];
-        UI::Button(gfx, m.removeBtnRect, L"Remove", false,
-            anim.hover, anim.press, g_app.selectedItem >= 0);
-        UI::StatusBar(gfx, m.statusRect,
-            g_app.gameModeActive, g_app.pulseValue, g_app.GetStatus());
+    void Footer(Graphics& gfx, const Scene::Metrics& m, const Scene::Rect& area) {
+        if (area.Intersects(m.removeBtnRect.Inflated(1))) {
+            const auto& anim = g_app.buttonAnims[ID_BTN_REMOVE];
+            UI::Button(gfx, ToRectF(m.removeBtnRect), L"Remove", false,
+                anim.hover, anim.press, !g_app.selectedGame.empty());
+        }
+        if (area.Intersects(m.statusRect.Inflated(1))) {
+            const Events::Snapshot st = g_app.Status();
+            UI::StatusBar(gfx, ToRectF(m.statusRect), st.active, g_app.pulseValue, st.text);
+        }
     }
 
 } // namespace Painter
@@ -828,22 +899,35 @@ namespace Painter {
 // MAIN PAINT
 // ============================================================
 
-static void Paint(HWND hwnd, HDC hdc) {
+// Redraws the stale regions into the back buffer, then blits what Windows
+// asked for; an exposure with nothing stale draws nothing.
+static void Paint(HWND hwnd, HDC hdc, const RECT& exposed) {
     RECT rc;
     GetClientRect(hwnd, &rc);
 
-    DoubleBuffer buffer(hdc, rc.right, rc.bottom);
-    Graphics gfx(buffer.GetDC());
-    gfx.SetSmoothingMode(SmoothingModeHighQuality);
-    gfx.SetTextRenderingHint(TextRenderingHintClearTypeGridFit);
-
-    SolidBrush bg(Theme::BgPrimary);
-    gfx.FillRectangle(&bg, 0, 0, rc.right, rc.bottom);
-
-    Painter::Header(gfx, g_app.metrics);
-    Painter::AddSection(gfx, g_app.metrics);
-    Painter::GameList(gfx, g_app.metrics);
-    Painter::Footer(gfx, g_app.metrics);
+    std::vector<Scene::Rect> dirty = std::move(g_app.pending);
+    g_app.pending.clear();
+    if (g_app.backBuffer.Ensure(hdc, rc.right, rc.bottom))
+        dirty.assign(1, { 0.f, 0.f, static_cast<float>(rc.right), static_cast<float>(rc.bottom) });
+    Scene::Coalesce(dirty);
+
+    if (!dirty.empty()) {
+        Graphics gfx(g_app.backBuffer.GetDC());
+        gfx.SetSmoothingMode(SmoothingModeHighQuality);
+        gfx.SetTextRenderingHint(TextRenderingHintClearTypeGridFit);
+
+        for (const auto& area : dirty) {
+            const RectF r = ToRectF(area);
+            gfx.SetClip(r);
+            gfx.FillRectangle(g_app.res.Brush(Theme::BgPrimary), r);
+
+            Painter::Header(gfx, g_app.metrics, area);
+            Painter::AddSection(gfx, g_app.metrics, area);
+            Painter::GameList(gfx, g_app.metrics, area);
+            Painter::Footer(gfx, g_app.metrics, area);
+        }
+    }
+    g_app.backBuffer.Present(hdc, exposed);
 }
 
 // ============================================================
@@ -898,12 +982,11 @@ static bool UpdateAnimations() {
     }
 
     g_app.pulsePhase += 0.08f;
-    const float target = g_app.gameModeActive
-        ? (sinf(g_app.pulsePhase) + 1.f) / 2.f : 0.f;
+    const bool active = g_app.Status().active;
+    const float target = active ? (sinf(g_app.pulsePhase) + 1.f) / 2.f : 0.f;
 
     if (std::abs(g_app.pulseValue - target) > 0.01f) {
-        g_app.pulseValue = g_app.gameModeActive
-            ? target : Lerp(g_app.pulseValue, 0.f, ANIM_SPEED);
+        g_app.pulseValue = active ? target : Lerp(g_app.pulseValue, 0.f, ANIM_SPEED);
         dirty = true;
     }
     return dirty;
@@ -944,17 +1027,13 @@ static void OnCreate(HWND hwnd) {
     g_app.AddTrayIcon();
     g_app.buttonAnims[ID_BTN_ADD] = {};
     g_app.buttonAnims[ID_BTN_REMOVE] = {};
-    SetTimer(hwnd, TIMER_ANIM, 16, nullptr);
+    g_app.StartTimers();
+    g_app.Sync();
 }
 
 static void OnMouseMove(HWND hwnd, int mx, int my) {
     const int newBtn = g_app.metrics.HitTestButton(mx, my);
-    int newItem;
-    {
-        std::lock_guard lock(g_app.gamesMutex);
-        newItem = g_app.metrics.HitTestItem(
-            mx, my, static_cast<int>(g_app.games.size()), g_app.scrollY);
-    }
+    const int newItem = g_app.metrics.HitTestItem(mx, my, g_app.RowCount(), g_app.scrollY);
 
     if (newBtn != g_app.hoveredButton || newItem != g_app.hoveredItem) {
         g_app.hoveredButton = newBtn;
@@ -973,15 +1052,12 @@ static void OnCommand(int id) {
         GetWindowTextA(g_app.hInput, buf, sizeof(buf));
         if (g_app.AddGame(buf)) {
             SetWindowTextA(g_app.hInput, "");
-            g_app.SaveGames();
             g_app.RequestRedraw();
         }
     } break;
     case ID_BTN_REMOVE:
-        if (g_app.RemoveSelected()) {
-            g_app.SaveGames();
+        if (g_app.RemoveSelected())
             g_app.RequestRedraw();
-        }
         break;
     }
 }
@@ -1017,15 +1093,22 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg,
     case WM_TIMER:
         if (wp == TIMER_ANIM && UpdateAnimations())
             g_app.RequestRedraw();
+        else if (wp == TIMER_SYNC)
+            g_app.Sync();
         break;
 
+    case WM_ENGINE_CHANGED:
+        // Nothing to show while hidden; restoring syncs.
+        if (!g_app.inTray) g_app.Sync();
+        return 0;
+
     case WM_ERASEBKGND:
         return 1;
 
     case WM_PAINT: {
         PAINTSTRUCT ps;
         HDC hdc = BeginPaint(hwnd, &ps);
-        Paint(hwnd, hdc);
+        Paint(hwnd, hdc, ps.rcPaint);
         EndPaint(hwnd, &ps);
     } return 0;
 
@@ -1053,14 +1136,12 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg,
             g_app.pressedButton = btn;
             g_app.RequestRedraw();
         }
-        int item;
-        {
-            std::lock_guard lock(g_app.gamesMutex);
-            item = g_app.metrics.HitTestItem(
-                mx, my, static_cast<int>(g_app.games.size()), g_app.scrollY);
-        }
-        if (item >= 0 && item != g_app.selectedItem) {
-            g_app.selectedItem = item;
+        const int item = g_app.metrics.HitTestItem(mx, my, g_app.RowCount(), g_app.scrollY);
+        if (item >= 0) {
+            {
+                std::lock_guard lock(g_app.gamesMutex);
+                g_app.selectedGame = g_app.view.Row(g_app.games, item);
+            }
             g_app.RequestRedraw();
         }
     } break;
@@ -1081,29 +1162,32 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg,
         break;
 
     case WM_COMMAND:
-        OnCommand(LOWORD(wp));
+        if (LOWORD(wp) == ID_INPUT && HIWORD(wp) == EN_CHANGE) {
+            char buf[256]{};
+            GetWindowTextA(g_app.hInput, buf, sizeof(buf));
+            g_app.Filter(buf);
+        }
+        else {
+            OnCommand(LOWORD(wp));
+        }
         break;
 
     case WM_SYSCOMMAND:
         if ((wp & 0xFFF0) == SC_MINIMIZE) {
-            ShowWindow(hwnd, SW_HIDE);
+            g_app.HideToTray();
             return 0;
         }
         break;
 
     case WM_TRAYICON:
-        if (lp == WM_LBUTTONUP || lp == WM_LBUTTONDBLCLK) {
-            ShowWindow(hwnd, SW_SHOW);
-            ShowWindow(hwnd, SW_RESTORE);
-            SetForegroundWindow(hwnd);
-        }
+        if (lp == WM_LBUTTONUP || lp == WM_LBUTTONDBLCLK)
+            g_app.RestoreFromTray();
         break;
 
     case WM_DESTROY:
         g_app.RemoveTrayIcon();
-        KillTimer(hwnd, TIMER_ANIM);
+        g_app.StopTimers();
         g_app.DestroyResources();
-        g_app.running = false;
         PostQuitMessage(0);
         return 0;
     }
@@ -1111,6 +1195,693 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg,
     return DefWindowProc(hwnd, msg, wp, lp);
 }
 
+// ============================================================
+// HEADLESS MODES
+// ============================================================
+
+static Booster::Engine* g_daemonEngine = nullptr;
+
+static bool HasFlag(const std::string& args, const char* flag) {
+    return args.find(flag) != std::string::npos;
+}
+
+// Value following `flag`, optionally double-quoted.
+static std::string FlagValue(const std::string& args, const char* flag) {
+    const size_t pos = args.find(flag);
+    if (pos == std::string::npos) return {};
+    const size_t begin = args.find_first_not_of(' ', pos + strlen(flag));
+    if (begin == std::string::npos) return {};
+    if (args[begin] == '"') {
+        const size_t end = args.find('"', begin + 1);
+        return args.substr(begin + 1, end == std::string::npos ? end : end - begin - 1);
+    }
+    const size_t end = args.find(' ', begin);
+    return args.substr(begin, end == std::string::npos ? end : end - begin);
+}
+
+static Telemetry::Exporter::Options MetricsOptions(const std::string& args) {
+    Telemetry::Exporter::Options opts;
+    opts.port = static_cast<uint16_t>(std::atoi(FlagValue(args, "--metrics-port").c_str()));
+    opts.textfile = FlagValue(args, "--metrics-file");
+    return opts;
+}
+
+// `--latency-probe N` runs N probe threads.
+static LatencyProbe::Options ProbeOptions(const std::string& args) {
+    LatencyProbe::Options opts;
+    opts.threads = static_cast<uint32_t>(std::atoi(FlagValue(args, "--latency-probe").c_str()));
+    return opts;
+}
+
+// `--detect` boosts unlisted games it recognises; `--record-detect FILE` logs
+// every foreground sample, labelled by the game list, for `--eval-detector`.
+static Detect::Options DetectOptions(const std::string& args) {
+    Detect::Options opts;
+    opts.enabled = HasFlag(args, "--detect");
+    opts.memoryFile = DETECT_MEMORY;
+    opts.recordFile = FlagValue(args, "--record-detect");
+    return opts;
+}
+
+// Sessions escalate under contention unless `--no-escalate`.
+static Pressure::Options PressureOptions(const std::string& args) {
+    Pressure::Options opts;
+    opts.enabled = !HasFlag(args, "--no-escalate");
+    return opts;
+}
+
+// `--headroom` frees memory when a listed game launches, ahead of its load.
+static Headroom::Options HeadroomOptions(const std::string& args) {
+    Headroom::Options opts;
+    opts.enabled = HasFlag(args, "--headroom");
+    return opts;
+}
+
+// Sessions exempt the game from power throttling unless `--no-power-qos`;
+// `--power-qos` also holds idle states shallow on AC power.
+static PowerQos::Options PowerQosOptions(const std::string& args) {
+    PowerQos::Options opts;
+    opts.enabled = !HasFlag(args, "--no-power-qos");
+    if (HasFlag(args, "--power-qos")) opts.idleStateLimit = 1;
+    return opts;
+}
+
+// What the GUI and the daemon run with.
+static Booster::EngineOptions EngineOptionsFor(const std::string& args) {
+    Booster::EngineOptions opts = DefaultEngineOptions();
+    opts.latencyProbe = ProbeOptions(args);
+    opts.detect = DetectOptions(args);
+    opts.pressure = PressureOptions(args);
+    opts.headroom = HeadroomOptions(args);
+    opts.powerQos = PowerQosOptions(args);
+    return opts;
+}
+
+// GUI-subsystem binary: borrow the launching console, if any, for output.
+static void AttachParentConsole() {
+    if (AttachConsole(ATTACH_PARENT_PROCESS)) {
+        freopen("CONOUT$", "w", stdout);
+        freopen("CONOUT$", "w", stderr);
+    }
+}
+
+static BOOL WINAPI DaemonCtrlHandler(DWORD) {
+    if (g_daemonEngine) g_daemonEngine->Stop();
+    return TRUE;
+}
+
+static int RunDaemon(const std::string& args) {
+    AttachParentConsole();
+    Booster::Engine engine(EngineOptionsFor(args));
+    engine.LoadGames();
+    for (const auto& err : engine.LoadRules())
+        fprintf(stderr, "%s %s\n", RULES_FILE, err.c_str());
+    Ipc::Server server(engine, [&engine] { engine.Stop(); });
+    if (!server.Start()) {
+        fprintf(stderr, "Game Booster is already running on %s\n", Ipc::PipeName);
+        return 1;
+    }
+    const Telemetry::Exporter::Options metricsOpts = MetricsOptions(args);
+    Telemetry::Exporter exporter(engine.Metrics());
+    if ((metricsOpts.port || !metricsOpts.textfile.empty()) && !exporter.Start(metricsOpts))
+        fprintf(stderr, "Metrics exporter failed to start\n");
+    g_daemonEngine = &engine;
+    SetConsoleCtrlHandler(DaemonCtrlHandler, TRUE);
+    printf("Game Booster daemon listening on %s\n", Ipc::PipeName);
+    engine.Run();
+    g_daemonEngine = nullptr;
+    exporter.Stop();
+    server.Stop();
+    return 0;
+}
+
+static int RunIpcBenchmark(const std::string& args) {
+    AttachParentConsole();
+    constexpr char flag[] = "--bench-ipc";
+    int requests = std::atoi(args.c_str() + args.find(flag) + sizeof(flag) - 1);
+    if (requests <= 0) requests = 10000;
+
+    auto client = Ipc::Client::Connect(1000);
+    if (!client) {
+        fprintf(stderr, "No Game Booster instance on %s\n", Ipc::PipeName);
+        return 1;
+    }
+    const Ipc::BenchResult r = Ipc::BenchmarkStatus(*client, requests);
+    printf("%d status requests, %d failed\n", r.requests, r.failures);
+    printf("  mean %.1f us  p50 %.1f us  p99 %.1f us  max %.1f us\n",
+        r.meanUs, r.p50Us, r.p99Us, r.maxUs);
+    printf("  %.0f requests/s\n", r.perSecond);
+    return r.failures ? 1 : 0;
+}
+
+// Creates, exercises and destroys `n` engines through the C API against an
+// inert platform, to keep instance setup cheap.
+static int RunEngineBenchmark(const std::string& args) {
+    AttachParentConsole();
+    int n = std::atoi(FlagValue(args, "--bench-engines").c_str());
+    if (n <= 0) n = 1000;
+
+    const booster_platform inert{};
+    booster_options opts;
+    booster_default_options(&opts);
+
+    using Clock = std::chrono::steady_clock;
+    Clock::duration create{}, use{}, destroy{};
+    int failures = 0;
+    for (int i = 0; i < n; ++i) {
+        const auto t0 = Clock::now();
+        booster_engine* e = booster_engine_create(&opts, &inert);
+        const auto t1 = Clock::now();
+        if (!e) {
+            ++failures;
+            continue;
+        }
+        if (!booster_engine_add_game(e, "game.exe")
+            || !booster_engine_force_enter(e, "game.exe")
+            || !booster_engine_force_exit(e))
+            ++failures;
+        const auto t2 = Clock::now();
+        booster_engine_destroy(e);
+        const auto t3 = Clock::now();
+        create += t1 - t0;
+        use += t2 - t1;
+        destroy += t3 - t2;
+    }
+    auto us = [n](Clock::duration d) {
+        return std::chrono::duration<double, std::micro>(d).count() / n;
+        };
+    printf("%d engines, %d failed\n", n, failures);
+    printf("  create %.1f us  enter+exit %.1f us  destroy %.1f us  (mean)\n",
+        us(create), us(use), us(destroy));
+    return failures ? 1 : 0;
+}
+
+// Compiles `n` synthetic rules and times evaluation with a few facts
+// changing per tick, as the monitor would see them.
+static int RunRulesBenchmark(const std::string& args) {
+    AttachParentConsole();
+    int n = std::atoi(FlagValue(args, "--bench-rules").c_str());
+    if (n <= 0) n = 500;
+
+    std::string source;
+    for (int i = 0; i < n; ++i) {
+        char line[160];
+        snprintf(line, sizeof(line),
+            "allow when (ac_power or battery > %d) and free_ram > %dmb and not running(\"tool%d.exe\")\n"
+            "deny when time between %02d:00 and %02d:30 and game == \"game%d.exe\"\n",
+            i % 100, 256 + i, i % 50, i % 24, i % 24, i % 20);
+        source += line;
+    }
+    std::vector<std::string> errors;
+    const auto c0 = std::chrono::steady_clock::now();
+    Rules::RuleSet rules = Rules::RuleSet::Compile(source, errors);
+    const auto c1 = std::chrono::steady_clock::now();
+
+    constexpr int ticks = 10000;
+    size_t evaluated = 0;
+    const auto e0 = std::chrono::steady_clock::now();
+    for (int t = 0; t < ticks; ++t) {
+        // Memory and one process flip every tick; the clock every 60.
+        for (size_t f = 0; f < rules.Facts().size(); ++f) {
+            const Rules::FactKey& k = rules.Facts()[f];
+            if (k.kind == Rules::Fact::FreeRam) rules.Set(f, 4096 + (t % 7) * 64);
+            else if (k.kind == Rules::Fact::Time) rules.Set(f, (t / 60) % 1440);
+            else if (k.kind == Rules::Fact::Running && k.arg == "tool0.exe") rules.Set(f, t & 1);
+        }
+        rules.Evaluate(static_cast<uint64_t>(t) * 1000);
+        evaluated += rules.LastEvaluated();
+    }
+    const auto e1 = std::chrono::steady_clock::now();
+
+    printf("%zu rules, %zu facts, %zu errors, compiled in %.1f us\n", rules.Size(),
+        rules.Facts().size(), errors.size(),
+        std::chrono::duration<double, std::micro>(c1 - c0).count());
+    printf("  %.2f us per tick, %.1f rules re-run per tick\n",
+        std::chrono::duration<double, std::micro>(e1 - e0).count() / ticks,
+        static_cast<double>(evaluated) / ticks);
+    return errors.empty() ? 0 : 1;
+}
+
+static int RunListBenchmark(const std::string& args) {
+    AttachParentConsole();
+    int n = std::atoi(FlagValue(args, "--bench-list").c_str());
+    if (n <= 0) n = 100000;
+
+    using Clock = std::chrono::steady_clock;
+    auto us = [](Clock::duration d) { return std::chrono::duration<double, std::micro>(d).count(); };
+
+    std::vector<std::string> names;
+    names.reserve(n);
+    uint32_t seed = 12345;
+    for (int i = 0; i < n; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        char name[64];
+        snprintf(name, sizeof(name), "Title%08X_%d.exe", seed, i);
+        names.push_back(name);
+    }
+
+    GameIndex::Index index;
+    const auto i0 = Clock::now();
+    for (const auto& name : names) index.Insert(name);
+    const auto i1 = Clock::now();
+    size_t found = 0;
+    for (const auto& name : names) found += index.Contains(name);
+    const auto i2 = Clock::now();
+
+    GameIndex::View view;
+    const auto s0 = Clock::now();
+    view.Update(index, "tle1");             // builds the trigram index
+    const auto s1 = Clock::now();
+    view.Update(index, "e1a");
+    const auto s2 = Clock::now();
+    view.Update(index, "e1a2");             // refines the previous hits
+    const auto s3 = Clock::now();
+    view.Update(index, "_9");               // too short for trigrams
+    const auto s4 = Clock::now();
+
+    printf("%zu entries (%zu found)\n", index.Size(), found);
+    printf("  insert %.2f us, contains %.2f us\n", us(i1 - i0) / n, us(i2 - i1) / n);
+    printf("  first search %.1f ms (with index build), search %.1f us, refine %.1f us, "
+        "2-char scan %.1f ms\n",
+        us(s1 - s0) / 1000, us(s2 - s1), us(s3 - s2), us(s4 - s3) / 1000);
+    return found == index.Size() ? 0 : 1;
+}
+
+// Parse cost on synthetic tables of 1k/10k/50k processes, then the live
+// table scanned both ways on this machine.
+static int RunScanBenchmark(const std::string& args) {
+    AttachParentConsole();
+    int threads = std::atoi(FlagValue(args, "--threads").c_str());
+    if (threads <= 0) threads = 8;
+
+    using Clock = std::chrono::steady_clock;
+    auto us = [](Clock::duration d) { return std::chrono::duration<double, std::micro>(d).count(); };
+
+    ProcessScan::Snapshot scan;
+    std::vector<ProcessUtil::ProcessInfo> infos;
+    for (const size_t n : { 1000, 10000, 50000 }) {
+        const std::vector<uint64_t> table = ProcessScan::Synthesize(n, threads);
+        const size_t bytes = table.size() * sizeof(uint64_t);
+        constexpr int rounds = 20;
+
+        const auto p0 = Clock::now();
+        for (int r = 0; r < rounds; ++r) scan.Parse(table.data(), bytes);
+        const auto p1 = Clock::now();
+        size_t matches = 0;
+        for (int r = 0; r < rounds; ++r)
+            for (const auto& p : scan.Processes()) matches += p.NameIs("worker42.exe");
+        const auto p2 = Clock::now();
+        // What Enumerate does with the table: pid, start time and name.
+        for (int r = 0; r < rounds; ++r) {
+            size_t k = 0;
+            for (const auto& p : scan.Processes()) {
+                if (k == infos.size()) infos.emplace_back();
+                infos[k].pid = p.pid;
+                infos[k].startTime = p.startTime;
+                p.NameTo(infos[k++].exe);
+            }
+            infos.resize(k);
+        }
+        const auto p3 = Clock::now();
+
+        printf("%6zu processes, %7zu threads, %5.1f MB table: parse %8.1f us, "
+            "find by name %7.1f us, enumerate %8.1f us\n",
+            scan.Processes().size(), scan.ThreadCount(), bytes / 1048576.0,
+            us(p1 - p0) / rounds, us(p2 - p1) / rounds, us(p3 - p2) / rounds);
+        if (matches != rounds) return 1;
+    }
+
+    // The old way: toolhelp, then a handle per process for its start time.
+    constexpr int rounds = 20;
+    size_t found = 0;
+    const auto t0 = Clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        HANDLE snap = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+        if (snap == INVALID_HANDLE_VALUE) return 1;
+        PROCESSENTRY32 entry{ sizeof(entry) };
+        for (BOOL ok = Process32First(snap, &entry); ok; ok = Process32Next(snap, &entry)) {
+            if (HANDLE h = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE,
+                entry.th32ProcessID)) {
+                found += ProcessUtil::StartTimeOf(h) != 0;
+                CloseHandle(h);
+            }
+        }
+        CloseHandle(snap);
+    }
+    const auto t1 = Clock::now();
+    ProcessScan::Snapshot live;
+    for (int r = 0; r < rounds; ++r) {
+        if (!live.Take()) return 1;
+        for (const auto& p : live.Processes()) found += p.startTime != 0;
+    }
+    const auto t2 = Clock::now();
+    printf("live: %zu processes, %zu threads: toolhelp + OpenProcess %.1f us, "
+        "one table scan %.1f us\n", live.Processes().size(), live.ThreadCount(),
+        us(t1 - t0) / rounds, us(t2 - t1) / rounds);
+    return found ? 0 : 1;
+}
+
+// Boosts this process as if it were a game, keeps a copy of the journal as
+// a crash would have left it, exits, then times a fresh engine undoing the
+// copy. The changes are already undone by then, so this restores the same
+// values again, at the same cost.
+static int RunRecoverBenchmark() {
+    AttachParentConsole();
+    char self[MAX_PATH], temp[MAX_PATH];
+    if (!GetModuleFileNameA(nullptr, self, MAX_PATH) || !GetTempPathA(MAX_PATH, temp)) return 1;
+    std::string exe = self;
+    exe = exe.substr(exe.find_last_of("\\/") + 1);
+    const std::string journal = std::string(temp) + "gb-recover.bin";
+    DeleteFileA(journal.c_str());
+
+    Booster::Win32Platform::Instance().Prepare();
+    Booster::EngineOptions opts;
+    opts.killList.clear();
+    opts.settleMs = 0;
+    opts.journalFile = journal;
+    // Nothing on the bench machine that the journal cannot put back.
+    opts.headroom.enabled = false;
+    uint64_t exitUs = 0;
+    std::string crashed;
+    {
+        Booster::Engine engine(opts);
+        engine.Recover();
+        engine.ForceEnter(exe);
+        // The engine holds the file open for writing; streams share it.
+        std::ifstream in(journal, std::ios::binary);
+        crashed.assign(std::istreambuf_iterator<char>(in), {});
+        engine.ForceExit();
+        Booster::Stats stats;
+        engine.GetStats(stats);
+        exitUs = stats.lastExitUs;
+    }
+    std::ofstream(journal, std::ios::binary | std::ios::trunc) << crashed;
+
+    Booster::Engine engine(opts);
+    const size_t changes = engine.Recover();
+    DeleteFileA(journal.c_str());
+    printf("%zu changes restored: on exit in %.2f ms, after a crash in %.2f ms\n",
+        changes, exitUs / 1000.0, engine.Metrics().recoverySeconds.Value() * 1000);
+    return changes ? 0 : 1;
+}
+
+static BoostBench::Workload WorkloadOptions(const std::string& args) {
+    BoostBench::Workload w;
+    auto number = [&args](const char* flag, double fallback) {
+        const std::string v = FlagValue(args, flag);
+        const double d = v.empty() ? 0 : std::atof(v.c_str());
+        return d > 0 ? d : fallback;
+        };
+    w.frameMs = number("--frame-ms", w.frameMs);
+    w.workMs = number("--work-ms", w.workMs);
+    w.memoryMb = static_cast<uint32_t>(number("--memory-mb", w.memoryMb));
+    w.seconds = static_cast<uint32_t>(number("--seconds", w.seconds));
+    return w;
+}
+
+static int RunSyntheticGame(const std::string& args) {
+    BoostBench::Calibration c;
+    c.cpuIterations = std::strtoull(FlagValue(args, "--cpu-iters").c_str(), nullptr, 10);
+    c.memoryTouches = std::strtoull(FlagValue(args, "--mem-touches").c_str(), nullptr, 10);
+    return BoostBench::RunGame(WorkloadOptions(args), c, FlagValue(args, "--out"));
+}
+
+static int RunSyntheticLoad(const std::string& args) {
+    return BoostBench::RunLoad(static_cast<uint32_t>(
+        std::atoi(FlagValue(args, "--synthetic-load").c_str())));
+}
+
+static void PrintSummary(const char* label, const FrameStats::Summary& s) {
+    printf("  %-10s %7zu frames  mean %6.2f  p50 %6.2f  p99 %6.2f  p99.9 %6.2f  max %7.2f ms  stutters %zu\n",
+        label, s.frames, s.meanMs, s.p50Ms, s.p99Ms, s.p999Ms, s.maxMs, s.stutters);
+}
+
+// One line per statistic compared run for run, boosted against unboosted.
+static void PrintComparison(const char* label, const FrameStats::Comparison& c) {
+    if (c.p < 0.05)
+        printf("  %-4s %.2f ms %s with boosting (p %.3g)\n", label, std::fabs(c.difference),
+            c.difference < 0 ? "shorter" : "longer", c.p);
+    else
+        printf("  %-4s no significant difference (%+.2f ms, p %.3g)\n", label, c.difference, c.p);
+}
+
+// Alternates unboosted and boosted runs of a synthetic game under full
+// background load and reports whether Game Mode changed its frame times.
+static int RunBoostBenchmark(const std::string& args) {
+    AttachParentConsole();
+    BoostBench::Options opts;
+    opts.workload = WorkloadOptions(args);
+    const int runs = std::atoi(FlagValue(args, "--runs").c_str());
+    if (runs > 0) opts.runs = static_cast<uint32_t>(runs);
+    opts.loadThreads = static_cast<uint32_t>(std::atoi(FlagValue(args, "--load-threads").c_str()));
+    opts.killProcesses = HasFlag(args, "--kill");
+
+    printf("%u runs of %u s, %.2f ms frames with %.2f ms of work, %s\n", opts.runs,
+        opts.workload.seconds, opts.workload.frameMs, opts.workload.workMs,
+        opts.killProcesses ? "kill list on" : "kill list off");
+
+    BoostBench::Report report;
+    const bool ok = BoostBench::Execute(opts, report, [](const BoostBench::RunResult& r) {
+        char label[32];
+        snprintf(label, sizeof(label), "#%u %s", r.index + 1, r.boosted ? "boost" : "base");
+        PrintSummary(label, r.summary);
+        fflush(stdout);
+        });
+    if (!ok) {
+        fprintf(stderr, "%s\n", report.error.c_str());
+        return 1;
+    }
+
+    printf("\n");
+    PrintSummary("unboosted", report.unboosted);
+    PrintSummary("boosted", report.boosted);
+    printf("  %zu boosted against %zu unboosted runs\n", report.mean.runsA, report.mean.runsB);
+    PrintComparison("mean", report.mean);
+    PrintComparison("p99", report.p99);
+    return 0;
+}
+
+// Asks the running booster to write its trace buffers to `name` in its
+// trace directory.
+static int RunDumpTrace(const std::string& args) {
+    AttachParentConsole();
+    const std::string name = FlagValue(args, "--dump-trace");
+    if (!Ipc::ValidTraceName(name)) {
+        fprintf(stderr, "usage: GameBooster --dump-trace <name.json>\n");
+        return 1;
+    }
+    // Same executable, same directory as the server's.
+    const std::string path = Ipc::TraceDirectory() + name;
+
+    auto client = Ipc::Client::Connect(1000);
+    if (!client) {
+        fprintf(stderr, "No Game Booster instance on %s\n", Ipc::PipeName);
+        return 1;
+    }
+    if (!client->DumpTrace(name)) {
+        fprintf(stderr, "Could not write %s\n", path.c_str());
+        return 1;
+    }
+    printf("Trace written to %s\n", path.c_str());
+    return 0;
+}
+
+static void PrintWake(const char* label, const Booster::WakeLatency& l) {
+    if (!l.samples) {
+        printf("  %-8s no samples\n", label);
+        return;
+    }
+    printf("  %-8s %8llu wakeups  p50 %u us  p99 %u us  p99.9 %u us  max %u us\n", label,
+        static_cast<unsigned long long>(l.samples), l.p50Us, l.p99Us, l.p999Us, l.maxUs);
+}
+
+// Prints the running booster's counters and latency-probe results.
+static int RunShowStats() {
+    AttachParentConsole();
+    auto client = Ipc::Client::Connect(1000);
+    if (!client) {
+        fprintf(stderr, "No Game Booster instance on %s\n", Ipc::PipeName);
+        return 1;
+    }
+    Booster::Stats s;
+    if (!client->GetStats(s)) return 1;
+    printf("up %llu s, %llu ticks, %llu transitions, %u games, %u processes steered\n",
+        static_cast<unsigned long long>(s.uptimeMs / 1000),
+        static_cast<unsigned long long>(s.ticks),
+        static_cast<unsigned long long>(s.transitions), s.gameCount, s.steeredProcesses);
+    printf("last enter %.1f ms, last exit %.1f ms\n", s.lastEnterUs / 1e3, s.lastExitUs / 1e3);
+    printf("booster itself: %.2f s CPU (%.3f%% of one core on average), %.1f MB resident, "
+        "%.1f MB private\n", s.selfCpuUs / 1e6,
+        s.uptimeMs ? s.selfCpuUs / 10.0 / s.uptimeMs : 0.0,
+        s.selfResidentBytes / 1048576.0, s.selfPrivateBytes / 1048576.0);
+    printf("timer wakeup latency (--latency-probe):\n");
+    PrintWake("idle", s.wakeIdle);
+    PrintWake("boosted", s.wakeBoosted);
+    return 0;
+}
+
+// Per-game summary of recorded sessions, optionally for one game and the
+// last `--days N`.
+static int RunShowHistory(const std::string& args) {
+    AttachParentConsole();
+    const auto t0 = std::chrono::steady_clock::now();
+    History::Store history;
+    if (!history.Open(HISTORY_FILE, false)) {
+        fprintf(stderr, "No session history in %s\n", HISTORY_FILE);
+        return 1;
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+
+    std::string game = FlagValue(args, "--history");
+    if (game.rfind("--", 0) == 0) game.clear();
+    const int days = std::atoi(FlagValue(args, "--days").c_str());
+    const uint64_t since = days > 0 ? History::NowMs() - days * 86400000ull : 0;
+
+    std::vector<std::string> games = history.Games();
+    if (!game.empty()) games.assign(1, game);
+    using R = History::Record;
+    for (const auto& g : games) {
+        const std::vector<R> sessions = history.Select(g, since);
+        if (sessions.empty()) continue;
+        uint64_t boostedMs = 0;
+        for (const auto& r : sessions) boostedMs += r.endMs - r.startMs;
+        printf("%-24s %5zu sessions %7.1f h  enter p50 %.1f ms p99 %.1f ms  exit p99 %.1f ms  wake p99 %u us  peak p90 %u MB\n",
+            g.c_str(), sessions.size(), boostedMs / 3.6e6,
+            history.Percentile(g, since, 0.5, &R::enterUs) / 1e3,
+            history.Percentile(g, since, 0.99, &R::enterUs) / 1e3,
+            history.Percentile(g, since, 0.99, &R::exitUs) / 1e3,
+            history.Percentile(g, since, 0.99, &R::wakeP99Us),
+            history.Percentile(g, since, 0.9, &R::peakWorkingSetMb, true));
+    }
+    const auto t2 = std::chrono::steady_clock::now();
+    printf("%zu sessions on file; opened in %.1f ms, queried in %.2f ms\n", history.Size(),
+        std::chrono::duration<double, std::milli>(t1 - t0).count(),
+        std::chrono::duration<double, std::milli>(t2 - t1).count());
+    return 0;
+}
+
+// Scans game libraries and prints what it finds; `--add` puts the finds on
+// the game list, through the running booster if there is one.
+static int RunDiscover(const std::string& args) {
+    AttachParentConsole();
+    Discovery::Options opts;
+    opts.indexFile = HasFlag(args, "--no-index") ? "" : DISCOVERY_INDEX;
+    const std::string folders = FlagValue(args, "--folders");
+    for (size_t begin = 0; begin < folders.size();) {
+        size_t end = folders.find(';', begin);
+        if (end == std::string::npos) end = folders.size();
+        if (end > begin) opts.folders.push_back(folders.substr(begin, end - begin));
+        begin = end + 1;
+    }
+
+    const Discovery::Result result = Discovery::Scan(opts);
+    for (const auto& g : result.games)
+        printf("%-8s %-28s %s\n", Discovery::SourceName(g.source), g.exe.c_str(), g.title.c_str());
+    printf("%zu games from %zu installs, %zu walked, in %.1f ms\n", result.games.size(),
+        result.installs, result.walked, result.elapsedMs);
+    if (!HasFlag(args, "--add")) return 0;
+
+    std::unique_ptr<Booster::Control> local;
+    Booster::Control* control = nullptr;
+    auto client = Ipc::Client::Connect(200);
+    if (client) {
+        control = client.get();
+    }
+    else {
+        auto engine = std::make_unique<Booster::Engine>(DefaultEngineOptions());
+        engine->LoadGames();
+        local = std::move(engine);
+        control = local.get();
+    }
+    int added = 0;
+    for (const auto& g : result.games) added += control->AddGame(g.exe);
+    printf("%d added to the game list\n", added);
+    return 0;
+}
+
+// Replays samples recorded with `--record-detect` through the detector and
+// prints precision and recall, at `--threshold x` or across a sweep.
+static int RunEvalDetector(const std::string& args) {
+    AttachParentConsole();
+    const std::string path = FlagValue(args, "--eval-detector");
+    std::ifstream file(path);
+    if (!file) {
+        fprintf(stderr, "Cannot read %s\n", path.c_str());
+        return 1;
+    }
+    std::vector<std::pair<Detect::Sample, bool>> samples;
+    size_t games = 0;
+    for (std::string line; std::getline(file, line);) {
+        Detect::Sample s;
+        bool label = false;
+        if (!Detect::Parse(line, s, label)) continue;
+        samples.emplace_back(std::move(s), label);
+        games += label;
+    }
+    printf("%zu samples, %zu labelled game\n", samples.size(), games);
+
+    std::vector<double> thresholds;
+    if (const std::string t = FlagValue(args, "--threshold"); !t.empty())
+        thresholds.push_back(std::atof(t.c_str()));
+    else
+        for (int i = 50; i <= 95; i += 5) thresholds.push_back(i / 100.0);
+    for (const double t : thresholds) {
+        Detect::Options opts;
+        opts.enabled = true;
+        opts.threshold = t;
+        const Detect::Evaluation e = Detect::Evaluate(samples, opts);
+        printf("threshold %.2f  precision %.3f  recall %.3f  (tp %zu fp %zu fn %zu)  %.0f ns/sample\n",
+            t, e.Precision(), e.Recall(), e.truePositive, e.falsePositive, e.falseNegative,
+            e.nsPerSample);
+    }
+    return 0;
+}
+
+// Feeds readings from a file, one "cpu memory io" line per tick, through
+// the escalator and prints every step, for tuning the thresholds offline.
+static int RunReplayPressure(const std::string& args) {
+    AttachParentConsole();
+    const std::string path = FlagValue(args, "--replay-pressure");
+    std::ifstream file(path);
+    if (!file) {
+        fprintf(stderr, "Cannot read %s\n", path.c_str());
+        return 1;
+    }
+    Pressure::Escalator escalator(PressureOptions(args));
+    size_t tick = 0, ups = 0, downs = 0;
+    for (std::string line; std::getline(file, line);) {
+        Pressure::Reading r;
+        if (sscanf(line.c_str(), "%lf %lf %lf", &r.cpu, &r.memory, &r.io) != 3) continue;
+        const int step = escalator.Update(r);
+        if (step > 0) {
+            ++ups;
+            printf("tick %zu  up   -> level %d (%s)\n", tick, escalator.Level(),
+                Pressure::ResourceName(escalator.Cause()));
+        }
+        else if (step < 0) {
+            ++downs;
+            printf("tick %zu  down -> level %d\n", tick, escalator.Level());
+        }
+        ++tick;
+    }
+    printf("%zu ticks, %zu up, %zu down, final level %d\n", tick, ups, downs, escalator.Level());
+    return 0;
+}
+
+// Prints the events the running booster still retains.
+static int RunShowEvents() {
+    AttachParentConsole();
+    auto client = Ipc::Client::Connect(1000);
+    if (!client) {
+        fprintf(stderr, "No Game Booster instance on %s\n", Ipc::PipeName);
+        return 1;
+    }
+    std::vector<Events::Event> events;
+    if (!client->RecentEvents(0, events)) return 1;
+    for (const auto& e : events) printf("%s\n", Events::Describe(e).c_str());
+    return 0;
+}
+
 // ============================================================
 // ENTRY POINT
 // ============================================================
@@ -1118,9 +1889,28 @@ static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg,
 int APIENTRY WinMain(
     _In_ HINSTANCE hInst,
     _In_opt_ HINSTANCE,
-    _In_ LPSTR,
+    _In_ LPSTR cmdLine,
     _In_ int nShow)
 {
+    const std::string args = cmdLine ? cmdLine : "";
+    if (HasFlag(args, "--synthetic-game")) return RunSyntheticGame(args);
+    if (HasFlag(args, "--synthetic-load")) return RunSyntheticLoad(args);
+    if (HasFlag(args, "--daemon"))    return RunDaemon(args);
+    if (HasFlag(args, "--bench-ipc")) return RunIpcBenchmark(args);
+    if (HasFlag(args, "--dump-trace")) return RunDumpTrace(args);
+    if (HasFlag(args, "--events"))    return RunShowEvents();
+    if (HasFlag(args, "--stats"))     return RunShowStats();
+    if (HasFlag(args, "--history"))   return RunShowHistory(args);
+    if (HasFlag(args, "--discover"))  return RunDiscover(args);
+    if (HasFlag(args, "--eval-detector")) return RunEvalDetector(args);
+    if (HasFlag(args, "--replay-pressure")) return RunReplayPressure(args);
+    if (HasFlag(args, "--bench-engines")) return RunEngineBenchmark(args);
+    if (HasFlag(args, "--bench-rules")) return RunRulesBenchmark(args);
+    if (HasFlag(args, "--bench-list"))  return RunListBenchmark(args);
+    if (HasFlag(args, "--bench-scan"))  return RunScanBenchmark(args);
+    if (HasFlag(args, "--bench-recover")) return RunRecoverBenchmark();
+    if (HasFlag(args, "--bench-boost")) return RunBoostBenchmark(args);
+
     GdiplusStartupInput gdipInput;
     ULONG_PTR gdipToken;
     GdiplusStartup(&gdipToken, &gdipInput, nullptr);
@@ -1129,9 +1919,7 @@ int APIENTRY WinMain(
     InitCommonControlsEx(&icc);
 
     WM_TASKBARCREATED = RegisterWindowMessageA("TaskbarCreated");
-    g_app.LoadGames();
-
-    std::thread monitor(GameMode::MonitorThreadFunc);
+    g_app.ConnectEngine(MetricsOptions(args), EngineOptionsFor(args));
 
     WNDCLASSA wc{};
     wc.lpfnWndProc = WndProc;
@@ -1152,8 +1940,7 @@ int APIENTRY WinMain(
         nullptr, nullptr, hInst, nullptr);
 
     if (!hwnd) {
-        g_app.running = false;
-        if (monitor.joinable()) monitor.join();
+        g_app.DisconnectEngine();
         GdiplusShutdown(gdipToken);
         return 1;
     }
@@ -1167,7 +1954,7 @@ int APIENTRY WinMain(
         DispatchMessage(&msg);
     }
 
-    if (monitor.joinable()) monitor.join();
+    g_app.DisconnectEngine();
     GdiplusShutdown(gdipToken);
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,470 @@
+﻿#define NOMINMAX
+
+#include "Ipc.h"
+
+#include <sddl.h>
+
+#include <algorithm>
+#include <cstdio>
+
+namespace Ipc {
+
+    namespace {
+
+        // Full access for this process's user, Administrators and SYSTEM;
+        // nobody else. Built once and kept for the life of the process.
+        SECURITY_ATTRIBUTES* PipeSecurity() {
+            static SECURITY_ATTRIBUTES sa = [] {
+                SECURITY_ATTRIBUTES a{ sizeof(a), nullptr, FALSE };
+                std::string sddl = "D:P(A;;GA;;;BA)(A;;GA;;;SY)";
+                HANDLE token;
+                if (OpenProcessToken(GetCurrentProcess(), TOKEN_QUERY, &token)) {
+                    DWORD size = 0;
+                    GetTokenInformation(token, TokenUser, nullptr, 0, &size);
+                    std::vector<uint8_t> user(size);
+                    char* sid = nullptr;
+                    if (size && GetTokenInformation(token, TokenUser, user.data(), size, &size)
+                        && ConvertSidToStringSidA(reinterpret_cast<TOKEN_USER*>(user.data())->User.Sid, &sid)) {
+                        sddl += "(A;;GA;;;" + std::string(sid) + ")";
+                        LocalFree(sid);
+                    }
+                    CloseHandle(token);
+                }
+                ConvertStringSecurityDescriptorToSecurityDescriptorA(sddl.c_str(),
+                    SDDL_REVISION_1, &a.lpSecurityDescriptor, nullptr);
+                return a;
+            }();
+            return &sa;
+        }
+
+        HANDLE CreatePipeInstance(bool first) {
+            SECURITY_ATTRIBUTES* security = PipeSecurity();
+            // Never fall back to the default DACL.
+            if (!security->lpSecurityDescriptor) return INVALID_HANDLE_VALUE;
+            return CreateNamedPipeA(PipeName,
+                PIPE_ACCESS_DUPLEX | (first ? FILE_FLAG_FIRST_PIPE_INSTANCE : 0),
+                PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT
+                | PIPE_REJECT_REMOTE_CLIENTS,
+                PIPE_UNLIMITED_INSTANCES, MaxMessage, MaxMessage, 0, security);
+        }
+
+    } // namespace
+
+    std::string TraceDirectory() {
+        char self[MAX_PATH];
+        const DWORD n = GetModuleFileNameA(nullptr, self, MAX_PATH);
+        std::string dir(self, n < MAX_PATH ? n : 0);
+        dir.erase(dir.find_last_of("\\/") + 1);
+        return dir + "traces\\";
+    }
+
+    // ------------------------------------------------------------
+    // Server
+    // ------------------------------------------------------------
+
+    Server::Server(Booster::Control& control, std::function<void()> onShutdown)
+        : control_(control), onShutdown_(std::move(onShutdown)) {}
+
+    Server::~Server() {
+        Stop();
+    }
+
+    bool Server::Start() {
+        if (acceptThread_.joinable()) return true;
+        HANDLE first = CreatePipeInstance(true);
+        if (first == INVALID_HANDLE_VALUE) return false;
+        stopping_ = false;
+        stopEvent_ = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+        acceptThread_ = std::thread([this, first] { AcceptLoop(first); });
+        return true;
+    }
+
+    void Server::Stop() {
+        if (!acceptThread_.joinable()) return;
+        stopping_ = true;
+        SetEvent(stopEvent_);
+
+        // ConnectNamedPipe has no timeout; a throwaway connection wakes it.
+        HANDLE h = CreateFileA(PipeName, GENERIC_READ | GENERIC_WRITE, 0,
+            nullptr, OPEN_EXISTING, 0, nullptr);
+        if (h != INVALID_HANDLE_VALUE) CloseHandle(h);
+        acceptThread_.join();
+
+        std::vector<std::thread> clients;
+        { std::lock_guard lock(clientsMutex_); clients.swap(clients_); }
+        for (auto& t : clients) {
+            // A client thread may be parked in a blocking ReadFile.
+            while (WaitForSingleObject(t.native_handle(), 50) == WAIT_TIMEOUT)
+                CancelSynchronousIo(t.native_handle());
+            t.join();
+        }
+        CloseHandle(stopEvent_);
+        stopEvent_ = nullptr;
+    }
+
+    void Server::AcceptLoop(HANDLE pipe) {
+        while (pipe != INVALID_HANDLE_VALUE) {
+            const bool connected = ConnectNamedPipe(pipe, nullptr)
+                || GetLastError() == ERROR_PIPE_CONNECTED;
+            if (stopping_) {
+                CloseHandle(pipe);
+                return;
+            }
+            if (connected) {
+                std::lock_guard lock(clientsMutex_);
+                // Reap threads of clients that have already gone away.
+                clients_.erase(std::remove_if(clients_.begin(), clients_.end(),
+                    [](std::thread& t) {
+                        if (WaitForSingleObject(t.native_handle(), 0) != WAIT_OBJECT_0)
+                            return false;
+                        t.join();
+                        return true;
+                    }), clients_.end());
+                clients_.emplace_back([this, pipe] { Serve(pipe); });
+            }
+            else {
+                CloseHandle(pipe);
+            }
+            pipe = CreatePipeInstance(false);
+            // Out of instances or memory: keep trying rather than stop serving.
+            for (DWORD backoffMs = 100; pipe == INVALID_HANDLE_VALUE;
+                backoffMs = std::min<DWORD>(backoffMs * 2, 5000)) {
+                fprintf(stderr, "%s: cannot create pipe instance (error %lu), retrying in %lu ms\n",
+                    PipeName, GetLastError(), backoffMs);
+                if (WaitForSingleObject(stopEvent_, backoffMs) == WAIT_OBJECT_0) return;
+                pipe = CreatePipeInstance(false);
+            }
+        }
+    }
+
+    void Server::Serve(HANDLE pipe) {
+        std::vector<uint8_t> in(MaxMessage), out;
+        out.reserve(MaxMessage);
+        while (!stopping_) {
+            DWORD n = 0;
+            if (!ReadFile(pipe, in.data(), MaxMessage, &n, nullptr)) break;
+
+            uint32_t streamMs = 0;
+            const bool keep = Dispatch(in.data(), n, out, streamMs);
+            DWORD written = 0;
+            if (!WriteFile(pipe, out.data(), static_cast<DWORD>(out.size()),
+                &written, nullptr))
+                break;
+            if (streamMs) {
+                Stream(pipe, streamMs);
+                break;
+            }
+            if (!keep) {
+                if (onShutdown_) onShutdown_();
+                break;
+            }
+        }
+        DisconnectNamedPipe(pipe);
+        CloseHandle(pipe);
+    }
+
+    bool Server::Dispatch(const uint8_t* data, size_t size,
+        std::vector<uint8_t>& out, uint32_t& streamIntervalMs)
+    {
+        Op op;
+        Result ignored;
+        const uint8_t* payload;
+        size_t payloadSize;
+        if (!ParseFrame(data, size, op, ignored, payload, payloadSize)) {
+            BeginFrame(out, Op::Status, Result::BadRequest);
+            FinishFrame(out);
+            return true;
+        }
+
+        Reader r(payload, payloadSize);
+        BeginFrame(out, op);
+        Writer w(out);
+        auto fail = [&out](Result res) { out[1] = static_cast<uint8_t>(res); };
+        bool keep = true;
+
+        switch (op) {
+        case Op::Status: {
+            Booster::StatusInfo s;
+            if (control_.GetStatus(s)) EncodeStatus(w, s);
+            else fail(Result::Rejected);
+        } break;
+
+        case Op::Stats: {
+            Booster::Stats s;
+            if (control_.GetStats(s)) EncodeStats(w, s);
+            else fail(Result::Rejected);
+        } break;
+
+        case Op::Events: {
+            uint64_t after = 0;
+            std::vector<Events::Event> events;
+            if (!r.U64(after)) {
+                fail(Result::BadRequest);
+                break;
+            }
+            if (!control_.RecentEvents(after, events)) {
+                fail(Result::Rejected);
+                break;
+            }
+            // The ring holds at most Events::Channel::Capacity small
+            // events, which always fit one message.
+            w.U32(static_cast<uint32_t>(events.size()));
+            for (const auto& e : events) EncodeEvent(w, e);
+        } break;
+
+        case Op::ListGames: {
+            uint32_t offset = 0;
+            std::vector<std::string> games;
+            if (!r.U32(offset)) fail(Result::BadRequest);
+            else if (!control_.ListGames(games)) fail(Result::Rejected);
+            else EncodeGames(out, games, offset);
+        } break;
+
+        case Op::AddGame:
+        case Op::RemoveGame:
+        case Op::ForceEnter: {
+            std::string name;
+            if (!r.Str(name) || !r.AtEnd()) {
+                fail(Result::BadRequest);
+                break;
+            }
+            const bool ok = op == Op::AddGame ? control_.AddGame(name)
+                : op == Op::RemoveGame ? control_.RemoveGame(name)
+                : control_.ForceEnter(name);
+            if (!ok) fail(Result::Rejected);
+        } break;
+
+        case Op::DumpTrace: {
+            // A name, never a path: the server may be elevated.
+            std::string name;
+            if (!r.Str(name) || !r.AtEnd() || !ValidTraceName(name)) {
+                fail(Result::BadRequest);
+                break;
+            }
+            const std::string dir = TraceDirectory();
+            CreateDirectoryA(dir.c_str(), nullptr);
+            const DWORD attrs = GetFileAttributesA(dir.c_str());
+            // A junction planted in its place could point anywhere.
+            const bool plain = attrs != INVALID_FILE_ATTRIBUTES
+                && (attrs & FILE_ATTRIBUTE_DIRECTORY) && !(attrs & FILE_ATTRIBUTE_REPARSE_POINT);
+            if (!plain || !control_.DumpTrace(dir + name)) fail(Result::Rejected);
+        } break;
+
+        case Op::ForceExit:
+            if (!control_.ForceExit()) fail(Result::Rejected);
+            break;
+
+        case Op::Subscribe: {
+            uint32_t interval = 0;
+            if (r.U32(interval)) streamIntervalMs = std::max<uint32_t>(interval, 10);
+            else fail(Result::BadRequest);
+        } break;
+
+        case Op::Shutdown:
+            if (onShutdown_) keep = false;
+            else fail(Result::Rejected);
+            break;
+
+        default:
+            fail(Result::BadRequest);
+            break;
+        }
+
+        FinishFrame(out);
+        return keep;
+    }
+
+    void Server::Stream(HANDLE pipe, uint32_t intervalMs) {
+        std::vector<uint8_t> out;
+        while (!stopping_) {
+            Booster::Stats s;
+            control_.GetStats(s);
+            BeginFrame(out, Op::Stats);
+            Writer w(out);
+            EncodeStats(w, s);
+            FinishFrame(out);
+            DWORD written = 0;
+            if (!WriteFile(pipe, out.data(), static_cast<DWORD>(out.size()),
+                &written, nullptr))
+                return;
+            if (WaitForSingleObject(stopEvent_, intervalMs) == WAIT_OBJECT_0)
+                return;
+        }
+    }
+
+    // ------------------------------------------------------------
+    // Client
+    // ------------------------------------------------------------
+
+    std::unique_ptr<Client> Client::Connect(DWORD timeoutMs) {
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            HANDLE h = CreateFileA(PipeName, GENERIC_READ | GENERIC_WRITE, 0,
+                nullptr, OPEN_EXISTING, 0, nullptr);
+            if (h != INVALID_HANDLE_VALUE) {
+                DWORD mode = PIPE_READMODE_MESSAGE;
+                if (!SetNamedPipeHandleState(h, &mode, nullptr, nullptr)) {
+                    CloseHandle(h);
+                    return nullptr;
+                }
+                return std::unique_ptr<Client>(new Client(h));
+            }
+            if (GetLastError() != ERROR_PIPE_BUSY || !timeoutMs
+                || !WaitNamedPipeA(PipeName, timeoutMs))
+                return nullptr;
+        }
+        return nullptr;
+    }
+
+    Client::~Client() {
+        CloseHandle(pipe_);
+    }
+
+    bool Client::Call(Result& result) {
+        DWORD n = 0;
+        if (!FinishFrame(request_)
+            || !TransactNamedPipe(pipe_, request_.data(),
+                static_cast<DWORD>(request_.size()), reply_.data(),
+                static_cast<DWORD>(reply_.size()), &n, nullptr))
+            return false;
+        Op op;
+        return ParseFrame(reply_.data(), n, op, result, payload_, payloadSize_);
+    }
+
+    bool Client::Simple(Op op, const std::string* arg) {
+        std::lock_guard lock(mutex_);
+        BeginFrame(request_, op);
+        if (arg) {
+            Writer w(request_);
+            if (!w.Str(*arg)) return false;
+        }
+        Result res;
+        return Call(res) && res == Result::Ok;
+    }
+
+    bool Client::GetStatus(Booster::StatusInfo& out) {
+        std::lock_guard lock(mutex_);
+        BeginFrame(request_, Op::Status);
+        Result res;
+        if (!Call(res) || res != Result::Ok) return false;
+        Reader r(payload_, payloadSize_);
+        return DecodeStatus(r, out);
+    }
+
+    bool Client::GetStats(Booster::Stats& out) {
+        std::lock_guard lock(mutex_);
+        BeginFrame(request_, Op::Stats);
+        Result res;
+        if (!Call(res) || res != Result::Ok) return false;
+        Reader r(payload_, payloadSize_);
+        return DecodeStats(r, out);
+    }
+
+    bool Client::RecentEvents(uint64_t after, std::vector<Events::Event>& out) {
+        std::lock_guard lock(mutex_);
+        BeginFrame(request_, Op::Events);
+        Writer(request_).U64(after);
+        Result res;
+        if (!Call(res) || res != Result::Ok) return false;
+        Reader r(payload_, payloadSize_);
+        uint32_t count = 0;
+        if (!r.U32(count)) return false;
+        out.clear();
+        out.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            Events::Event e;
+            if (!DecodeEvent(r, e)) return false;
+            out.push_back(e);
+        }
+        return true;
+    }
+
+    bool Client::ListGames(std::vector<std::string>& out) {
+        std::lock_guard lock(mutex_);
+        out.clear();
+        uint32_t total = 0;
+        do {
+            BeginFrame(request_, Op::ListGames);
+            Writer w(request_);
+            w.U32(static_cast<uint32_t>(out.size()));
+            Result res;
+            if (!Call(res) || res != Result::Ok) return false;
+            Reader r(payload_, payloadSize_);
+            const size_t before = out.size();
+            if (!DecodeGames(r, total, out)) return false;
+            if (out.size() == before) break;
+        } while (out.size() < total);
+        return true;
+    }
+
+    bool Client::AddGame(const std::string& name) { return Simple(Op::AddGame, &name); }
+    bool Client::RemoveGame(const std::string& name) { return Simple(Op::RemoveGame, &name); }
+    bool Client::ForceEnter(const std::string& name) { return Simple(Op::ForceEnter, &name); }
+    bool Client::ForceExit() { return Simple(Op::ForceExit, nullptr); }
+    bool Client::Shutdown() { return Simple(Op::Shutdown, nullptr); }
+    bool Client::DumpTrace(const std::string& name) { return Simple(Op::DumpTrace, &name); }
+
+    bool Client::Subscribe(uint32_t intervalMs,
+        const std::function<bool(const Booster::Stats&)>& onStats)
+    {
+        std::lock_guard lock(mutex_);
+        BeginFrame(request_, Op::Subscribe);
+        Writer w(request_);
+        w.U32(intervalMs);
+        Result res;
+        if (!Call(res) || res != Result::Ok) return false;
+
+        for (;;) {
+            DWORD n = 0;
+            if (!ReadFile(pipe_, reply_.data(), static_cast<DWORD>(reply_.size()),
+                &n, nullptr))
+                return false;
+            Op op;
+            Booster::Stats s;
+            if (!ParseFrame(reply_.data(), n, op, res, payload_, payloadSize_)
+                || op != Op::Stats)
+                return false;
+            Reader r(payload_, payloadSize_);
+            if (!DecodeStats(r, s)) return false;
+            if (!onStats(s)) return true;
+        }
+    }
+
+    // ------------------------------------------------------------
+    // Benchmark
+    // ------------------------------------------------------------
+
+    BenchResult BenchmarkStatus(Client& client, int requests) {
+        BenchResult result;
+        result.requests = requests;
+        std::vector<double> us;
+        us.reserve(requests);
+
+        LARGE_INTEGER freq, start, end, t0, t1;
+        QueryPerformanceFrequency(&freq);
+        const double toUs = 1e6 / static_cast<double>(freq.QuadPart);
+
+        Booster::StatusInfo status;
+        QueryPerformanceCounter(&start);
+        for (int i = 0; i < requests; ++i) {
+            QueryPerformanceCounter(&t0);
+            const bool ok = client.GetStatus(status);
+            QueryPerformanceCounter(&t1);
+            if (ok) us.push_back((t1.QuadPart - t0.QuadPart) * toUs);
+            else ++result.failures;
+        }
+        QueryPerformanceCounter(&end);
+        if (us.empty()) return result;
+
+        std::sort(us.begin(), us.end());
+        double sum = 0;
+        for (double v : us) sum += v;
+        result.meanUs = sum / us.size();
+        result.p50Us = us[us.size() / 2];
+        result.p99Us = us[std::min(us.size() - 1, us.size() * 99 / 100)];
+        result.maxUs = us.back();
+        const double seconds = (end.QuadPart - start.QuadPart) * toUs / 1e6;
+        if (seconds > 0) result.perSecond = requests / seconds;
+        return result;
+    }
+
+} // namespace Ipc
@@ -0,0 +1,108 @@
+﻿#pragma once
+
+#include "IpcProtocol.h"
+
+#include <windows.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ============================================================
+// CONTROL PIPE
+// ============================================================
+
+namespace Ipc {
+
+    // Where DumpTrace writes: "traces\" beside the executable.
+    std::string TraceDirectory();
+
+    // Serves a Control over the named pipe, one thread per connected
+    // client. Only local clients are accepted, and only the user who
+    // started the server, Administrators and SYSTEM may connect: an
+    // elevated server acts for whoever does.
+    class Server {
+    public:
+        explicit Server(Booster::Control& control, std::function<void()> onShutdown = {});
+        ~Server();
+
+        Server(const Server&) = delete;
+        Server& operator=(const Server&) = delete;
+
+        // Fails if another booster already owns the pipe.
+        bool Start();
+        void Stop();
+
+    private:
+        void AcceptLoop(HANDLE first);
+        void Serve(HANDLE pipe);
+        bool Dispatch(const uint8_t* data, size_t size, std::vector<uint8_t>& out,
+            uint32_t& streamIntervalMs);
+        void Stream(HANDLE pipe, uint32_t intervalMs);
+
+        Booster::Control&     control_;
+        std::function<void()> onShutdown_;
+        std::atomic<bool>     stopping_{ false };
+        HANDLE                stopEvent_ = nullptr;
+        std::thread           acceptThread_;
+        std::mutex            clientsMutex_;
+        std::vector<std::thread> clients_;
+    };
+
+    class Client final : public Booster::Control {
+    public:
+        // nullptr when no booster is listening.
+        static std::unique_ptr<Client> Connect(DWORD timeoutMs = 0);
+        ~Client() override;
+
+        Client(const Client&) = delete;
+        Client& operator=(const Client&) = delete;
+
+        bool GetStatus(Booster::StatusInfo& out) override;
+        bool GetStats(Booster::Stats& out) override;
+        bool ListGames(std::vector<std::string>& out) override;
+        bool AddGame(const std::string& name) override;
+        bool RemoveGame(const std::string& name) override;
+        bool ForceEnter(const std::string& name) override;
+        bool ForceExit() override;
+        // `name` as ValidTraceName() accepts; lands in TraceDirectory().
+        bool DumpTrace(const std::string& name) override;
+        bool RecentEvents(uint64_t after, std::vector<Events::Event>& out) override;
+        bool Shutdown();
+
+        // Blocks, delivering a Stats frame every `intervalMs` until `onStats`
+        // returns false or the server goes away. The connection is
+        // dedicated to the stream afterwards.
+        bool Subscribe(uint32_t intervalMs,
+            const std::function<bool(const Booster::Stats&)>& onStats);
+
+    private:
+        explicit Client(HANDLE pipe) : pipe_(pipe) {}
+
+        // Sends `request_` and leaves the reply payload in reply_/replySize_.
+        bool Call(Result& result);
+        bool Simple(Op op, const std::string* arg);
+
+        HANDLE               pipe_;
+        std::mutex           mutex_;
+        std::vector<uint8_t> request_;
+        std::vector<uint8_t> reply_ = std::vector<uint8_t>(MaxMessage);
+        const uint8_t*       payload_ = nullptr;
+        size_t               payloadSize_ = 0;
+    };
+
+    struct BenchResult {
+        int    requests = 0;
+        int    failures = 0;
+        double meanUs = 0, p50Us = 0, p99Us = 0, maxUs = 0;
+        double perSecond = 0;
+    };
+
+    // Round-trip latency of `requests` back-to-back Status queries.
+    BenchResult BenchmarkStatus(Client& client, int requests);
+
+} // namespace Ipc
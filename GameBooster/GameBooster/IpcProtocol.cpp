@@ -0,0 +1,225 @@
+﻿#include "IpcProtocol.h"
+
+#include <algorithm>
+#include <cctype>
+#include <limits>
+
+namespace Ipc {
+
+    // ------------------------------------------------------------
+    // Writer / Reader
+    // ------------------------------------------------------------
+
+    void Writer::Put(uint64_t v, int bytes) {
+        for (int i = 0; i < bytes; ++i)
+            buf_.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+
+    bool Writer::Str(const std::string& s) {
+        if (s.size() > std::numeric_limits<uint16_t>::max()) return false;
+        U16(static_cast<uint16_t>(s.size()));
+        buf_.insert(buf_.end(), s.begin(), s.end());
+        return true;
+    }
+
+    bool Reader::Get(uint64_t& v, int bytes) {
+        if (end_ - p_ < bytes) return false;
+        v = 0;
+        for (int i = 0; i < bytes; ++i)
+            v |= static_cast<uint64_t>(p_[i]) << (8 * i);
+        p_ += bytes;
+        return true;
+    }
+
+    bool Reader::U8(uint8_t& v) {
+        uint64_t t;
+        if (!Get(t, 1)) return false;
+        v = static_cast<uint8_t>(t);
+        return true;
+    }
+
+    bool Reader::U16(uint16_t& v) {
+        uint64_t t;
+        if (!Get(t, 2)) return false;
+        v = static_cast<uint16_t>(t);
+        return true;
+    }
+
+    bool Reader::U32(uint32_t& v) {
+        uint64_t t;
+        if (!Get(t, 4)) return false;
+        v = static_cast<uint32_t>(t);
+        return true;
+    }
+
+    bool Reader::U64(uint64_t& v) {
+        return Get(v, 8);
+    }
+
+    bool Reader::Str(std::string& s) {
+        uint16_t len;
+        if (!U16(len) || end_ - p_ < len) return false;
+        s.assign(reinterpret_cast<const char*>(p_), len);
+        p_ += len;
+        return true;
+    }
+
+    // ------------------------------------------------------------
+    // Framing
+    // ------------------------------------------------------------
+
+    void BeginFrame(std::vector<uint8_t>& buf, Op op, Result result) {
+        buf.clear();
+        buf.push_back(static_cast<uint8_t>(op));
+        buf.push_back(static_cast<uint8_t>(result));
+        buf.push_back(0);
+        buf.push_back(0);
+    }
+
+    bool FinishFrame(std::vector<uint8_t>& buf) {
+        if (buf.size() < HeaderSize || buf.size() > MaxMessage) return false;
+        const size_t len = buf.size() - HeaderSize;
+        if (len > std::numeric_limits<uint16_t>::max()) return false;
+        buf[2] = static_cast<uint8_t>(len);
+        buf[3] = static_cast<uint8_t>(len >> 8);
+        return true;
+    }
+
+    bool ParseFrame(const uint8_t* data, size_t size, Op& op, Result& result,
+        const uint8_t*& payload, size_t& payloadSize)
+    {
+        if (size < HeaderSize) return false;
+        const size_t len = data[2] | (static_cast<size_t>(data[3]) << 8);
+        if (len != size - HeaderSize) return false;
+        op = static_cast<Op>(data[0]);
+        result = static_cast<Result>(data[1]);
+        payload = data + HeaderSize;
+        payloadSize = len;
+        return true;
+    }
+
+    // ------------------------------------------------------------
+    // Messages
+    // ------------------------------------------------------------
+
+    void EncodeStatus(Writer& w, const Booster::StatusInfo& s) {
+        w.U8(static_cast<uint8_t>((s.active ? 1 : 0) | (s.forced ? 2 : 0)));
+        w.U32(s.revision);
+        w.Str(s.game);
+        w.Str(s.text);
+    }
+
+    bool DecodeStatus(Reader& r, Booster::StatusInfo& s) {
+        uint8_t flags;
+        if (!r.U8(flags) || !r.U32(s.revision) || !r.Str(s.game) || !r.Str(s.text))
+            return false;
+        s.active = (flags & 1) != 0;
+        s.forced = (flags & 2) != 0;
+        return true;
+    }
+
+    namespace {
+
+        void EncodeWake(Writer& w, const Booster::WakeLatency& l) {
+            w.U64(l.samples);
+            w.U32(l.p50Us);
+            w.U32(l.p99Us);
+            w.U32(l.p999Us);
+            w.U32(l.maxUs);
+        }
+
+        bool DecodeWake(Reader& r, Booster::WakeLatency& l) {
+            return r.U64(l.samples) && r.U32(l.p50Us) && r.U32(l.p99Us)
+                && r.U32(l.p999Us) && r.U32(l.maxUs);
+        }
+
+    } // namespace
+
+    void EncodeStats(Writer& w, const Booster::Stats& s) {
+        w.U64(s.uptimeMs);
+        w.U64(s.ticks);
+        w.U64(s.transitions);
+        w.U64(s.lastEnterUs);
+        w.U64(s.lastExitUs);
+        w.U32(s.gameCount);
+        w.U32(s.steeredProcesses);
+        EncodeWake(w, s.wakeIdle);
+        EncodeWake(w, s.wakeBoosted);
+        w.U64(s.selfCpuUs);
+        w.U64(s.selfResidentBytes);
+        w.U64(s.selfPrivateBytes);
+    }
+
+    bool DecodeStats(Reader& r, Booster::Stats& s) {
+        return r.U64(s.uptimeMs) && r.U64(s.ticks) && r.U64(s.transitions)
+            && r.U64(s.lastEnterUs) && r.U64(s.lastExitUs)
+            && r.U32(s.gameCount) && r.U32(s.steeredProcesses)
+            && DecodeWake(r, s.wakeIdle) && DecodeWake(r, s.wakeBoosted)
+            && r.U64(s.selfCpuUs) && r.U64(s.selfResidentBytes) && r.U64(s.selfPrivateBytes);
+    }
+
+    void EncodeEvent(Writer& w, const Events::Event& e) {
+        w.U64(e.seq);
+        w.U64(e.timeUs);
+        w.U8(static_cast<uint8_t>(e.kind));
+        w.U8(e.code);
+        w.U8(e.outcome);
+        w.U32(e.error);
+        w.Str(e.subject);
+    }
+
+    bool DecodeEvent(Reader& r, Events::Event& e) {
+        uint8_t kind;
+        std::string subject;
+        if (!r.U64(e.seq) || !r.U64(e.timeUs) || !r.U8(kind) || !r.U8(e.code)
+            || !r.U8(e.outcome) || !r.U32(e.error) || !r.Str(subject))
+            return false;
+        e.kind = static_cast<Events::Kind>(kind);
+        Events::Copy(e.subject, subject);
+        return true;
+    }
+
+    size_t EncodeGames(std::vector<uint8_t>& buf,
+        const std::vector<std::string>& games, size_t offset)
+    {
+        Writer w(buf);
+        w.U32(static_cast<uint32_t>(games.size()));
+        const size_t countAt = buf.size();
+        w.U32(0);
+
+        uint32_t count = 0;
+        for (size_t i = offset; i < games.size(); ++i, ++count) {
+            const std::string& g = games[i];
+            if (g.size() > std::numeric_limits<uint16_t>::max()
+                || buf.size() + 2 + g.size() > MaxMessage)
+                break;
+            w.Str(g);
+        }
+        for (int b = 0; b < 4; ++b)
+            buf[countAt + b] = static_cast<uint8_t>(count >> (8 * b));
+        return count;
+    }
+
+    bool DecodeGames(Reader& r, uint32_t& total, std::vector<std::string>& append) {
+        uint32_t count;
+        if (!r.U32(total) || !r.U32(count)) return false;
+        for (uint32_t i = 0; i < count; ++i) {
+            std::string g;
+            if (!r.Str(g)) return false;
+            append.push_back(std::move(g));
+        }
+        return true;
+    }
+
+    bool ValidTraceName(const std::string& name) {
+        constexpr char Ext[] = ".json";
+        constexpr size_t ExtLen = sizeof(Ext) - 1;
+        if (name.size() <= ExtLen || name.size() > 64 || name[0] == '.'
+            || name.compare(name.size() - ExtLen, ExtLen, Ext) != 0)
+            return false;
+        return std::all_of(name.begin(), name.end(), [](unsigned char c) {
+            return std::isalnum(c) || c == '-' || c == '_' || c == '.';
+            });
+    }
+
+} // namespace Ipc
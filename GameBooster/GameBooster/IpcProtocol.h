@@ -0,0 +1,98 @@
+﻿#pragma once
+
+#include "Control.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ============================================================
+// CONTROL PROTOCOL
+// ============================================================
+//
+// One request or reply per pipe message. Every frame is a 4-byte header
+// (op, result, little-endian payload length) followed by the payload.
+// Strings are u16 length + bytes; integers are little-endian.
+
+namespace Ipc {
+
+    constexpr char     PipeName[] = "\\\\.\\pipe\\GameBooster";
+    constexpr uint32_t MaxMessage = 64 * 1024;
+    constexpr size_t   HeaderSize = 4;
+
+    enum class Op : uint8_t {
+        Status = 1,
+        Stats,
+        ListGames,
+        AddGame,
+        RemoveGame,
+        ForceEnter,
+        ForceExit,
+        Subscribe,      // payload: u32 interval ms; replies become a Stats stream
+        Shutdown,
+        DumpTrace,      // payload: file name, written into the server's trace directory
+        Events,         // payload: u64 after; reply: u32 count + events
+    };
+
+    enum class Result : uint8_t { Ok = 0, Rejected, BadRequest };
+
+    class Writer {
+    public:
+        explicit Writer(std::vector<uint8_t>& buf) : buf_(buf) {}
+
+        void U8(uint8_t v) { buf_.push_back(v); }
+        void U16(uint16_t v) { Put(v, 2); }
+        void U32(uint32_t v) { Put(v, 4); }
+        void U64(uint64_t v) { Put(v, 8); }
+        bool Str(const std::string& s);
+
+    private:
+        void Put(uint64_t v, int bytes);
+        std::vector<uint8_t>& buf_;
+    };
+
+    class Reader {
+    public:
+        Reader(const uint8_t* data, size_t size) : p_(data), end_(data + size) {}
+
+        bool U8(uint8_t& v);
+        bool U16(uint16_t& v);
+        bool U32(uint32_t& v);
+        bool U64(uint64_t& v);
+        bool Str(std::string& s);
+        bool AtEnd() const { return p_ == end_; }
+
+    private:
+        bool Get(uint64_t& v, int bytes);
+        const uint8_t* p_;
+        const uint8_t* end_;
+    };
+
+    // Starts a frame in `buf` (cleared first); FinishFrame patches the
+    // length and fails if the payload outgrew a message.
+    void BeginFrame(std::vector<uint8_t>& buf, Op op, Result result = Result::Ok);
+    bool FinishFrame(std::vector<uint8_t>& buf);
+
+    // Validates the header of a received frame and positions `payload`.
+    bool ParseFrame(const uint8_t* data, size_t size, Op& op, Result& result,
+        const uint8_t*& payload, size_t& payloadSize);
+
+    void EncodeStatus(Writer& w, const Booster::StatusInfo& s);
+    bool DecodeStatus(Reader& r, Booster::StatusInfo& s);
+    void EncodeStats(Writer& w, const Booster::Stats& s);
+    bool DecodeStats(Reader& r, Booster::Stats& s);
+    void EncodeEvent(Writer& w, const Events::Event& e);
+    bool DecodeEvent(Reader& r, Events::Event& e);
+
+    // Game lists are paged: the request carries a u32 offset and each reply
+    // holds (total, count, names...) filling at most one message.
+    size_t EncodeGames(std::vector<uint8_t>& buf,
+        const std::vector<std::string>& games, size_t offset);
+    bool DecodeGames(Reader& r, uint32_t& total, std::vector<std::string>& append);
+
+    // A DumpTrace name: letters, digits, '-', '_' and '.', ending in
+    // ".json", with no path in it.
+    bool ValidTraceName(const std::string& name);
+
+} // namespace Ipc
@@ -0,0 +1,194 @@
+﻿#define NOMINMAX
+#include "Scene.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Scene {
+
+    Rect Rect::Union(const Rect& o) const {
+        if (Empty()) return o;
+        if (o.Empty()) return *this;
+        const float l = std::min(X, o.X), t = std::min(Y, o.Y);
+        return { l, t, std::max(Right(), o.Right()) - l, std::max(Bottom(), o.Bottom()) - t };
+    }
+
+    Rect Rect::Intersect(const Rect& o) const {
+        const float l = std::max(X, o.X), t = std::max(Y, o.Y);
+        const float r = std::min(Right(), o.Right()), b = std::min(Bottom(), o.Bottom());
+        if (r <= l || b <= t) return {};
+        return { l, t, r - l, b - t };
+    }
+
+    Rect Rect::Snapped() const {
+        const float l = std::floor(X), t = std::floor(Y);
+        return { l, t, std::ceil(Right()) - l, std::ceil(Bottom()) - t };
+    }
+
+    // ------------------------------------------------------------
+    // Layout
+    // ------------------------------------------------------------
+
+    void Metrics::Compute(int w, int h) {
+        width = w;
+        height = h;
+        x = static_cast<float>(Layout::Padding);
+        contentWidth = static_cast<float>(w - Layout::Padding * 2);
+        float y = x;
+
+        titleY = y;  y += Layout::FontSizeTitle + Layout::GapXs;
+        subtitleY = y;  y += Layout::FontSizeBody + Layout::GapSm;
+        lineY = y;  y += Layout::Gap + Layout::GapXs;
+        addLabelY = y;  y += Layout::FontSizeLabel + Layout::GapXs;
+
+        const float inputW = contentWidth - Layout::AddBtnW - Layout::GapSm;
+        inputRect = { x, y, inputW, static_cast<float>(Layout::ControlH) };
+        addBtnRect = { x + inputW + Layout::GapSm, y,
+                       static_cast<float>(Layout::AddBtnW),
+                       static_cast<float>(Layout::ControlH) };
+        y += Layout::ControlH + Layout::Gap;
+
+        listLabelY = y;  y += Layout::FontSizeLabel + Layout::GapSm;
+
+        // Space below list: Gap + remove button + Gap + status bar + padding
+        const float spaceBelow = Layout::Gap * 2.f + Layout::ControlH * 2.f + Layout::Padding;
+        float listH = static_cast<float>(h) - y - spaceBelow;
+
+        if (listH < 0.f) listH = 0.f;
+        listRect = { x, y, contentWidth, listH };
+        y += listH + Layout::Gap;
+
+        removeBtnRect = { x, y, static_cast<float>(Layout::RemoveBtnW),
+                          static_cast<float>(Layout::ControlH) };
+        y += Layout::ControlH + Layout::Gap;
+        statusRect = { x, y, contentWidth, static_cast<float>(Layout::ControlH) };
+    }
+
+    void Metrics::GetEditPosition(int& ex, int& ey, int& ew, int& eh) const {
+        ex = static_cast<int>(inputRect.X + Layout::EditInset);
+        ey = static_cast<int>(inputRect.Y + Layout::EditInset);
+        ew = static_cast<int>(inputRect.Width - Layout::EditInset * 2);
+        eh = static_cast<int>(Layout::ControlH - Layout::EditInset * 2);
+    }
+
+    Rect Metrics::HeaderRect() const {
+        return { 0.f, 0.f, static_cast<float>(width), addLabelY - Layout::GapXs };
+    }
+
+    Rect Metrics::AddLabelRow() const {
+        return { x, addLabelY, contentWidth, inputRect.Y - addLabelY };
+    }
+
+    Rect Metrics::ListLabelRow() const {
+        return { x, listLabelY - 2, contentWidth, listRect.Y - listLabelY + 2 };
+    }
+
+    Rect Metrics::ListClip() const {
+        return { listRect.X + Layout::ListPadX, listRect.Y + Layout::ListPadY,
+                 listRect.Width - Layout::ListPadX * 2, listRect.Height - Layout::ListPadY * 2 };
+    }
+
+    Rect Metrics::ItemRect(int index, int scrollY) const {
+        const Rect clip = ListClip();
+        return { clip.X, clip.Y - scrollY + static_cast<float>(index) * Layout::ItemH,
+                 clip.Width, static_cast<float>(Layout::ItemH) - 4 };
+    }
+
+    Rect Metrics::StatusDotRect() const {
+        const float cx = statusRect.X + 16 + Layout::StatusDot / 2;
+        const float cy = statusRect.Y + statusRect.Height / 2;
+        const float r = (Layout::StatusDot + Layout::StatusGlow) / 2 + 1;
+        return { cx - r, cy - r, 2 * r, 2 * r };
+    }
+
+    int Metrics::VisibleListHeight() const {
+        return static_cast<int>(listRect.Height - Layout::ListPadY * 2);
+    }
+
+    int Metrics::MaxScroll(int count) const {
+        int total = count * Layout::ItemH;
+        int visible = VisibleListHeight();
+        return (total > visible) ? total - visible : 0;
+    }
+
+    int Metrics::HitTestButton(int mx, int my) const {
+        const float fx = static_cast<float>(mx), fy = static_cast<float>(my);
+        if (addBtnRect.Contains(fx, fy))    return ID_BTN_ADD;
+        if (removeBtnRect.Contains(fx, fy)) return ID_BTN_REMOVE;
+        return -1;
+    }
+
+    int Metrics::HitTestItem(int mx, int my, int count, int scrollY) const {
+        const Rect clip = ListClip();
+        if (!clip.Contains(static_cast<float>(mx), static_cast<float>(my)))
+            return -1;
+        const int idx = static_cast<int>((my - clip.Y + scrollY) / Layout::ItemH);
+        return (idx >= 0 && idx < count) ? idx : -1;
+    }
+
+    // ------------------------------------------------------------
+    // Dirty regions
+    // ------------------------------------------------------------
+
+    void Coalesce(std::vector<Rect>& rects) {
+        rects.erase(std::remove_if(rects.begin(), rects.end(),
+            [](const Rect& r) { return r.Empty(); }), rects.end());
+        for (bool merged = true; merged;) {
+            merged = false;
+            for (size_t i = 0; i < rects.size() && !merged; ++i)
+                for (size_t j = i + 1; j < rects.size(); ++j) {
+                    if (!rects[i].Intersects(rects[j])) continue;
+                    rects[i] = rects[i].Union(rects[j]);
+                    rects.erase(rects.begin() + j);
+                    merged = true;
+                    break;
+                }
+        }
+    }
+
+    std::vector<Rect> Diff(const State& a, const State& b, const Metrics& m) {
+        std::vector<Rect> out;
+        if (a.width != b.width || a.height != b.height) {
+            out.push_back({ 0.f, 0.f, static_cast<float>(b.width), static_cast<float>(b.height) });
+            return out;
+        }
+
+        // Strokes are anti-aliased; take a pixel or two around each shape.
+        if (a.inputFocused != b.inputFocused)
+            out.push_back(m.inputRect.Inflated(2));
+        if (a.addHover != b.addHover || a.addPress != b.addPress)
+            out.push_back(m.addBtnRect.Inflated(1));
+
+        if (a.listRevision != b.listRevision || a.gameCount != b.gameCount) {
+            out.push_back(m.ListLabelRow());
+            out.push_back(m.listRect.Inflated(1));
+        }
+        else if (a.scrollY != b.scrollY) {
+            out.push_back(m.listRect.Inflated(1));
+        }
+        else {
+            const Rect clip = m.ListClip();
+            auto item = [&](int i) {
+                if (i >= 0 && i < b.gameCount)
+                    out.push_back(m.ItemRect(i, b.scrollY).Inflated(2).Intersect(clip));
+                };
+            if (a.hoveredItem != b.hoveredItem) { item(a.hoveredItem); item(b.hoveredItem); }
+            if (a.selectedItem != b.selectedItem) { item(a.selectedItem); item(b.selectedItem); }
+        }
+
+        // The remove button greys out without a selection.
+        if (a.removeHover != b.removeHover || a.removePress != b.removePress
+            || (a.selectedItem >= 0) != (b.selectedItem >= 0))
+            out.push_back(m.removeBtnRect.Inflated(1));
+
+        if (a.active != b.active || a.status != b.status)
+            out.push_back(m.statusRect.Inflated(1));
+        else if (a.pulse != b.pulse)
+            out.push_back(m.StatusDotRect());
+
+        for (auto& r : out) r = r.Snapped();
+        Coalesce(out);
+        return out;
+    }
+
+} // namespace Scene
@@ -0,0 +1,105 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ============================================================
+// SCENE
+// ============================================================
+//
+// Window layout and repaint bookkeeping, free of Win32 and GDI+ so it can
+// be exercised headlessly. The window captures a State after each input or
+// engine change; Diff() names the parts of the client area that changed,
+// and only those are invalidated and redrawn into the back buffer.
+
+namespace Layout {
+    constexpr int MinWindowW = 420, MinWindowH = 480;
+    constexpr int InitialW = 480, InitialH = 580;
+    constexpr int Padding = 24;
+    constexpr int RadiusLg = 12, RadiusSm = 8, RadiusXs = 6;
+    constexpr int ControlH = 44, ItemH = 52;
+    constexpr int Gap = 16, GapSm = 12, GapXs = 8;
+    constexpr int AddBtnW = 100, RemoveBtnW = 140;
+    constexpr float ListPadX = 14.f, ListPadY = 8.f;
+    constexpr float EditInset = 12.f;
+    constexpr float StatusDot = 10.f, StatusGlow = 8.f;
+
+    // Typography
+    constexpr int FontSizeTitle = 24;
+    constexpr int FontSizeBody = 13;
+    constexpr int FontSizeLabel = 11;
+    constexpr int FontSizeStatus = 12;
+}
+
+enum ControlID { ID_INPUT = 100, ID_BTN_ADD, ID_BTN_REMOVE, ID_TRAY = 1000 };
+
+namespace Scene {
+
+    // Same field names as Gdiplus::RectF, so drawing code reads the same.
+    struct Rect {
+        float X = 0.f, Y = 0.f, Width = 0.f, Height = 0.f;
+
+        float Right() const { return X + Width; }
+        float Bottom() const { return Y + Height; }
+        bool Empty() const { return Width <= 0.f || Height <= 0.f; }
+        bool Contains(float x, float y) const {
+            return x >= X && x <= Right() && y >= Y && y <= Bottom();
+        }
+        bool Intersects(const Rect& o) const {
+            return !Empty() && !o.Empty() && X < o.Right() && o.X < Right()
+                && Y < o.Bottom() && o.Y < Bottom();
+        }
+        Rect Inflated(float d) const { return { X - d, Y - d, Width + 2 * d, Height + 2 * d }; }
+        Rect Union(const Rect& o) const;
+        Rect Intersect(const Rect& o) const;
+        // Grown outward to whole pixels.
+        Rect Snapped() const;
+    };
+
+    struct Metrics {
+        int   width = 0, height = 0;
+        float x = 0.f, contentWidth = 0.f;
+        float titleY = 0.f, subtitleY = 0.f, lineY = 0.f, addLabelY = 0.f;
+        Rect  inputRect, addBtnRect;
+        float listLabelY = 0.f;
+        Rect  listRect, removeBtnRect, statusRect;
+
+        void Compute(int w, int h);
+        void GetEditPosition(int& ex, int& ey, int& ew, int& eh) const;
+
+        Rect HeaderRect() const;
+        Rect AddLabelRow() const;
+        Rect ListLabelRow() const;      // label and count badge
+        Rect ListClip() const;          // where items are drawn
+        Rect ItemRect(int index, int scrollY) const;
+        Rect StatusDotRect() const;     // the dot with its widest glow
+
+        int VisibleListHeight() const;
+        int MaxScroll(int count) const;
+        int HitTestButton(int mx, int my) const;
+        int HitTestItem(int mx, int my, int count, int scrollY) const;
+    };
+
+    // Everything drawn that can change without a resize.
+    struct State {
+        int         width = 0, height = 0;
+        bool        inputFocused = false;
+        float       addHover = 0.f, addPress = 0.f;
+        float       removeHover = 0.f, removePress = 0.f;
+        uint64_t    listRevision = 0;   // rows shown: list or filter changed
+        int         gameCount = 0;
+        int         hoveredItem = -1, selectedItem = -1, scrollY = 0;
+        float       pulse = 0.f;
+        bool        active = false;
+        std::string status;
+    };
+
+    // Snapped, non-overlapping regions that differ between two states,
+    // laid out by `m` (the layout of `after`).
+    std::vector<Rect> Diff(const State& before, const State& after, const Metrics& m);
+
+    // Merges overlapping rectangles until none overlap.
+    void Coalesce(std::vector<Rect>& rects);
+
+} // namespace Scene